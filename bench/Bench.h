@@ -0,0 +1,50 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <chrono>
+
+// results written here can not be optimized away by the compiler
+static volatile uint64_t s_benchSink = 0;
+
+class BenchTimer
+{
+public:
+    BenchTimer() : m_start(std::chrono::steady_clock::now()) {}
+
+    double GetMilliseconds() const
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_start).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point m_start;
+};
+
+// prints the time of a run and the time of one of its operations
+inline void PrintBenchResult(const char* name, double milliseconds, uint64_t operations)
+{
+    printf("  %-48s %10.3f ms %10.2f ns/op\n", name, milliseconds, milliseconds * 1000000.0 / (operations > 0 ? operations : 1));
+}
+
+#endif // BENCH_H
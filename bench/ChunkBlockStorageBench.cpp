@@ -0,0 +1,156 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#include <memory>
+#include <random>
+#include <vector>
+#include "Bench.h"
+#include "../src/world/chunk/ChunkGenerator.h"
+
+// the chunk cache of ChunkManager at a radius of 8 chunks
+#define BENCH_CHUNK_RADIUS 8
+#define BENCH_LOOKUPS (1 << 22)
+#define BENCH_SETS (1 << 20)
+
+static PerlinNoise s_noise(.10, .1, .5, 6, 1234);
+
+static void PrintMemory(const char* name, const std::vector<std::unique_ptr<ChunkSections> >& chunks)
+{
+    uint64_t bytes = 0;
+    for (const auto& chunk : chunks)
+        bytes += chunk->GetMemoryUsage();
+
+    printf("  %-48s %10.1f KiB per chunk, %.1f%% of one byte per block\n", name, bytes / 1024.0 / chunks.size(),
+           100.0 * bytes / ((double) chunks.size() * CHUNK_BLOCK_COUNT));
+}
+
+int main()
+{
+    printf("ChunkBlockStorageBench\n");
+    std::vector<std::unique_ptr<ChunkSections> > chunks;
+    for (int32_t x = -BENCH_CHUNK_RADIUS; x <= BENCH_CHUNK_RADIUS; ++x)
+    {
+        for (int32_t z = -BENCH_CHUNK_RADIUS; z <= BENCH_CHUNK_RADIUS; ++z)
+        {
+            chunks.emplace_back(new ChunkSections());
+            ChunkGenerator::Generate(s_noise, ChunkCoord { x, z }, *chunks.back());
+        }
+    }
+    PrintMemory("generated terrain", chunks);
+
+    // the player digs a tunnel through the stone of the lowest section of every chunk and fills it again
+    for (auto& chunk : chunks)
+    {
+        for (uint32_t x = 0; x < CHUNK_SIZE_X; ++x)
+        {
+            for (uint32_t y = 4; y < 7; ++y)
+            {
+                chunk->Set(x, y, 7, BlockType::AIR);
+                chunk->Set(x, y, 8, BlockType::WOOD);
+            }
+        }
+    }
+    PrintMemory("with a tunnel and wood", chunks);
+
+    for (auto& chunk : chunks)
+    {
+        for (uint32_t x = 0; x < CHUNK_SIZE_X; ++x)
+        {
+            for (uint32_t y = 4; y < 7; ++y)
+            {
+                chunk->Set(x, y, 7, BlockType::STONE);
+                chunk->Set(x, y, 8, BlockType::STONE);
+            }
+        }
+    }
+    PrintMemory("after the tunnel was filled", chunks);
+
+    std::vector<BlockType> flat(CHUNK_BLOCK_COUNT * chunks.size());
+    for (size_t chunk = 0; chunk < chunks.size(); ++chunk)
+    {
+        for (uint32_t i = 0; i < CHUNK_BLOCK_COUNT; ++i)
+            flat[chunk * CHUNK_BLOCK_COUNT + i] = chunks[chunk]->Get(i);
+    }
+
+    std::mt19937 random(1234);
+    std::vector<uint32_t> lookups(BENCH_LOOKUPS);
+    for (uint32_t& lookup : lookups)
+        lookup = random();
+
+    uint64_t result = 0;
+    BenchTimer timer;
+    for (uint32_t lookup : lookups)
+        result += (uint32_t) chunks[lookup % chunks.size()]->Get((lookup >> 9) % CHUNK_BLOCK_COUNT);
+    PrintBenchResult("random get from the palette", timer.GetMilliseconds(), lookups.size());
+
+    timer = BenchTimer();
+    for (uint32_t lookup : lookups)
+        result += (uint32_t) flat[(lookup % chunks.size()) * CHUNK_BLOCK_COUNT + (lookup >> 9) % CHUNK_BLOCK_COUNT];
+    PrintBenchResult("random get from a flat byte buffer", timer.GetMilliseconds(), lookups.size());
+
+    timer = BenchTimer();
+    for (const auto& chunk : chunks)
+    {
+        for (uint32_t i = 0; i < CHUNK_BLOCK_COUNT; ++i)
+            result += (uint32_t) chunk->Get(i);
+    }
+    PrintBenchResult("sequential get from the palette", timer.GetMilliseconds(), (uint64_t) chunks.size() * CHUNK_BLOCK_COUNT);
+
+    BlockType column[CHUNK_SECTION_SIZE];
+    timer = BenchTimer();
+    for (const auto& chunk : chunks)
+    {
+        for (uint32_t section = 0; section < CHUNK_SECTION_COUNT; ++section)
+        {
+            for (uint32_t x = 0; x < CHUNK_SIZE_X; ++x)
+            {
+                for (uint32_t z = 0; z < CHUNK_SIZE_Z; ++z)
+                {
+                    chunk->DecodeColumn(x, z, section, column);
+                    result += (uint32_t) column[CHUNK_SECTION_SIZE - 1];
+                }
+            }
+        }
+    }
+    PrintBenchResult("decode the columns of the mesher", timer.GetMilliseconds(), (uint64_t) chunks.size() * CHUNK_BLOCK_COUNT);
+
+    // edits of the existing types keep the width, the heightmaps are updated with every set
+    timer = BenchTimer();
+    for (uint32_t i = 0; i < BENCH_SETS; ++i)
+    {
+        const uint32_t lookup = lookups[i];
+        const BlockType type = (lookup >> 28) & 1 ? BlockType::STONE : BlockType::AIR;
+        chunks[lookup % chunks.size()]->Set((lookup >> 9) % CHUNK_SIZE_X, (lookup >> 13) % CHUNK_MIN_GROUND, (lookup >> 20) % CHUNK_SIZE_Z, type);
+    }
+    PrintBenchResult("set stone or air", timer.GetMilliseconds(), BENCH_SETS);
+
+    // every section gets more types than its palette holds
+    timer = BenchTimer();
+    for (uint32_t i = 0; i < BENCH_SETS; ++i)
+    {
+        const uint32_t lookup = lookups[i];
+        const BlockType type = BlockType(1 + (lookup >> 27) % 5);
+        chunks[lookup % chunks.size()]->Set((lookup >> 9) % CHUNK_SIZE_X, (lookup >> 13) % CHUNK_SIZE_Y, (lookup >> 20) % CHUNK_SIZE_Z, type);
+    }
+    PrintBenchResult("set any type", timer.GetMilliseconds(), BENCH_SETS);
+    PrintMemory("after the random sets", chunks);
+
+    s_benchSink += result;
+    return 0;
+}
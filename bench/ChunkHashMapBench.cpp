@@ -0,0 +1,155 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#include <stdlib.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "Bench.h"
+#include "../src/world/chunk/ChunkHashMap.h"
+
+#define BENCH_HASH_LOOKUPS (1 << 22)
+#define BENCH_LINEAR_LOOKUPS (1 << 16)
+#define BENCH_MOVES 4096
+
+// the chunk positions the cache was searched by before, compared like Vector3::operator==
+struct CenterPosition
+{
+    double X;
+    double Y;
+    double Z;
+
+    bool operator==(const CenterPosition& other) const
+    {
+        return X == other.X && Y == other.Y && Z == other.Z;
+    }
+};
+
+struct BenchChunk
+{
+    ChunkCoord Coord;
+    CenterPosition Center;
+};
+
+static CenterPosition GetCenterPosition(const ChunkCoord& coord)
+{
+    return CenterPosition { coord.X * CHUNK_BLOCK_SIZE_X + CHUNK_BLOCK_SIZE_X / 2.0, CHUNK_BLOCK_SIZE_Y / 2.0,
+                            coord.Z * CHUNK_BLOCK_SIZE_Z + CHUNK_BLOCK_SIZE_Z / 2.0 };
+}
+
+// the map only stores the pointers, the chunks are never dereferenced
+static Chunk* ToChunk(BenchChunk* chunk)
+{
+    return reinterpret_cast<Chunk*>(chunk);
+}
+
+// the queries of the block lookups and the neighbor linking, a quarter of them is outside of the cache
+static std::vector<ChunkCoord> GetQueries(int32_t radius, uint32_t count)
+{
+    std::mt19937 random(radius);
+    std::uniform_int_distribution<int32_t> distribution(-radius - radius / 2 - 1, radius + radius / 2 + 1);
+    std::vector<ChunkCoord> queries;
+    queries.reserve(count);
+    while (queries.size() < count)
+    {
+        const ChunkCoord coord = { distribution(random), distribution(random) };
+        const bool bCached = abs(coord.X) <= radius && abs(coord.Z) <= radius;
+        if (bCached || queries.size() % 4 == 0)
+            queries.push_back(coord);
+    }
+    return queries;
+}
+
+static void RunRadius(int32_t radius)
+{
+    // the cache of ChunkManager is the square around the player
+    std::vector<BenchChunk> chunks;
+    for (int32_t x = -radius; x <= radius; ++x)
+    {
+        for (int32_t z = -radius; z <= radius; ++z)
+            chunks.push_back(BenchChunk { ChunkCoord { x, z }, GetCenterPosition(ChunkCoord { x, z }) });
+    }
+
+    std::vector<BenchChunk*> cache;
+    ChunkHashMap map;
+    map.Init(chunks.size());
+    for (BenchChunk& chunk : chunks)
+    {
+        cache.push_back(&chunk);
+        map.Insert(chunk.Coord, ToChunk(&chunk));
+    }
+
+    printf("  radius %d, %u chunks\n", radius, (uint32_t) chunks.size());
+
+    const std::vector<ChunkCoord> hashQueries = GetQueries(radius, BENCH_HASH_LOOKUPS);
+    uint64_t found = 0;
+    BenchTimer timer;
+    for (const ChunkCoord& coord : hashQueries)
+        found += map.Find(coord) ? 1 : 0;
+    PrintBenchResult("hash map lookups", timer.GetMilliseconds(), hashQueries.size());
+    s_benchSink += found;
+
+    const std::vector<CenterPosition> linearQueries = [&hashQueries]()
+    {
+        std::vector<CenterPosition> positions;
+        for (uint32_t i = 0; i < BENCH_LINEAR_LOOKUPS; ++i)
+            positions.push_back(GetCenterPosition(hashQueries[i]));
+        return positions;
+    }();
+    found = 0;
+    timer = BenchTimer();
+    for (const CenterPosition& position : linearQueries)
+    {
+        auto it = std::find_if(cache.begin(), cache.end(), [&position](const BenchChunk* chunk) { return chunk->Center == position; });
+        found += it != cache.end() ? 1 : 0;
+    }
+    PrintBenchResult("linear search by center position", timer.GetMilliseconds(), linearQueries.size());
+    s_benchSink += found;
+
+    // the player walks along x, the column left behind is reused for the new one
+    timer = BenchTimer();
+    for (int32_t move = 0; move < BENCH_MOVES; ++move)
+    {
+        const int32_t leftX = -radius + move;
+        for (int32_t z = -radius; z <= radius; ++z)
+        {
+            BenchChunk& chunk = chunks[(move % (2 * radius + 1)) * (2 * radius + 1) + z + radius];
+            map.Remove(chunk.Coord, ToChunk(&chunk));
+            chunk.Coord = ChunkCoord { leftX + 2 * radius + 1, z };
+            map.Insert(chunk.Coord, ToChunk(&chunk));
+        }
+    }
+    PrintBenchResult("remove and insert a chunk while moving", timer.GetMilliseconds(), (uint64_t) BENCH_MOVES * (2 * radius + 1));
+
+    // the probe sequences stay short after the backward shift deletions
+    found = 0;
+    timer = BenchTimer();
+    for (const ChunkCoord& coord : hashQueries)
+        found += map.Find(ChunkCoord { coord.X + BENCH_MOVES, coord.Z }) ? 1 : 0;
+    PrintBenchResult("hash map lookups after moving", timer.GetMilliseconds(), hashQueries.size());
+    s_benchSink += found;
+}
+
+int main()
+{
+    printf("ChunkHashMapBench\n");
+    for (int32_t radius : { 2, 8, 16 })
+        RunRadius(radius);
+    return 0;
+}
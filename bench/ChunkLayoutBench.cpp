@@ -0,0 +1,224 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#include <stdlib.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "Bench.h"
+#include "../src/world/PerlinNoise.h"
+#include "../src/world/chunk/ChunkData.h"
+
+// the chunk cache of ChunkManager at a radius of 8 chunks
+#define BENCH_CHUNKS 289
+#define BENCH_RANDOM_LOOKUPS (1 << 20)
+
+static PerlinNoise s_noise(.10, .1, .5, 6, 1234);
+
+// the index of GetChunkBlockIndex when CHUNK_LAYOUT_MORTON is defined
+static inline uint32_t GetMortonBlockIndex(uint32_t x, uint32_t y, uint32_t z)
+{
+    uint32_t index = 0;
+    for (uint32_t bit = 0; bit < 4; ++bit)
+    {
+        index |= ((y >> bit) & 1) << (bit * 3);
+        index |= ((z >> bit) & 1) << (bit * 3 + 1);
+        index |= ((x >> bit) & 1) << (bit * 3 + 2);
+    }
+    return index | ((y >> 4) << CHUNK_SECTION_SHIFT);
+}
+
+// the BlockType*** arrays chunks were stored in before, one allocation per row of z blocks
+class JaggedBlocks
+{
+public:
+    JaggedBlocks()
+    {
+        m_blocks = new BlockType**[CHUNK_SIZE_X];
+        for (uint32_t x = 0; x < CHUNK_SIZE_X; ++x)
+        {
+            m_blocks[x] = new BlockType*[CHUNK_SIZE_Y];
+            for (uint32_t y = 0; y < CHUNK_SIZE_Y; ++y)
+                m_blocks[x][y] = new BlockType[CHUNK_SIZE_Z];
+        }
+    }
+
+    ~JaggedBlocks()
+    {
+        for (uint32_t x = 0; x < CHUNK_SIZE_X; ++x)
+        {
+            for (uint32_t y = 0; y < CHUNK_SIZE_Y; ++y)
+                delete [] m_blocks[x][y];
+            delete [] m_blocks[x];
+        }
+        delete [] m_blocks;
+    }
+
+    inline BlockType Get(uint32_t x, uint32_t y, uint32_t z) const { return m_blocks[x][y][z]; }
+    inline void Set(uint32_t x, uint32_t y, uint32_t z, BlockType type) { m_blocks[x][y][z] = type; }
+
+private:
+    BlockType*** m_blocks;
+};
+
+// one 32-byte aligned buffer like the block buffer of Chunk
+template<uint32_t (*GetIndex)(uint32_t, uint32_t, uint32_t)>
+class FlatBlocks
+{
+public:
+    FlatBlocks()
+    {
+        if (posix_memalign((void**) &m_blocks, 32, CHUNK_BLOCK_COUNT) != 0)
+            m_blocks = nullptr;
+    }
+
+    ~FlatBlocks()
+    {
+        free(m_blocks);
+    }
+
+    inline BlockType Get(uint32_t x, uint32_t y, uint32_t z) const { return m_blocks[GetIndex(x, y, z)]; }
+    inline void Set(uint32_t x, uint32_t y, uint32_t z, BlockType type) { m_blocks[GetIndex(x, y, z)] = type; }
+
+private:
+    BlockType* m_blocks;
+};
+
+typedef FlatBlocks<GetChunkBlockIndex> ColumnBlocks;
+typedef FlatBlocks<GetMortonBlockIndex> MortonBlocks;
+
+// stone, dirt and grass up to the height of the terrain
+template<typename Blocks>
+static void Generate(Blocks& blocks, int32_t chunkX)
+{
+    for (uint32_t x = 0; x < CHUNK_SIZE_X; ++x)
+    {
+        for (uint32_t z = 0; z < CHUNK_SIZE_Z; ++z)
+        {
+            const double noise = s_noise.GetHeight((chunkX * CHUNK_SIZE_X + x) * BLOCK_SIZE, z * BLOCK_SIZE);
+            const uint32_t height = std::min<uint32_t>(CHUNK_SIZE_Y, CHUNK_MIN_GROUND + (uint32_t) std::max(0.0, CHUNK_SIZE_Y * noise));
+            for (uint32_t y = 0; y < CHUNK_SIZE_Y; ++y)
+            {
+                const BlockType type = y >= height ? BlockType::AIR : (y + 1 == height ? BlockType::GRASS : (y + 4 >= height ? BlockType::DIRT : BlockType::STONE));
+                blocks.Set(x, y, z, type);
+            }
+        }
+    }
+}
+
+// the loop order of ChunkMesher, section by section with y innermost
+template<typename Blocks>
+static uint64_t CountSolid(const Blocks& blocks)
+{
+    uint64_t solid = 0;
+    for (uint32_t section = 0; section < CHUNK_SECTION_COUNT; ++section)
+    {
+        for (uint32_t x = 0; x < CHUNK_SIZE_X; ++x)
+        {
+            for (uint32_t z = 0; z < CHUNK_SIZE_Z; ++z)
+            {
+                for (uint32_t y = section * CHUNK_SECTION_SIZE; y < (section + 1) * CHUNK_SECTION_SIZE; ++y)
+                    solid += blocks.Get(x, y, z) != BlockType::AIR ? 1 : 0;
+            }
+        }
+    }
+    return solid;
+}
+
+// the faces of the solid blocks next to air inside of the chunk, like the visibility test of the mesher
+template<typename Blocks>
+static uint64_t CountVisibleFaces(const Blocks& blocks)
+{
+    uint64_t faces = 0;
+    for (uint32_t section = 0; section < CHUNK_SECTION_COUNT; ++section)
+    {
+        for (uint32_t x = 0; x < CHUNK_SIZE_X; ++x)
+        {
+            for (uint32_t z = 0; z < CHUNK_SIZE_Z; ++z)
+            {
+                for (uint32_t y = section * CHUNK_SECTION_SIZE; y < (section + 1) * CHUNK_SECTION_SIZE; ++y)
+                {
+                    if (blocks.Get(x, y, z) == BlockType::AIR)
+                        continue;
+
+                    faces += x > 0 && blocks.Get(x - 1, y, z) == BlockType::AIR ? 1 : 0;
+                    faces += x + 1 < CHUNK_SIZE_X && blocks.Get(x + 1, y, z) == BlockType::AIR ? 1 : 0;
+                    faces += y > 0 && blocks.Get(x, y - 1, z) == BlockType::AIR ? 1 : 0;
+                    faces += y + 1 < CHUNK_SIZE_Y && blocks.Get(x, y + 1, z) == BlockType::AIR ? 1 : 0;
+                    faces += z > 0 && blocks.Get(x, y, z - 1) == BlockType::AIR ? 1 : 0;
+                    faces += z + 1 < CHUNK_SIZE_Z && blocks.Get(x, y, z + 1) == BlockType::AIR ? 1 : 0;
+                }
+            }
+        }
+    }
+    return faces;
+}
+
+template<typename Blocks>
+static void RunLayout(const char* name, const std::vector<uint32_t>& lookups)
+{
+    printf("  %s\n", name);
+    std::vector<Blocks*> chunks;
+    BenchTimer timer;
+    for (uint32_t i = 0; i < BENCH_CHUNKS; ++i)
+    {
+        chunks.push_back(new Blocks());
+        Generate(*chunks.back(), i);
+    }
+    PrintBenchResult("allocate and generate", timer.GetMilliseconds(), (uint64_t) BENCH_CHUNKS * CHUNK_BLOCK_COUNT);
+
+    uint64_t result = 0;
+    timer = BenchTimer();
+    for (const Blocks* blocks : chunks)
+        result += CountSolid(*blocks);
+    PrintBenchResult("scan", timer.GetMilliseconds(), (uint64_t) BENCH_CHUNKS * CHUNK_BLOCK_COUNT);
+
+    timer = BenchTimer();
+    for (const Blocks* blocks : chunks)
+        result += CountVisibleFaces(*blocks);
+    PrintBenchResult("scan with neighbor lookups", timer.GetMilliseconds(), (uint64_t) BENCH_CHUNKS * CHUNK_BLOCK_COUNT);
+
+    // a block of a random chunk like the block queries of the player and the physics
+    timer = BenchTimer();
+    for (uint32_t lookup : lookups)
+    {
+        const Blocks* blocks = chunks[lookup % BENCH_CHUNKS];
+        result += (uint64_t) blocks->Get((lookup >> 6) % CHUNK_SIZE_X, (lookup >> 10) % CHUNK_SIZE_Y, (lookup >> 17) % CHUNK_SIZE_Z);
+    }
+    PrintBenchResult("random lookups", timer.GetMilliseconds(), lookups.size());
+
+    for (Blocks* blocks : chunks)
+        delete blocks;
+    printf("    checksum %llu\n", (unsigned long long) result);
+}
+
+int main()
+{
+    printf("ChunkLayoutBench\n");
+    std::mt19937 random(1234);
+    std::vector<uint32_t> lookups(BENCH_RANDOM_LOOKUPS);
+    for (uint32_t& lookup : lookups)
+        lookup = random();
+
+    // the checksums have to match, the layouts hold the same blocks
+    RunLayout<JaggedBlocks>("jagged BlockType*** arrays", lookups);
+    RunLayout<ColumnBlocks>("flat buffer, y-major sections", lookups);
+    RunLayout<MortonBlocks>("flat buffer, z-order sections", lookups);
+    return 0;
+}
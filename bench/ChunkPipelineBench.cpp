@@ -0,0 +1,336 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#include <stdlib.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "Bench.h"
+#include "../src/utils/JobSystem.h"
+#include "../src/utils/RingBuffer.h"
+#include "../src/world/chunk/ChunkGenerator.h"
+#include "../src/world/chunk/ChunkMesher.h"
+#include "../src/world/chunk/ChunkSnapshot.h"
+#include "../src/world/chunk/RegionStorage.h"
+
+// the circle of chunks around the player, the upload budget of CHUNK_UPLOADS_PER_FRAME and the queue of ChunkManager
+#define BENCH_CHUNK_RADIUS 8
+#define BENCH_UPLOADS_PER_FRAME 2
+#define BENCH_MESHED_QUEUE_SIZE 2048
+// every few chunks has edits in the region files which the load stage applies
+#define BENCH_EDITED_CHUNK_STEP 4
+#define BENCH_EDITS_PER_CHUNK 32
+
+/**
+ * The stages of ChunkManager on the host: generate and load the edits on workers, capture the snapshot on the main
+ * thread once the neighbors are loaded, mesh on workers and upload a bounded number of meshes per frame, closest first.
+ * The display list recording of the upload needs the GPU, it is stood in for by walking the render lists.
+ */
+struct BenchChunk
+{
+    ChunkCoord Coord;
+    ChunkSections Blocks;
+    std::atomic<bool> bLoaded;
+    bool bMeshQueued = false;
+    bool bUploaded = false;
+    int32_t Neighbors[CHUNK_NEIGHBOR_COUNT];
+    SectionRenderList Sections[CHUNK_SECTION_COUNT];
+};
+
+struct PipelineResult
+{
+    double Milliseconds = 0.0;
+    double FirstRingMilliseconds = 0.0;
+    double LongestFrameMilliseconds = 0.0;
+    uint32_t Frames = 0;
+    uint64_t Quads = 0;
+};
+
+static PerlinNoise s_noise(.10, .1, .5, 6, 1234);
+
+static std::vector<ChunkCoord> GetChunksAround()
+{
+    std::vector<ChunkCoord> coords;
+    for (int32_t x = -BENCH_CHUNK_RADIUS; x <= BENCH_CHUNK_RADIUS; ++x)
+    {
+        for (int32_t z = -BENCH_CHUNK_RADIUS; z <= BENCH_CHUNK_RADIUS; ++z)
+        {
+            if (x * x + z * z <= BENCH_CHUNK_RADIUS * BENCH_CHUNK_RADIUS)
+                coords.push_back(ChunkCoord { x, z });
+        }
+    }
+
+    const ChunkCoord center = { 0, 0 };
+    std::sort(coords.begin(), coords.end(), [&center](const ChunkCoord& a, const ChunkCoord& b)
+    {
+        return GetChunkDistanceSquared(a, center) < GetChunkDistanceSquared(b, center);
+    });
+    return coords;
+}
+
+static void WriteEdits(RegionStorage& storage, const std::vector<ChunkCoord>& coords)
+{
+    for (size_t i = 0; i < coords.size(); i += BENCH_EDITED_CHUNK_STEP)
+    {
+        // a shaft dug into the ground of the chunk
+        std::vector<ChunkFileEdit> edits;
+        for (uint32_t y = 0; y < BENCH_EDITS_PER_CHUNK; ++y)
+            edits.push_back(ChunkFileEdit { 4, (uint8_t) (CHUNK_MIN_GROUND - 1 - y % CHUNK_MIN_GROUND), (uint8_t) (y % CHUNK_SIZE_Z), (uint8_t) BlockType::AIR });
+
+        uint32_t editCount = 0;
+        storage.AppendEdits(coords[i], edits, editCount);
+    }
+}
+
+// like LoadChunkJob, the stored blocks replace the generated ones
+static void LoadChunk(BenchChunk& chunk, RegionStorage& storage)
+{
+    ChunkGenerator::Generate(s_noise, chunk.Coord, chunk.Blocks);
+
+    ChunkFileData fileData;
+    if (storage.LoadChunk(chunk.Coord, fileData))
+    {
+        for (uint32_t x = 0; x < CHUNK_SIZE_X; ++x)
+        {
+            for (uint32_t z = 0; z < CHUNK_SIZE_Z; ++z)
+            {
+                const uint8_t* column = &fileData.Blocks[ChunkFile::GetIndex(x, 0, z)];
+                for (uint32_t y = 0; y < CHUNK_SIZE_Y; ++y)
+                {
+                    if (column[y] != CHUNK_FILE_UNCHANGED)
+                        chunk.Blocks.Set(x, y, z, BlockType(column[y]));
+                }
+            }
+        }
+    }
+
+    chunk.bLoaded.store(true, std::memory_order_release);
+}
+
+static void MeshChunk(BenchChunk& chunk, const ChunkSnapshot& snapshot, EMeshingMode mode)
+{
+    std::vector<uint8_t> faceMasks;
+    for (uint32_t section = 0; section < CHUNK_SECTION_COUNT; ++section)
+    {
+        SectionRenderList& renderList = chunk.Sections[section];
+        const ESectionState state = snapshot.GetState(section);
+        if (state == ESectionState::Air || (state == ESectionState::Opaque && ChunkMesher::IsSectionBuried(snapshot, section)))
+        {
+            renderList = SectionRenderList();
+            continue;
+        }
+
+        ChunkMesher::MeshSection(snapshot, section, mode, renderList, faceMasks);
+    }
+}
+
+// what the recording of the display list reads, the quads of every block type
+static uint64_t UploadChunk(const BenchChunk& chunk)
+{
+    uint64_t quads = 0;
+    for (const SectionRenderList& renderList : chunk.Sections)
+    {
+        for (const auto& entry : renderList.BlockRenderList)
+        {
+            for (const BlockRenderVO& block : entry.second)
+                quads += block.Faces;
+        }
+
+        for (const auto& entry : renderList.BlockQuadList)
+            quads += entry.second.size();
+    }
+    return quads;
+}
+
+static std::shared_ptr<const ChunkSnapshot> CreateSnapshot(const std::vector<std::unique_ptr<BenchChunk> >& chunks, const BenchChunk& chunk)
+{
+    const ChunkSections* neighbors[CHUNK_NEIGHBOR_COUNT];
+    for (uint32_t i = 0; i < CHUNK_NEIGHBOR_COUNT; ++i)
+        neighbors[i] = chunk.Neighbors[i] >= 0 ? &chunks[chunk.Neighbors[i]]->Blocks : nullptr;
+
+    return std::make_shared<const ChunkSnapshot>(chunk.Blocks, neighbors, (1u << CHUNK_SECTION_COUNT) - 1);
+}
+
+static PipelineResult RunPipeline(const std::vector<ChunkCoord>& coords, RegionStorage& storage, EMeshingMode mode)
+{
+    std::vector<std::unique_ptr<BenchChunk> > chunks;
+    for (const ChunkCoord& coord : coords)
+    {
+        BenchChunk* chunk = new BenchChunk();
+        chunk->Coord = coord;
+        chunk->bLoaded = false;
+        chunks.emplace_back(chunk);
+    }
+
+    // neighbors in EBlockFaces order, chunks outside of the circle are missing
+    const ChunkCoord offsets[CHUNK_NEIGHBOR_COUNT] = { { -1, 0 }, { 1, 0 }, { 0, 1 }, { 0, -1 } };
+    for (auto& chunk : chunks)
+    {
+        for (uint32_t i = 0; i < CHUNK_NEIGHBOR_COUNT; ++i)
+        {
+            const ChunkCoord neighbor = { chunk->Coord.X + offsets[i].X, chunk->Coord.Z + offsets[i].Z };
+            auto it = std::find(coords.begin(), coords.end(), neighbor);
+            chunk->Neighbors[i] = it != coords.end() ? (int32_t) (it - coords.begin()) : -1;
+        }
+    }
+
+    PipelineResult result;
+    static MpscRingBuffer<BenchChunk*, BENCH_MESHED_QUEUE_SIZE> meshedChunks;
+    std::vector<BenchChunk*> chunksToUpload;
+    uint32_t uploaded = 0;
+    BenchTimer timer;
+
+    // workers run their newest job first, so the closest chunk is scheduled last
+    for (auto it = chunks.rbegin(); it != chunks.rend(); ++it)
+    {
+        BenchChunk* chunk = it->get();
+        RegionStorage* pStorage = &storage;
+        JobSystem::Schedule([chunk, pStorage]() { LoadChunk(*chunk, *pStorage); });
+    }
+
+    while (uploaded < chunks.size())
+    {
+        BenchTimer frameTimer;
+        uint32_t scheduled = 0;
+        for (auto it = chunks.rbegin(); it != chunks.rend(); ++it)
+        {
+            BenchChunk* chunk = it->get();
+            if (chunk->bMeshQueued || !chunk->bLoaded.load(std::memory_order_acquire))
+                continue;
+
+            bool bNeighborsLoaded = true;
+            for (int32_t neighbor : chunk->Neighbors)
+                bNeighborsLoaded &= neighbor < 0 || chunks[neighbor]->bLoaded.load(std::memory_order_acquire);
+            if (!bNeighborsLoaded)
+                continue;
+
+            chunk->bMeshQueued = true;
+            scheduled++;
+            std::shared_ptr<const ChunkSnapshot> snapshot = CreateSnapshot(chunks, *chunk);
+            JobSystem::Schedule([chunk, snapshot, mode]()
+            {
+                MeshChunk(*chunk, *snapshot, mode);
+                BenchChunk* meshed = chunk;
+                meshedChunks.TryPush(std::move(meshed));
+            });
+        }
+
+        meshedChunks.Drain(chunksToUpload);
+        std::sort(chunksToUpload.begin(), chunksToUpload.end(), [](const BenchChunk* a, const BenchChunk* b)
+        {
+            const ChunkCoord center = { 0, 0 };
+            return GetChunkDistanceSquared(a->Coord, center) < GetChunkDistanceSquared(b->Coord, center);
+        });
+
+        uint32_t uploads = 0;
+        for (; uploads < chunksToUpload.size() && uploads < BENCH_UPLOADS_PER_FRAME; ++uploads)
+        {
+            result.Quads += UploadChunk(*chunksToUpload[uploads]);
+            chunksToUpload[uploads]->bUploaded = true;
+        }
+        chunksToUpload.erase(chunksToUpload.begin(), chunksToUpload.begin() + uploads);
+        uploaded += uploads;
+
+        // the chunk of the player and the ones around it
+        if (result.FirstRingMilliseconds == 0.0 && std::all_of(chunks.begin(), chunks.begin() + 9, [](const std::unique_ptr<BenchChunk>& chunk) { return chunk->bUploaded; }))
+            result.FirstRingMilliseconds = timer.GetMilliseconds();
+
+        // only the frames which did work count, the idle ones wait for the workers
+        if (uploads > 0 || scheduled > 0)
+        {
+            result.LongestFrameMilliseconds = std::max(result.LongestFrameMilliseconds, frameTimer.GetMilliseconds());
+            result.Frames++;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    result.Milliseconds = timer.GetMilliseconds();
+    return result;
+}
+
+static void PrintPipelineResult(const char* name, uint32_t workers, uint32_t chunkCount, const PipelineResult& result)
+{
+    char label[64];
+    snprintf(label, sizeof(label), "%s, %u workers", name, workers);
+    PrintBenchResult(label, result.Milliseconds, chunkCount);
+    printf("    center 3x3 after %.1f ms, %u frames, longest frame %.3f ms, %llu quads\n", result.FirstRingMilliseconds,
+           result.Frames, result.LongestFrameMilliseconds, (unsigned long long) result.Quads);
+}
+
+int main()
+{
+    printf("ChunkPipelineBench\n");
+    char directory[] = "/tmp/ChunkPipelineBenchXXXXXX";
+    if (!mkdtemp(directory))
+        return 1;
+
+    RegionStorage storage;
+    storage.Init(directory);
+    const std::vector<ChunkCoord> coords = GetChunksAround();
+    WriteEdits(storage, coords);
+
+    // the cost of the stages for one chunk on the calling thread
+    {
+        std::unique_ptr<BenchChunk> chunk(new BenchChunk());
+        chunk->Coord = coords[0];
+        BenchTimer timer;
+        for (uint32_t i = 0; i < 64; ++i)
+            ChunkGenerator::Generate(s_noise, chunk->Coord, chunk->Blocks);
+        PrintBenchResult("generate a chunk", timer.GetMilliseconds() / 64, 1);
+
+        const ChunkSections* neighbors[CHUNK_NEIGHBOR_COUNT] = { &chunk->Blocks, &chunk->Blocks, &chunk->Blocks, &chunk->Blocks };
+        timer = BenchTimer();
+        for (uint32_t i = 0; i < 64; ++i)
+            ChunkSnapshot snapshot(chunk->Blocks, neighbors, (1u << CHUNK_SECTION_COUNT) - 1);
+        PrintBenchResult("snapshot a chunk", timer.GetMilliseconds() / 64, 1);
+
+        ChunkSnapshot snapshot(chunk->Blocks, neighbors, (1u << CHUNK_SECTION_COUNT) - 1);
+        timer = BenchTimer();
+        for (uint32_t i = 0; i < 64; ++i)
+            MeshChunk(*chunk, snapshot, EMeshingMode::PerFace);
+        PrintBenchResult("mesh a chunk per face", timer.GetMilliseconds() / 64, 1);
+
+        timer = BenchTimer();
+        for (uint32_t i = 0; i < 64; ++i)
+            MeshChunk(*chunk, snapshot, EMeshingMode::Greedy);
+        PrintBenchResult("mesh a chunk greedy", timer.GetMilliseconds() / 64, 1);
+    }
+
+    ThreadPool::Init();
+    for (uint32_t workers = 0; workers <= JOB_SYSTEM_WORKERS; ++workers)
+    {
+        JobSystem::Init(workers);
+        PrintPipelineResult("load and mesh the view", workers, coords.size(), RunPipeline(coords, storage, EMeshingMode::Greedy));
+        JobSystem::Destroy();
+    }
+    ThreadPool::Destroy();
+
+    storage.Close();
+    remove((std::string(directory) + "/" + RegionStorage::GetRegionFileName(ChunkCoord { -1, -1 })).c_str());
+    remove((std::string(directory) + "/" + RegionStorage::GetRegionFileName(ChunkCoord { 0, -1 })).c_str());
+    remove((std::string(directory) + "/" + RegionStorage::GetRegionFileName(ChunkCoord { -1, 0 })).c_str());
+    remove((std::string(directory) + "/" + RegionStorage::GetRegionFileName(ChunkCoord { 0, 0 })).c_str());
+    remove(directory);
+    return 0;
+}
@@ -0,0 +1,272 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#include <math.h>
+#include <algorithm>
+#include <vector>
+#include "Bench.h"
+#include "../src/world/FrustumCuller.h"
+#include "../src/world/PerlinNoise.h"
+
+// 41x41 chunk columns around the start of the paths
+#define BENCH_CHUNK_RADIUS 20
+#define BENCH_FRAMES_PER_KEY 60
+#define BENCH_EYE_HEIGHT (1.6f * BLOCK_SIZE)
+// the projection of Basic3DScene on a 4:3 screen
+#define BENCH_NEAR 0.1f
+#define BENCH_FAR 200.0f
+#define BENCH_ASPECT (4.0f / 3.0f)
+
+struct CameraKey
+{
+    float X;
+    float Z;
+    // above the ground below the camera
+    float Height;
+    float Yaw;
+    float Pitch;
+};
+
+struct CameraPath
+{
+    const char* Name;
+    std::vector<CameraKey> Keys;
+};
+
+static PerlinNoise s_noise(.10, .1, .5, 6, 1234);
+
+// the terrain height of ChunkGenerator::GetTerrainHeight in blocks
+static uint32_t GetTerrainHeight(double xWorld, double zWorld)
+{
+    const double height = CHUNK_SIZE_Y * s_noise.GetHeight(xWorld, zWorld) + CHUNK_MIN_GROUND;
+    return (uint32_t) std::min<double>(CHUNK_SIZE_Y, std::max<double>(CHUNK_MIN_GROUND, height));
+}
+
+// the render bounds of Chunk::GetRenderBounds, they span the sections with surface blocks
+static std::vector<CullChunk> BuildChunks(int32_t offsetX)
+{
+    std::vector<CullChunk> chunks;
+    for (int32_t chunkX = -BENCH_CHUNK_RADIUS; chunkX <= BENCH_CHUNK_RADIUS; ++chunkX)
+    {
+        for (int32_t chunkZ = -BENCH_CHUNK_RADIUS; chunkZ <= BENCH_CHUNK_RADIUS; ++chunkZ)
+        {
+            const float originX = (chunkX + offsetX) * CHUNK_BLOCK_SIZE_X;
+            const float originZ = chunkZ * CHUNK_BLOCK_SIZE_Z;
+            uint32_t lowest = CHUNK_SIZE_Y;
+            uint32_t highest = 0;
+            for (uint32_t x = 0; x < CHUNK_SIZE_X; ++x)
+            {
+                for (uint32_t z = 0; z < CHUNK_SIZE_Z; ++z)
+                {
+                    const uint32_t height = GetTerrainHeight(originX + x * BLOCK_SIZE, originZ + z * BLOCK_SIZE);
+                    lowest = std::min(lowest, height - 1);
+                    highest = std::max(highest, height - 1);
+                }
+            }
+
+            const float minY = -BLOCK_SIZE_HALF;
+            CullChunk chunk;
+            chunk.ChunkObj = nullptr;
+            chunk.Coord = ChunkCoord { chunkX + offsetX, chunkZ };
+            chunk.HasGeometry = true;
+            chunk.Box = CullBox { { originX - BLOCK_SIZE_HALF, minY + (lowest / CHUNK_SECTION_SIZE) * CHUNK_SECTION_SIZE * BLOCK_SIZE,
+                                    originZ - BLOCK_SIZE_HALF, originX - BLOCK_SIZE_HALF + CHUNK_BLOCK_SIZE_X,
+                                    minY + (highest / CHUNK_SECTION_SIZE + 1) * CHUNK_SECTION_SIZE * BLOCK_SIZE,
+                                    originZ - BLOCK_SIZE_HALF + CHUNK_BLOCK_SIZE_Z } };
+            chunks.push_back(chunk);
+        }
+    }
+
+    return chunks;
+}
+
+// the paths of OcclusionBufferBench, yaw 0 looks down -z
+static std::vector<CameraPath> GetCameraPaths()
+{
+    return
+    {
+        { "walk through the hills", { { 0.0f, 0.0f, BENCH_EYE_HEIGHT, 0.0f, 0.0f }, { 4.0f, -12.0f, BENCH_EYE_HEIGHT, 0.3f, 0.05f },
+                                      { 10.0f, -20.0f, BENCH_EYE_HEIGHT, 0.9f, -0.1f }, { 18.0f, -22.0f, BENCH_EYE_HEIGHT, 1.6f, 0.0f },
+                                      { 26.0f, -18.0f, BENCH_EYE_HEIGHT, 2.2f, 0.1f } } },
+        { "look around on the ground", { { -8.0f, 6.0f, BENCH_EYE_HEIGHT, 0.0f, 0.0f }, { -8.0f, 6.0f, BENCH_EYE_HEIGHT, 1.57f, -0.2f },
+                                         { -8.0f, 6.0f, BENCH_EYE_HEIGHT, 3.14f, 0.0f }, { -8.0f, 6.0f, BENCH_EYE_HEIGHT, 4.71f, 0.2f },
+                                         { -8.0f, 6.0f, BENCH_EYE_HEIGHT, 6.28f, 0.0f } } },
+        { "fly over the terrain", { { -30.0f, 30.0f, 20.0f, 0.8f, -0.35f }, { -10.0f, 10.0f, 16.0f, 0.8f, -0.3f },
+                                    { 10.0f, -10.0f, 12.0f, 0.6f, -0.2f }, { 30.0f, -30.0f, 10.0f, 0.4f, -0.1f } } },
+    };
+}
+
+// the planes of Frustrum::CalculateFrustum for a camera at the position, rotated by yaw around y and pitch up
+static void GetPlanes(float x, float y, float z, float yaw, float pitch, float planes[FRUSTUM_PLANE_COUNT][4])
+{
+    const float forward[3] = { -sinf(yaw) * cosf(pitch), sinf(pitch), -cosf(yaw) * cosf(pitch) };
+    const float right[3] = { cosf(yaw), 0.0f, -sinf(yaw) };
+    const float up[3] = { right[1] * forward[2] - right[2] * forward[1], right[2] * forward[0] - right[0] * forward[2],
+                          right[0] * forward[1] - right[1] * forward[0] };
+
+    // GX maps the depth to [-1, 0] and w is the distance along the view direction
+    float clip[16];
+    const float* rows[4] = { right, up, forward, forward };
+    const float scales[4] = { 1.0f / BENCH_ASPECT, 1.0f, BENCH_NEAR / (BENCH_FAR - BENCH_NEAR), 1.0f };
+    for (uint32_t row = 0; row < 4; ++row)
+    {
+        const float* axis = rows[row];
+        clip[row * 4 + 0] = scales[row] * axis[0];
+        clip[row * 4 + 1] = scales[row] * axis[1];
+        clip[row * 4 + 2] = scales[row] * axis[2];
+        clip[row * 4 + 3] = -scales[row] * (axis[0] * x + axis[1] * y + axis[2] * z);
+    }
+    clip[11] -= BENCH_FAR * BENCH_NEAR / (BENCH_FAR - BENCH_NEAR);
+
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        planes[0][i] = clip[12 + i] - clip[0 + i];
+        planes[1][i] = clip[12 + i] + clip[0 + i];
+        planes[2][i] = clip[12 + i] + clip[4 + i];
+        planes[3][i] = clip[12 + i] - clip[4 + i];
+        planes[4][i] = -clip[8 + i];
+        planes[5][i] = clip[12 + i] + clip[8 + i];
+    }
+
+    for (uint32_t plane = 0; plane < FRUSTUM_PLANE_COUNT; ++plane)
+    {
+        const float magnitude = sqrtf(planes[plane][0] * planes[plane][0] + planes[plane][1] * planes[plane][1] + planes[plane][2] * planes[plane][2]);
+        for (uint32_t i = 0; i < 4; ++i)
+            planes[plane][i] /= magnitude;
+    }
+}
+
+// the test of Frustrum::CubeInFrustum, every corner against every plane
+static bool IsCubeInFrustum(const float planes[FRUSTUM_PLANE_COUNT][4], const CullBox& box)
+{
+    for (uint32_t plane = 0; plane < FRUSTUM_PLANE_COUNT; ++plane)
+    {
+        bool bOutside = true;
+        for (uint32_t i = 0; i < 8 && bOutside; ++i)
+        {
+            const float x = box.Bounds[i & 1 ? 3 : 0];
+            const float y = box.Bounds[i & 2 ? 4 : 1];
+            const float z = box.Bounds[i & 4 ? 5 : 2];
+            bOutside = planes[plane][0] * x + planes[plane][1] * y + planes[plane][2] * z + planes[plane][3] <= 0.0f;
+        }
+
+        if (bOutside)
+            return false;
+    }
+
+    return true;
+}
+
+static bool RunPath(const CameraPath& path, const std::vector<CullChunk>& chunks)
+{
+    FrustumCuller culler;
+    culler.Update(chunks);
+    std::vector<uint8_t> cachedPlanes(chunks.size(), 0);
+    std::vector<VisibleChunk> visibleChunks;
+    ChunkRenderStats stats;
+    uint64_t cornerVisible = 0;
+    uint64_t boxVisible = 0;
+    uint64_t treeVisible = 0;
+    double cornerMs = 0.0;
+    double boxMs = 0.0;
+    double treeMs = 0.0;
+    uint32_t frames = 0;
+    bool bMatching = true;
+
+    for (size_t key = 0; key + 1 < path.Keys.size(); ++key)
+    {
+        for (uint32_t frame = 0; frame < BENCH_FRAMES_PER_KEY; ++frame, ++frames)
+        {
+            const CameraKey& from = path.Keys[key];
+            const CameraKey& to = path.Keys[key + 1];
+            const float t = (float) frame / BENCH_FRAMES_PER_KEY;
+            const float x = from.X + (to.X - from.X) * t;
+            const float z = from.Z + (to.Z - from.Z) * t;
+            const float y = GetTerrainHeight(x, z) * BLOCK_SIZE + from.Height + (to.Height - from.Height) * t;
+            float planes[FRUSTUM_PLANE_COUNT][4];
+            GetPlanes(x, y, z, from.Yaw + (to.Yaw - from.Yaw) * t, from.Pitch + (to.Pitch - from.Pitch) * t, planes);
+            for (uint32_t plane = 0; plane < FRUSTUM_PLANE_COUNT; ++plane)
+                culler.SetPlane(plane, planes[plane]);
+
+            BenchTimer cornerTimer;
+            uint32_t frameCornerVisible = 0;
+            for (const CullChunk& chunk : chunks)
+                frameCornerVisible += IsCubeInFrustum(planes, chunk.Box) ? 1 : 0;
+            cornerMs += cornerTimer.GetMilliseconds();
+
+            BenchTimer boxTimer;
+            uint32_t frameBoxVisible = 0;
+            for (size_t i = 0; i < chunks.size(); ++i)
+            {
+                uint8_t planeMask = FRUSTUM_ALL_PLANES;
+                frameBoxVisible += culler.TestBox(chunks[i].Box, planeMask, cachedPlanes[i]) != ECullResult::Outside ? 1 : 0;
+            }
+            boxMs += boxTimer.GetMilliseconds();
+
+            BenchTimer treeTimer;
+            visibleChunks.clear();
+            culler.Cull(visibleChunks, stats);
+            treeMs += treeTimer.GetMilliseconds();
+
+            // all three tests reject a box only if it is outside of one plane, so they keep the same boxes
+            bMatching &= frameCornerVisible == frameBoxVisible && frameBoxVisible == visibleChunks.size();
+            cornerVisible += frameCornerVisible;
+            boxVisible += frameBoxVisible;
+            treeVisible += visibleChunks.size();
+        }
+    }
+
+    printf("  %s\n", path.Name);
+    printf("    %u frames, %.1f of %u boxes visible, %.1f%% culled, %.1f box tests per frame in the quadtree\n", frames,
+           (double) treeVisible / frames, (uint32_t) chunks.size(), 100.0 - 100.0 * treeVisible / ((double) frames * chunks.size()),
+           (double) stats.BoxTests / frames);
+    PrintBenchResult("every corner per box per frame", cornerMs / frames, chunks.size());
+    PrintBenchResult("p/n-vertex per box per frame", boxMs / frames, chunks.size());
+    PrintBenchResult("quadtree per frame", treeMs / frames, chunks.size());
+    s_benchSink += cornerVisible + boxVisible;
+
+    if (!bMatching)
+        printf("    the tests kept different boxes\n");
+    return bMatching;
+}
+
+int main()
+{
+    printf("FrustumCullerBench\n");
+    const std::vector<CullChunk> chunks = BuildChunks(0);
+    bool bMatching = true;
+    for (const CameraPath& path : GetCameraPaths())
+        bMatching &= RunPath(path, chunks);
+
+    // the player crossed a chunk border, the tree is built again for the moved chunks
+    const std::vector<CullChunk> movedChunks = BuildChunks(1);
+    FrustumCuller culler;
+    const uint32_t rebuilds = 64;
+    BenchTimer timer;
+    for (uint32_t i = 0; i < rebuilds; ++i)
+        culler.Update(i & 1 ? movedChunks : chunks);
+    PrintBenchResult("rebuild the quadtree", timer.GetMilliseconds() / rebuilds, chunks.size());
+
+    timer = BenchTimer();
+    for (uint32_t i = 0; i < rebuilds; ++i)
+        culler.Update(chunks);
+    PrintBenchResult("refit the quadtree", timer.GetMilliseconds() / rebuilds, chunks.size());
+
+    return bMatching ? 0 : 1;
+}
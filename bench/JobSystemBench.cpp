@@ -0,0 +1,113 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#include <atomic>
+#include <vector>
+#include "Bench.h"
+#include "../src/utils/JobSystem.h"
+
+#define BENCH_SMALL_JOBS 200000
+#define BENCH_LARGE_JOBS 256
+#define BENCH_LARGE_JOB_STEPS 200000
+
+// about the work of meshing a section, enough to hide the cost of scheduling
+static uint64_t LargeWork(uint64_t seed)
+{
+    uint64_t value = seed;
+    for (uint32_t i = 0; i < BENCH_LARGE_JOB_STEPS; ++i)
+        value = value * 6364136223846793005ULL + 1442695040888963407ULL;
+    return value;
+}
+
+static void RunSmallJobs(uint32_t workers)
+{
+    std::atomic<uint32_t> counter(0);
+    std::vector<JobHandle> handles;
+    handles.reserve(BENCH_SMALL_JOBS);
+
+    BenchTimer timer;
+    for (uint32_t i = 0; i < BENCH_SMALL_JOBS; ++i)
+        handles.push_back(JobSystem::Schedule([&counter]() { counter++; }));
+    for (auto& handle : handles)
+        JobSystem::Wait(handle);
+
+    char name[64];
+    snprintf(name, sizeof(name), "small jobs, %u workers", workers);
+    PrintBenchResult(name, timer.GetMilliseconds(), BENCH_SMALL_JOBS);
+}
+
+static void RunSmallChain(uint32_t workers)
+{
+    uint32_t counter = 0;
+    JobHandle last;
+
+    BenchTimer timer;
+    for (uint32_t i = 0; i < BENCH_SMALL_JOBS; ++i)
+        last = JobSystem::Schedule([&counter]() { counter++; }, last);
+    JobSystem::Wait(last);
+
+    char name[64];
+    snprintf(name, sizeof(name), "small dependent jobs, %u workers", workers);
+    PrintBenchResult(name, timer.GetMilliseconds(), BENCH_SMALL_JOBS);
+    s_benchSink = counter;
+}
+
+static void RunLargeJobs(uint32_t workers)
+{
+    std::vector<uint64_t> results(BENCH_LARGE_JOBS);
+    std::vector<JobHandle> handles;
+
+    BenchTimer timer;
+    for (uint32_t i = 0; i < BENCH_LARGE_JOBS; ++i)
+    {
+        uint64_t* result = &results[i];
+        handles.push_back(JobSystem::Schedule([result, i]() { *result = LargeWork(i); }));
+    }
+    for (auto& handle : handles)
+        JobSystem::Wait(handle);
+
+    char name[64];
+    snprintf(name, sizeof(name), "large jobs, %u workers", workers);
+    PrintBenchResult(name, timer.GetMilliseconds(), BENCH_LARGE_JOBS);
+    s_benchSink = results.back();
+}
+
+int main()
+{
+    printf("JobSystemBench\n");
+    ThreadPool::Init();
+
+    // the work of the large jobs on the calling thread, without the job system
+    BenchTimer timer;
+    for (uint32_t i = 0; i < BENCH_LARGE_JOBS; ++i)
+        s_benchSink = LargeWork(i);
+    PrintBenchResult("large work, no job system", timer.GetMilliseconds(), BENCH_LARGE_JOBS);
+
+    for (uint32_t workers = 1; workers <= JOB_SYSTEM_MAX_WORKERS - 1; ++workers)
+    {
+        JobSystem::Init(workers);
+        RunSmallJobs(workers);
+        RunSmallChain(workers);
+        RunLargeJobs(workers);
+        JobSystem::Destroy();
+    }
+
+    ThreadPool::Destroy();
+    return 0;
+}
@@ -0,0 +1,269 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#include <math.h>
+#include <algorithm>
+#include <vector>
+#include "Bench.h"
+#include "../src/world/OcclusionBuffer.h"
+#include "../src/world/PerlinNoise.h"
+
+// chunks around the start of the paths, the occluders of one chunk are 2x2 columns like CHUNK_OCCLUDER_CELLS
+#define BENCH_CHUNK_RADIUS 8
+#define BENCH_OCCLUDER_CELLS 2
+#define BENCH_FRAMES_PER_KEY 60
+#define BENCH_EYE_HEIGHT (1.6f * BLOCK_SIZE)
+// the projection of Basic3DScene on a 4:3 screen
+#define BENCH_NEAR 0.1f
+#define BENCH_FAR 200.0f
+#define BENCH_ASPECT (4.0f / 3.0f)
+
+struct CameraKey
+{
+    float X;
+    float Z;
+    // above the ground below the camera
+    float Height;
+    float Yaw;
+    float Pitch;
+};
+
+struct CameraPath
+{
+    const char* Name;
+    std::vector<CameraKey> Keys;
+};
+
+struct BenchChunk
+{
+    CullBox Bounds;
+    CullBox Occluders[BENCH_OCCLUDER_CELLS * BENCH_OCCLUDER_CELLS];
+    float CenterX;
+    float CenterZ;
+};
+
+static PerlinNoise s_noise(.10, .1, .5, 6, 1234);
+
+// the terrain height of Chunk::GetTerrainHeight in blocks
+static uint32_t GetTerrainHeight(double xWorld, double zWorld)
+{
+    const double height = CHUNK_SIZE_Y * s_noise.GetHeight(xWorld, zWorld) + CHUNK_MIN_GROUND;
+    return (uint32_t) std::min<double>(CHUNK_SIZE_Y, std::max<double>(CHUNK_MIN_GROUND, height));
+}
+
+// the render bounds span the sections with surface blocks, the occluders the solid columns below the lowest surface of a cell
+static std::vector<BenchChunk> BuildChunks()
+{
+    std::vector<BenchChunk> chunks;
+    const uint32_t cellSize = CHUNK_SIZE_X / BENCH_OCCLUDER_CELLS;
+    for (int32_t chunkX = -BENCH_CHUNK_RADIUS; chunkX <= BENCH_CHUNK_RADIUS; ++chunkX)
+    {
+        for (int32_t chunkZ = -BENCH_CHUNK_RADIUS; chunkZ <= BENCH_CHUNK_RADIUS; ++chunkZ)
+        {
+            BenchChunk chunk;
+            const float originX = chunkX * CHUNK_BLOCK_SIZE_X;
+            const float originZ = chunkZ * CHUNK_BLOCK_SIZE_Z;
+            uint32_t cellHeights[BENCH_OCCLUDER_CELLS * BENCH_OCCLUDER_CELLS];
+            std::fill(cellHeights, cellHeights + BENCH_OCCLUDER_CELLS * BENCH_OCCLUDER_CELLS, CHUNK_SIZE_Y);
+            uint32_t lowest = CHUNK_SIZE_Y;
+            uint32_t highest = 0;
+
+            for (uint32_t x = 0; x < CHUNK_SIZE_X; ++x)
+            {
+                for (uint32_t z = 0; z < CHUNK_SIZE_Z; ++z)
+                {
+                    const uint32_t height = GetTerrainHeight(originX + x * BLOCK_SIZE, originZ + z * BLOCK_SIZE);
+                    uint32_t& cellHeight = cellHeights[(x / cellSize) * BENCH_OCCLUDER_CELLS + z / cellSize];
+                    cellHeight = std::min(cellHeight, height);
+                    lowest = std::min(lowest, height - 1);
+                    highest = std::max(highest, height - 1);
+                }
+            }
+
+            const float minY = -BLOCK_SIZE_HALF;
+            chunk.Bounds = CullBox { { originX - BLOCK_SIZE_HALF, minY + (lowest / CHUNK_SECTION_SIZE) * CHUNK_SECTION_SIZE * BLOCK_SIZE,
+                                       originZ - BLOCK_SIZE_HALF, originX - BLOCK_SIZE_HALF + CHUNK_BLOCK_SIZE_X,
+                                       minY + (highest / CHUNK_SECTION_SIZE + 1) * CHUNK_SECTION_SIZE * BLOCK_SIZE,
+                                       originZ - BLOCK_SIZE_HALF + CHUNK_BLOCK_SIZE_Z } };
+
+            for (uint32_t cell = 0; cell < BENCH_OCCLUDER_CELLS * BENCH_OCCLUDER_CELLS; ++cell)
+            {
+                CullBox& box = chunk.Occluders[cell];
+                box.Bounds[0] = originX - BLOCK_SIZE_HALF + (cell / BENCH_OCCLUDER_CELLS) * cellSize * BLOCK_SIZE;
+                box.Bounds[1] = minY;
+                box.Bounds[2] = originZ - BLOCK_SIZE_HALF + (cell % BENCH_OCCLUDER_CELLS) * cellSize * BLOCK_SIZE;
+                box.Bounds[3] = box.Bounds[0] + cellSize * BLOCK_SIZE;
+                box.Bounds[4] = minY + cellHeights[cell] * BLOCK_SIZE;
+                box.Bounds[5] = box.Bounds[2] + cellSize * BLOCK_SIZE;
+            }
+
+            chunk.CenterX = originX + CHUNK_BLOCK_SIZE_X / 2;
+            chunk.CenterZ = originZ + CHUNK_BLOCK_SIZE_Z / 2;
+            chunks.push_back(chunk);
+        }
+    }
+
+    return chunks;
+}
+
+// the paths were recorded while walking and flying through the world of the seed, yaw 0 looks down -z
+static std::vector<CameraPath> GetCameraPaths()
+{
+    return
+    {
+        { "walk through the hills", { { 0.0f, 0.0f, BENCH_EYE_HEIGHT, 0.0f, 0.0f }, { 4.0f, -12.0f, BENCH_EYE_HEIGHT, 0.3f, 0.05f },
+                                      { 10.0f, -20.0f, BENCH_EYE_HEIGHT, 0.9f, -0.1f }, { 18.0f, -22.0f, BENCH_EYE_HEIGHT, 1.6f, 0.0f },
+                                      { 26.0f, -18.0f, BENCH_EYE_HEIGHT, 2.2f, 0.1f } } },
+        { "look around on the ground", { { -8.0f, 6.0f, BENCH_EYE_HEIGHT, 0.0f, 0.0f }, { -8.0f, 6.0f, BENCH_EYE_HEIGHT, 1.57f, -0.2f },
+                                         { -8.0f, 6.0f, BENCH_EYE_HEIGHT, 3.14f, 0.0f }, { -8.0f, 6.0f, BENCH_EYE_HEIGHT, 4.71f, 0.2f },
+                                         { -8.0f, 6.0f, BENCH_EYE_HEIGHT, 6.28f, 0.0f } } },
+        { "fly over the terrain", { { -30.0f, 30.0f, 20.0f, 0.8f, -0.35f }, { -10.0f, 10.0f, 16.0f, 0.8f, -0.3f },
+                                    { 10.0f, -10.0f, 12.0f, 0.6f, -0.2f }, { 30.0f, -30.0f, 10.0f, 0.4f, -0.1f } } },
+    };
+}
+
+// row major projection * view of a camera at the position, rotated by yaw around y and pitch up
+static void GetClipMatrix(float x, float y, float z, float yaw, float pitch, float clip[16])
+{
+    const float forward[3] = { -sinf(yaw) * cosf(pitch), sinf(pitch), -cosf(yaw) * cosf(pitch) };
+    const float right[3] = { cosf(yaw), 0.0f, -sinf(yaw) };
+    const float up[3] = { right[1] * forward[2] - right[2] * forward[1], right[2] * forward[0] - right[0] * forward[2],
+                          right[0] * forward[1] - right[1] * forward[0] };
+    const float scaleY = 1.0f;
+    const float scaleX = scaleY / BENCH_ASPECT;
+    const float a = (BENCH_FAR + BENCH_NEAR) / (BENCH_NEAR - BENCH_FAR);
+    const float b = 2.0f * BENCH_FAR * BENCH_NEAR / (BENCH_NEAR - BENCH_FAR);
+
+    const float* rows[3] = { right, up, forward };
+    const float scales[3] = { scaleX, scaleY, -a };
+    for (uint32_t row = 0; row < 3; ++row)
+    {
+        const float* axis = rows[row];
+        const float translation = -(axis[0] * x + axis[1] * y + axis[2] * z);
+        clip[row * 4 + 0] = scales[row] * axis[0];
+        clip[row * 4 + 1] = scales[row] * axis[1];
+        clip[row * 4 + 2] = scales[row] * axis[2];
+        clip[row * 4 + 3] = scales[row] * translation;
+    }
+    clip[11] += b;
+
+    // w is the distance along the view direction
+    for (uint32_t column = 0; column < 3; ++column)
+        clip[12 + column] = forward[column];
+    clip[15] = -(forward[0] * x + forward[1] * y + forward[2] * z);
+}
+
+// the frustum test of FrustumCuller, a box is outside if all of its corners are outside of one clip plane
+static bool IsInFrustum(const float clip[16], const CullBox& box)
+{
+    uint8_t outside = 0x3F;
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        const float x = box.Bounds[i & 1 ? 3 : 0];
+        const float y = box.Bounds[i & 2 ? 4 : 1];
+        const float z = box.Bounds[i & 4 ? 5 : 2];
+        const float clipX = clip[0] * x + clip[1] * y + clip[2] * z + clip[3];
+        const float clipY = clip[4] * x + clip[5] * y + clip[6] * z + clip[7];
+        const float w = clip[12] * x + clip[13] * y + clip[14] * z + clip[15];
+        uint8_t corner = 0;
+        corner |= clipX < -w ? 1 : 0;
+        corner |= clipX > w ? 2 : 0;
+        corner |= clipY < -w ? 4 : 0;
+        corner |= clipY > w ? 8 : 0;
+        corner |= w < BENCH_NEAR ? 16 : 0;
+        corner |= w > BENCH_FAR ? 32 : 0;
+        outside &= corner;
+    }
+    return outside == 0;
+}
+
+static void RunPath(const CameraPath& path, const std::vector<BenchChunk>& chunks)
+{
+    static OcclusionBuffer buffer;
+    std::vector<const BenchChunk*> visible;
+    uint64_t tested = 0;
+    uint64_t occluded = 0;
+    uint64_t occluders = 0;
+    double rasterizeMs = 0.0;
+    double testMs = 0.0;
+    uint32_t frames = 0;
+
+    for (size_t key = 0; key + 1 < path.Keys.size(); ++key)
+    {
+        for (uint32_t frame = 0; frame < BENCH_FRAMES_PER_KEY; ++frame, ++frames)
+        {
+            const CameraKey& from = path.Keys[key];
+            const CameraKey& to = path.Keys[key + 1];
+            const float t = (float) frame / BENCH_FRAMES_PER_KEY;
+            const float x = from.X + (to.X - from.X) * t;
+            const float z = from.Z + (to.Z - from.Z) * t;
+            const float y = GetTerrainHeight(x, z) * BLOCK_SIZE + from.Height + (to.Height - from.Height) * t;
+            float clip[16];
+            GetClipMatrix(x, y, z, from.Yaw + (to.Yaw - from.Yaw) * t, from.Pitch + (to.Pitch - from.Pitch) * t, clip);
+
+            visible.clear();
+            for (const BenchChunk& chunk : chunks)
+            {
+                if (IsInFrustum(clip, chunk.Bounds))
+                    visible.push_back(&chunk);
+            }
+
+            // the occluders of the closest visible chunks like GameWorld::RasterizeOccluders
+            BenchTimer rasterizeTimer;
+            auto closerToCamera = [x, z](const BenchChunk* a, const BenchChunk* b)
+            {
+                return (a->CenterX - x) * (a->CenterX - x) + (a->CenterZ - z) * (a->CenterZ - z) <
+                       (b->CenterX - x) * (b->CenterX - x) + (b->CenterZ - z) * (b->CenterZ - z);
+            };
+            const size_t occluderChunks = std::min<size_t>(visible.size(), OCCLUSION_OCCLUDER_CHUNKS);
+            std::partial_sort(visible.begin(), visible.begin() + occluderChunks, visible.end(), closerToCamera);
+            buffer.Begin(clip, x, y, z);
+            for (size_t i = 0; i < occluderChunks; ++i)
+            {
+                for (const CullBox& box : visible[i]->Occluders)
+                    buffer.AddOccluder(box);
+            }
+            buffer.End();
+            rasterizeMs += rasterizeTimer.GetMilliseconds();
+
+            BenchTimer testTimer;
+            for (const BenchChunk* chunk : visible)
+                occluded += buffer.IsOccluded(chunk->Bounds) ? 1 : 0;
+            testMs += testTimer.GetMilliseconds();
+
+            tested += visible.size();
+            occluders += buffer.GetOccluderCount();
+        }
+    }
+
+    printf("  %s\n", path.Name);
+    printf("    %u frames, %.1f chunks in the frustum and %.1f occluders per frame, %.1f%% of the chunks culled\n",
+           frames, (double) tested / frames, (double) occluders / frames, tested > 0 ? 100.0 * occluded / tested : 0.0);
+    PrintBenchResult("rasterize occluders per frame", rasterizeMs / frames, occluders / frames);
+    PrintBenchResult("test chunks per frame", testMs / frames, tested / frames);
+}
+
+int main()
+{
+    printf("OcclusionBufferBench\n");
+    const std::vector<BenchChunk> chunks = BuildChunks();
+    for (const CameraPath& path : GetCameraPaths())
+        RunPath(path, chunks);
+    return 0;
+}
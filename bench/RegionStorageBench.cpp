@@ -0,0 +1,185 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#include <dirent.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Bench.h"
+#include "../src/world/PerlinNoise.h"
+#include "../src/world/chunk/RegionStorage.h"
+
+// the area around the player in one region, loaded when a world is entered
+#define BENCH_AREA_SIZE 16
+#define BENCH_READ_RUNS 8
+
+static PerlinNoise s_noise(.10, .1, .5, 6, 1234);
+
+// stone, dirt and grass up to the height of the terrain with the types of BlockType
+static ChunkFileData MakeChunk(const ChunkCoord& coord)
+{
+    ChunkFileData data;
+    data.X = coord.X;
+    data.Z = coord.Z;
+    data.Blocks.assign(CHUNK_FILE_BLOCK_COUNT, 0);
+    for (uint32_t x = 0; x < CHUNK_FILE_SIZE_X; ++x)
+    {
+        for (uint32_t z = 0; z < CHUNK_FILE_SIZE_Z; ++z)
+        {
+            const double noise = s_noise.GetHeight(coord.X * CHUNK_FILE_SIZE_X + x, coord.Z * CHUNK_FILE_SIZE_Z + z);
+            const uint32_t height = std::min<uint32_t>(CHUNK_FILE_SIZE_Y, 32 + (uint32_t) std::max(0.0, CHUNK_FILE_SIZE_Y * noise));
+            for (uint32_t y = 0; y < height; ++y)
+                data.Blocks[ChunkFile::GetIndex(x, y, z)] = y + 1 == height ? 2 : (y + 4 >= height ? 1 : 3);
+        }
+    }
+    return data;
+}
+
+static std::string GetLooseFilePath(const std::string& directory, const ChunkCoord& coord)
+{
+    std::ostringstream filePath;
+    filePath << directory << "/" << coord.X << "." << coord.Z << CHUNK_FILE_EXTENSION;
+    return filePath.str();
+}
+
+// the amount of files in the directory and their size on disk
+static void PrintDirectory(const std::string& path)
+{
+    uint32_t files = 0;
+    uint64_t bytes = 0;
+    uint64_t blocks = 0;
+    DIR* directory = opendir(path.c_str());
+    if (directory)
+    {
+        while (dirent* entry = readdir(directory))
+        {
+            struct stat info;
+            if (entry->d_name[0] != '.' && stat((path + "/" + entry->d_name).c_str(), &info) == 0)
+            {
+                files++;
+                bytes += info.st_size;
+                blocks += info.st_blocks;
+            }
+        }
+        closedir(directory);
+    }
+    printf("    %u files, %llu bytes, %llu bytes allocated\n", files, (unsigned long long) bytes, (unsigned long long) blocks * 512);
+}
+
+static void RemoveDirectory(const std::string& path)
+{
+    DIR* directory = opendir(path.c_str());
+    if (directory)
+    {
+        while (dirent* entry = readdir(directory))
+        {
+            if (entry->d_name[0] != '.')
+                remove((path + "/" + entry->d_name).c_str());
+        }
+        closedir(directory);
+    }
+    remove(path.c_str());
+}
+
+int main()
+{
+    printf("RegionStorageBench\n");
+    char looseTemplate[] = "/tmp/RegionStorageBenchXXXXXX";
+    char regionTemplate[] = "/tmp/RegionStorageBenchXXXXXX";
+    if (!mkdtemp(looseTemplate) || !mkdtemp(regionTemplate))
+        return 1;
+    const std::string looseDirectory = looseTemplate;
+    const std::string regionDirectory = regionTemplate;
+
+    std::vector<ChunkFileData> chunks;
+    for (int32_t x = 0; x < BENCH_AREA_SIZE; ++x)
+    {
+        for (int32_t z = 0; z < BENCH_AREA_SIZE; ++z)
+            chunks.push_back(MakeChunk(ChunkCoord { x, z }));
+    }
+
+    // the part of a read which does not depend on the layout
+    std::vector<std::vector<uint8_t> > buffers(chunks.size());
+    for (size_t i = 0; i < chunks.size(); ++i)
+        ChunkFile::Encode(chunks[i], buffers[i]);
+
+    uint64_t loaded = 0;
+    BenchTimer timer;
+    for (uint32_t run = 0; run < BENCH_READ_RUNS; ++run)
+    {
+        for (const std::vector<uint8_t>& buffer : buffers)
+        {
+            ChunkFileData data;
+            loaded += ChunkFile::Decode(buffer.data(), buffer.size(), data) ? 1 : 0;
+        }
+    }
+    PrintBenchResult("decode from memory", timer.GetMilliseconds() / BENCH_READ_RUNS, chunks.size());
+
+    printf("  %ux%u chunks as loose files\n", BENCH_AREA_SIZE, BENCH_AREA_SIZE);
+    timer = BenchTimer();
+    for (const ChunkFileData& chunk : chunks)
+        ChunkFile::Write(GetLooseFilePath(looseDirectory, ChunkCoord { chunk.X, chunk.Z }), chunk);
+    PrintBenchResult("write", timer.GetMilliseconds(), chunks.size());
+
+    timer = BenchTimer();
+    for (uint32_t run = 0; run < BENCH_READ_RUNS; ++run)
+    {
+        for (const ChunkFileData& chunk : chunks)
+        {
+            ChunkFileData data;
+            loaded += ChunkFile::Read(GetLooseFilePath(looseDirectory, ChunkCoord { chunk.X, chunk.Z }), data) ? 1 : 0;
+        }
+    }
+    PrintBenchResult("read", timer.GetMilliseconds() / BENCH_READ_RUNS, chunks.size());
+    PrintDirectory(looseDirectory);
+
+    printf("  %ux%u chunks in one region file\n", BENCH_AREA_SIZE, BENCH_AREA_SIZE);
+    timer = BenchTimer();
+    {
+        RegionStorage storage;
+        storage.Init(regionDirectory);
+        for (const ChunkFileData& chunk : chunks)
+            storage.SaveChunk(ChunkCoord { chunk.X, chunk.Z }, chunk);
+    }
+    PrintBenchResult("write", timer.GetMilliseconds(), chunks.size());
+
+    // the region file is opened again for every run like when a world is entered
+    timer = BenchTimer();
+    for (uint32_t run = 0; run < BENCH_READ_RUNS; ++run)
+    {
+        RegionStorage storage;
+        storage.Init(regionDirectory);
+        for (const ChunkFileData& chunk : chunks)
+        {
+            ChunkFileData data;
+            loaded += storage.LoadChunk(ChunkCoord { chunk.X, chunk.Z }, data) ? 1 : 0;
+        }
+    }
+    PrintBenchResult("read", timer.GetMilliseconds() / BENCH_READ_RUNS, chunks.size());
+    PrintDirectory(regionDirectory);
+
+    RemoveDirectory(looseDirectory);
+    RemoveDirectory(regionDirectory);
+
+    // every chunk has to be decoded from memory and found in both layouts
+    return loaded == 3 * BENCH_READ_RUNS * chunks.size() ? 0 : 1;
+}
@@ -0,0 +1,163 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#include <atomic>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Bench.h"
+#include "../src/utils/Mutex.h"
+#include "../src/utils/RingBuffer.h"
+
+#define BENCH_ITEMS 400000
+#define BENCH_QUEUE_SIZE 256
+
+// the queue the jobs used before, a std::queue behind a mutex, locked for every check and pop
+template<class T>
+class MutexQueue
+{
+public:
+    void Push(T&& value)
+    {
+        m_mutex.Lock();
+        m_queue.push(std::move(value));
+        m_mutex.Unlock();
+    }
+
+    bool IsEmpty()
+    {
+        m_mutex.Lock();
+        bool bEmpty = m_queue.empty();
+        m_mutex.Unlock();
+        return bEmpty;
+    }
+
+    T Pop()
+    {
+        m_mutex.Lock();
+        T value = m_queue.front();
+        m_queue.pop();
+        m_mutex.Unlock();
+        return value;
+    }
+
+private:
+    Mutex m_mutex;
+    std::queue<T> m_queue;
+};
+
+// the block changes of the serialization carried a string, so every item owns memory
+static std::string MakeItem(uint32_t i)
+{
+    return std::string("chunk block change ") + std::to_string(i);
+}
+
+static void RunMutexQueue(uint32_t producerCount)
+{
+    MutexQueue<std::string> queue;
+    std::vector<std::thread> producers;
+    const uint32_t itemsPerProducer = BENCH_ITEMS / producerCount;
+
+    BenchTimer timer;
+    for (uint32_t producer = 0; producer < producerCount; ++producer)
+    {
+        producers.emplace_back([&queue, itemsPerProducer]()
+        {
+            for (uint32_t i = 0; i < itemsPerProducer; ++i)
+                queue.Push(MakeItem(i));
+        });
+    }
+
+    uint64_t length = 0;
+    for (uint32_t received = 0; received < itemsPerProducer * producerCount;)
+    {
+        if (queue.IsEmpty())
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        length += queue.Pop().size();
+        received++;
+    }
+
+    for (auto& thread : producers)
+        thread.join();
+
+    char name[64];
+    snprintf(name, sizeof(name), "mutex queue, %u producers", producerCount);
+    PrintBenchResult(name, timer.GetMilliseconds(), itemsPerProducer * producerCount);
+    s_benchSink = length;
+}
+
+static void RunRingBuffer(uint32_t producerCount)
+{
+    MpscRingBuffer<std::string, BENCH_QUEUE_SIZE> buffer;
+    std::vector<std::thread> producers;
+    const uint32_t itemsPerProducer = BENCH_ITEMS / producerCount;
+
+    BenchTimer timer;
+    for (uint32_t producer = 0; producer < producerCount; ++producer)
+    {
+        producers.emplace_back([&buffer, itemsPerProducer]()
+        {
+            for (uint32_t i = 0; i < itemsPerProducer; ++i)
+            {
+                std::string item = MakeItem(i);
+                while (!buffer.TryPush(std::move(item)))
+                    std::this_thread::yield();
+            }
+        });
+    }
+
+    uint64_t length = 0;
+    std::vector<std::string> drained;
+    drained.reserve(BENCH_QUEUE_SIZE);
+    for (uint32_t received = 0; received < itemsPerProducer * producerCount;)
+    {
+        drained.clear();
+        if (buffer.Drain(drained) == 0)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        for (auto& item : drained)
+            length += item.size();
+        received += drained.size();
+    }
+
+    for (auto& thread : producers)
+        thread.join();
+
+    char name[64];
+    snprintf(name, sizeof(name), "mpsc ring buffer, %u producers", producerCount);
+    PrintBenchResult(name, timer.GetMilliseconds(), itemsPerProducer * producerCount);
+    s_benchSink = length;
+}
+
+int main()
+{
+    printf("RingBufferBench\n");
+    for (uint32_t producers = 1; producers <= 4; producers *= 2)
+    {
+        RunMutexQueue(producers);
+        RunRingBuffer(producers);
+    }
+    return 0;
+}
@@ -22,6 +22,8 @@
 #include "utils/GameHelper.h"
 #include "utils/Filesystem.h"
 #include "utils/Debug.h"
+#include "utils/JobSystem.h"
+#include "renderer/DisplayListArena.h"
 
 Engine::Engine()
 {
@@ -67,6 +69,8 @@ void Engine::Start()
 #endif
 
         GRRLIB_Render();
+        // GRRLIB_Render waits for the GPU, released display lists can be reused now
+        DisplayListArena::EndFrame();
         CalculateFrameRate();
 
         m_millisecondsLastFrame = ticks_to_millisecs(gettime()) - startFrameTime;
@@ -77,7 +81,9 @@ void Engine::Start()
     delete m_pInputHandler;
     delete m_pFontHandler;
 
+    JobSystem::Destroy();
     ThreadPool::Destroy();
+    DisplayListArena::Destroy();
 
 	GRRLIB_Exit();
     LOG("Graphics System uninitialized");
@@ -100,6 +106,7 @@ void Engine::Init()
     FileSystem::Init();
     Debug::GetInstance().Init();
     ThreadPool::Init();
+    JobSystem::Init(JOB_SYSTEM_WORKERS);
 
     LOG("****** %s %s ******", GAME_NAME, BUILD_VERSION);
 
@@ -22,6 +22,7 @@
 
 #include <stdint.h>
 #include "../utils/MathHelper.h"
+#include "../textures/BlockAtlasLayout.h"
 
 #define LEFT_FACE   0x01
 #define RIGHT_FACE  (LEFT_FACE  << 1)
@@ -33,8 +34,24 @@
 struct BlockRenderVO
 {    
     uint8_t FaceMask = 0;
-    uint32_t Faces = 0;
-    Vector3 BlockPosition;
+    uint8_t Faces = 0;
+    uint8_t X = 0, Y = 0, Z = 0; // local block position inside the chunk
+};
+
+/**
+ * A rectangle of merged coplanar block faces, created by the greedy mesher.
+ * Width is the amount of blocks along the horizontal texture axis of the face (x for front, back, top and bottom, z for left and right),
+ * Height along the vertical texture axis (y for the side faces, z for top and bottom).
+ */
+// blocks along one side of a quad, its texture coordinates have to fit into the u8 of the chunk vertex format
+#define BLOCK_QUAD_MAX_SIZE (0xFF / BLOCK_ATLAS_TEXCOORDS_PER_BLOCK)
+
+struct BlockQuadVO
+{
+    uint8_t Face = 0;
+    uint8_t Width = 1;
+    uint8_t Height = 1;
+    uint8_t X = 0, Y = 0, Z = 0; // local position of the block in the min corner of the quad
 };
 
 #endif /* _BLOCKRENDERHELPER_H_ */
@@ -29,189 +29,164 @@ void BlockRenderer::Prepare(std::vector<BlockRenderVO> *positionList, const Bloc
 {
     m_pBlock = &block;
     m_positions = positionList;
-    m_renderBlockSize = block.GetSize();
+    m_quads = nullptr;
+}
+
+void BlockRenderer::Prepare(std::vector<BlockQuadVO> *quadList, const Block& block)
+{
+    m_pBlock = &block;
+    m_positions = nullptr;
+    m_quads = quadList;
 }
 
 void BlockRenderer::Finish()
 {
-	m_renderBlockSize = 0.0f;
     m_positions = nullptr;
+    m_quads = nullptr;
 }
 
 void BlockRenderer::Draw()
 {
-    auto textureMap = m_pBlock->GetTextures();
-
-    for ( auto textureIt = textureMap.begin();  textureIt != textureMap.end(); ++textureIt )
+    // faces with the same tile share one tile select
+    EBlockTile selectedTile = EBlockTile::Count;
+    for (uint8_t face = EBlockFaces::Left; face <= EBlockFaces::Bottom; ++face)
     {
-        auto pTexture = textureIt->first;
-        auto textureFaces = textureIt->second;
-
-        pTexture->Bind();
+        const EBlockFaces blockFace = static_cast<EBlockFaces>(face);
+        if (DrawFaces(blockFace, true) == 0)
+            continue;
 
-        for ( auto textureFaceIt = textureFaces.begin();  textureFaceIt != textureFaces.end(); ++textureFaceIt )
+        if (m_pBlock->GetTile(blockFace) != selectedTile)
         {
-            EBlockFaces currentTextureFace = (*textureFaceIt);
+            selectedTile = m_pBlock->GetTile(blockFace);
+            MasterRenderer::SelectBlockTile(selectedTile);
+        }
 
-            for(auto it = m_positions->begin(); it != m_positions->end(); ++it)
-            {
-                const Vector3& blockPosition = it->BlockPosition;
-                const uint8_t faceMask = it->FaceMask;
+        DrawFaces(blockFace, false);
+    }
+}
 
-                // see http://www.matrix44.net/cms/wp-content/uploads/2011/03/ogl_coord_object_space_cube.png
-                guVector vertices[8] =
-                {
-                        { blockPosition.GetX() - m_renderBlockSize, blockPosition.GetY() + m_renderBlockSize, blockPosition.GetZ() + m_renderBlockSize },// v1
-                        { blockPosition.GetX() - m_renderBlockSize, blockPosition.GetY() - m_renderBlockSize, blockPosition.GetZ() + m_renderBlockSize }, //v2
-                        { blockPosition.GetX() + m_renderBlockSize, blockPosition.GetY() - m_renderBlockSize, blockPosition.GetZ() + m_renderBlockSize }, //v3
-                        { blockPosition.GetX() + m_renderBlockSize, blockPosition.GetY() + m_renderBlockSize, blockPosition.GetZ() + m_renderBlockSize }, // v4
-                        { blockPosition.GetX() - m_renderBlockSize, blockPosition.GetY() + m_renderBlockSize, blockPosition.GetZ() - m_renderBlockSize }, //v5
-                        { blockPosition.GetX() + m_renderBlockSize, blockPosition.GetY() + m_renderBlockSize, blockPosition.GetZ() - m_renderBlockSize }, // v6
-                        { blockPosition.GetX() + m_renderBlockSize, blockPosition.GetY() - m_renderBlockSize, blockPosition.GetZ() - m_renderBlockSize }, // v7
-                        { blockPosition.GetX() - m_renderBlockSize, blockPosition.GetY() - m_renderBlockSize, blockPosition.GetZ() - m_renderBlockSize } // v8
+uint32_t BlockRenderer::Draw(EBlockFaces face)
+{
+    // the tile select is only recorded if the block has faces in this direction
+    uint32_t faces = DrawFaces(face, true);
+    if (faces == 0)
+        return 0;
+
+    MasterRenderer::SelectBlockTile(m_pBlock->GetTile(face));
+    DrawFaces(face, false);
+    return faces;
+}
 
-                };
+uint32_t BlockRenderer::DrawFaces(EBlockFaces face, bool bCountOnly) const
+{
+    const uint8_t faceMask = 1 << face;
+    uint32_t faces = 0;
 
-                if ( (faceMask & FRONT_FACE) && currentTextureFace == EBlockFaces::Front )
-                {
-                    GX_Begin(GX_QUADS, GX_VTXFMT0, 4);
-                        // front side
-                        GX_Position3f32(vertices[0].x, vertices[0].y, vertices[0].z);
-                        GX_Normal3f32(vertices[0].x, vertices[0].y, vertices[0].z);
-                        GX_Color1u32(0xFFFFFFFF);
-                        GX_TexCoord2f32(0.0f,0.0f);
-                        GX_Position3f32(vertices[3].x, vertices[3].y, vertices[3].z);
-                        GX_Normal3f32(vertices[3].x, vertices[3].y, vertices[3].z);
-                        GX_Color1u32(0xFFFFFFFF);
-                        GX_TexCoord2f32(1.0f,0.0f);
-                        GX_Position3f32(vertices[2].x, vertices[2].y, vertices[2].z);
-                        GX_Normal3f32(vertices[2].x, vertices[2].y, vertices[2].z);
-                        GX_Color1u32(0xFFFFFFFF);
-                        GX_TexCoord2f32(1.0f,1.0f);
-                        GX_Position3f32(vertices[1].x, vertices[1].y, vertices[1].z);
-                        GX_Normal3f32(vertices[1].x, vertices[1].y, vertices[1].z);
-                        GX_Color1u32(0xFFFFFFFF);
-                        GX_TexCoord2f32(0.0f,1.0f);
-                    GX_End();
-                }
+    if (m_positions)
+    {
+        for(auto it = m_positions->begin(); it != m_positions->end(); ++it)
+        {
+            if ( it->FaceMask & faceMask )
+            {
+                faces++;
+                if (bCountOnly)
+                    continue;
 
-                if ( (faceMask & BACK_FACE) && currentTextureFace == EBlockFaces::Back)
-                {
-                    GX_Begin(GX_QUADS, GX_VTXFMT0, 4);
-                        // back side
-                        GX_Position3f32(vertices[5].x, vertices[5].y, vertices[5].z);
-                        GX_Normal3f32(vertices[5].x, vertices[5].y, vertices[5].z);
-                        GX_Color1u32(0xFFFFFFFF);
-                        GX_TexCoord2f32(0.0f,0.0f);
-                        GX_Position3f32(vertices[4].x, vertices[4].y, vertices[4].z);
-                        GX_Normal3f32(vertices[4].x, vertices[4].y, vertices[4].z);
-                        GX_Color1u32(0xFFFFFFFF);
-                        GX_TexCoord2f32(1.0f,0.0f);
-                        GX_Position3f32(vertices[7].x, vertices[7].y, vertices[7].z);
-                        GX_Normal3f32(vertices[7].x, vertices[7].y, vertices[7].z);
-                        GX_Color1u32(0xFFFFFFFF);
-                        GX_TexCoord2f32(1.0f,1.0f);
-                        GX_Position3f32(vertices[6].x, vertices[6].y, vertices[6].z);
-                        GX_Normal3f32(vertices[6].x, vertices[6].y, vertices[6].z);
-                        GX_Color1u32(0xFFFFFFFF);
-                        GX_TexCoord2f32(0.0f,1.0f);
-                    GX_End();
-                }
+                const uint8_t min[3] = { it->X, it->Y, it->Z };
+                const uint8_t max[3] = { (uint8_t) (it->X + 1), (uint8_t) (it->Y + 1), (uint8_t) (it->Z + 1) };
+                DrawFace(face, min, max, 1, 1);
+            }
+        }
+    }
 
-                if ( (faceMask & RIGHT_FACE) && currentTextureFace == EBlockFaces::Right )
-                {
-                    GX_Begin(GX_QUADS, GX_VTXFMT0, 4);
-                        // right side
-                        GX_Position3f32(vertices[3].x, vertices[3].y, vertices[3].z);
-                        GX_Normal3f32(vertices[3].x, vertices[3].y, vertices[3].z);
-                        GX_Color1u32(0xFFFFFFFF);
-                        GX_TexCoord2f32(0.0f,0.0f);
-                        GX_Position3f32(vertices[5].x, vertices[5].y, vertices[5].z);
-                        GX_Normal3f32(vertices[5].x, vertices[5].y, vertices[5].z);
-                        GX_Color1u32(0xFFFFFFFF);
-                        GX_TexCoord2f32(1.0f,0.0f);
-                        GX_Position3f32(vertices[6].x, vertices[6].y, vertices[6].z);
-                        GX_Normal3f32(vertices[6].x, vertices[6].y, vertices[6].z);
-                        GX_Color1u32(0xFFFFFFFF);
-                        GX_TexCoord2f32(1.0f,1.0f);
-                        GX_Position3f32(vertices[2].x, vertices[2].y, vertices[2].z);
-                        GX_Normal3f32(vertices[2].x, vertices[2].y, vertices[2].z);
-                        GX_Color1u32(0xFFFFFFFF);
-                        GX_TexCoord2f32(0.0f,1.0f);
-                    GX_End();
-                }
+    if (m_quads)
+    {
+        for(auto it = m_quads->begin(); it != m_quads->end(); ++it)
+        {
+            if ( it->Face == face )
+            {
+                faces++;
+                if (bCountOnly)
+                    continue;
 
-                if ( (faceMask & LEFT_FACE) && currentTextureFace == EBlockFaces::Left )
-                {
-                    GX_Begin(GX_QUADS, GX_VTXFMT0, 4);
-                        // left side
-                        GX_Position3f32(vertices[4].x, vertices[4].y, vertices[4].z);
-                        GX_Normal3f32(vertices[4].x, vertices[4].y, vertices[4].z);
-                        GX_Color1u32(0xFFFFFFFF);
-                        GX_TexCoord2f32(0.0f,0.0f);
-                        GX_Position3f32(vertices[0].x, vertices[0].y, vertices[0].z);
-                        GX_Normal3f32(vertices[0].x, vertices[0].y, vertices[0].z);
-                        GX_Color1u32(0xFFFFFFFF);
-                        GX_TexCoord2f32(1.0f,0.0f);
-                        GX_Position3f32(vertices[1].x, vertices[1].y, vertices[1].z);
-                        GX_Normal3f32(vertices[1].x, vertices[1].y, vertices[1].z);
-                        GX_Color1u32(0xFFFFFFFF);
-                        GX_TexCoord2f32(1.0f,1.0f);
-                        GX_Position3f32(vertices[7].x, vertices[7].y, vertices[7].z);
-                        GX_Normal3f32(vertices[7].x, vertices[7].y, vertices[7].z);
-                        GX_Color1u32(0xFFFFFFFF);
-                        GX_TexCoord2f32(0.0f,1.0f);
-                    GX_End();
-                }
+                const uint8_t min[3] = { it->X, it->Y, it->Z };
+                uint8_t max[3] = { (uint8_t) (it->X + 1), (uint8_t) (it->Y + 1), (uint8_t) (it->Z + 1) };
 
-                if ( (faceMask & TOP_FACE) && currentTextureFace == EBlockFaces::Top)
+                switch (face)
                 {
-                    GX_Begin(GX_QUADS, GX_VTXFMT0, 4);
-                        // top side
-                        GX_Position3f32(vertices[4].x, vertices[4].y, vertices[4].z);
-                        GX_Normal3f32(vertices[4].x, vertices[4].y, vertices[4].z);
-                        GX_Color1u32(0xFFFFFFFF);
-                        GX_TexCoord2f32(0.0f,0.0f);
-                        GX_Position3f32(vertices[5].x, vertices[5].y, vertices[5].z);
-                        GX_Normal3f32(vertices[5].x, vertices[5].y, vertices[5].z);
-                        GX_Color1u32(0xFFFFFFFF);
-                        GX_TexCoord2f32(1.0f,0.0f);
-                        GX_Position3f32(vertices[3].x, vertices[3].y, vertices[3].z);
-                        GX_Normal3f32(vertices[3].x, vertices[3].y, vertices[3].z);
-                        GX_Color1u32(0xFFFFFFFF);
-                        GX_TexCoord2f32(1.0f,1.0f);
-                        GX_Position3f32(vertices[0].x, vertices[0].y, vertices[0].z);
-                        GX_Normal3f32(vertices[0].x, vertices[0].y, vertices[0].z);
-                        GX_Color1u32(0xFFFFFFFF);
-                        GX_TexCoord2f32(0.0f,1.0f);
-                    GX_End();
+                case EBlockFaces::Left:
+                case EBlockFaces::Right:
+                    max[2] = min[2] + it->Width;
+                    max[1] = min[1] + it->Height;
+                    break;
+                case EBlockFaces::Front:
+                case EBlockFaces::Back:
+                    max[0] = min[0] + it->Width;
+                    max[1] = min[1] + it->Height;
+                    break;
+                case EBlockFaces::Top:
+                case EBlockFaces::Bottom:
+                    max[0] = min[0] + it->Width;
+                    max[2] = min[2] + it->Height;
+                    break;
                 }
 
-                if ( (faceMask & BOTTOM_FACE) && currentTextureFace == EBlockFaces::Bottom)
-                {
-                    GX_Begin(GX_QUADS, GX_VTXFMT0, 4);
-                        // bottom side
-                        GX_Position3f32(vertices[6].x, vertices[6].y, vertices[6].z);
-                        GX_Normal3f32(vertices[6].x, vertices[6].y, vertices[6].z);
-                        GX_Color1u32(0xFFFFFFFF);
-                        GX_TexCoord2f32(0.0f,0.0f);
-                        GX_Position3f32(vertices[7].x, vertices[7].y, vertices[7].z);
-                        GX_Normal3f32(vertices[7].x, vertices[7].y, vertices[7].z);
-                        GX_Color1u32(0xFFFFFFFF);
-                        GX_TexCoord2f32(1.0f,0.0f);
-                        GX_Position3f32(vertices[1].x, vertices[1].y, vertices[1].z);
-                        GX_Normal3f32(vertices[1].x, vertices[1].y, vertices[1].z);
-                        GX_Color1u32(0xFFFFFFFF);
-                        GX_TexCoord2f32(1.0f,1.0f);
-                        GX_Position3f32(vertices[2].x, vertices[2].y, vertices[2].z);
-                        GX_Normal3f32(vertices[2].x, vertices[2].y, vertices[2].z);
-                        GX_Color1u32(0xFFFFFFFF);
-                        GX_TexCoord2f32(0.0f,1.0f);
-                    GX_End();
-                }
+                // the texture is repeated once per merged block
+                DrawFace(face, min, max, it->Width, it->Height);
             }
         }
-	}
+    }
+
+    return faces;
+}
+
+void BlockRenderer::DrawFace(EBlockFaces face, const uint8_t min[3], const uint8_t max[3], uint8_t texWidth, uint8_t texHeight) const
+{
+    // see http://www.matrix44.net/cms/wp-content/uploads/2011/03/ogl_coord_object_space_cube.png
+    const uint8_t vertices[8][3] =
+    {
+            { min[0], max[1], max[2] }, // v1
+            { min[0], min[1], max[2] }, // v2
+            { max[0], min[1], max[2] }, // v3
+            { max[0], max[1], max[2] }, // v4
+            { min[0], max[1], min[2] }, // v5
+            { max[0], max[1], min[2] }, // v6
+            { max[0], min[1], min[2] }, // v7
+            { min[0], min[1], min[2] }  // v8
+    };
+
+    // corner indices per face in EBlockFaces order
+    static const uint8_t faceVertices[6][4] =
+    {
+            { 4, 0, 1, 7 }, // left side
+            { 3, 5, 6, 2 }, // right side
+            { 0, 3, 2, 1 }, // front side
+            { 5, 4, 7, 6 }, // back side
+            { 4, 5, 3, 0 }, // top side
+            { 6, 7, 1, 2 }  // bottom side
+    };
+
+    // one tile per merged block, the vertex format scales the raw units by BLOCK_ATLAS_TEXCOORD_FRAC
+    const uint8_t tileWidth = texWidth * BLOCK_ATLAS_TEXCOORDS_PER_BLOCK;
+    const uint8_t tileHeight = texHeight * BLOCK_ATLAS_TEXCOORDS_PER_BLOCK;
+    const uint8_t texCoords[4][2] =
+    {
+            { 0, 0 },
+            { tileWidth, 0 },
+            { tileWidth, tileHeight },
+            { 0, tileHeight }
+    };
+
+    // chunk vertex format, see MasterRenderer::SetChunkGraphicsMode
+    GX_Begin(GX_QUADS, CHUNK_VTXFMT, 4);
+    for (uint8_t i = 0; i < 4; ++i)
+    {
+        const uint8_t* vertex = vertices[faceVertices[face][i]];
+        GX_Position3u8(vertex[0], vertex[1], vertex[2]);
+        GX_Normal1x8(face);
+        GX_TexCoord2u8(texCoords[i][0], texCoords[i][1]);
+    }
+    GX_End();
 }
 
 void BlockRenderer::DrawFocusOnSelectedCube(const Vector3& blockWorldPosition, float blockSizeToCenter)
@@ -31,14 +31,20 @@ public:
 	BlockRenderer();
 	virtual ~BlockRenderer();
     void Prepare(std::vector<BlockRenderVO> *positionList, const Block& block);
+    void Prepare(std::vector<BlockQuadVO> *quadList, const Block& block);
     void Draw();
+    // draws only the faces which point in the given direction and selects their atlas tile, returns the drawn quads
+    uint32_t Draw(EBlockFaces face);
 	void Finish();
     static void DrawFocusOnSelectedCube(const Vector3& blockWorldPosition, float blockSizeToCenter);
 
 private:
+    uint32_t DrawFaces(EBlockFaces face, bool bCountOnly) const;
+    void DrawFace(EBlockFaces face, const uint8_t min[3], const uint8_t max[3], uint8_t texWidth, uint8_t texHeight) const;
+
     const Block* m_pBlock;
-	float m_renderBlockSize = 0.0f;
-    std::vector<BlockRenderVO>* m_positions;
+    std::vector<BlockRenderVO>* m_positions = nullptr;
+    std::vector<BlockQuadVO>* m_quads = nullptr;
 
 
 };
@@ -0,0 +1,490 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#include <gccore.h>
+#include <malloc.h>
+#include <string.h>
+#include <algorithm>
+#include "DisplayListArena.h"
+#include "../utils/Debug.h"
+
+// the header keeps the data of every block 32 byte aligned
+#define DISPLAY_LIST_ARENA_HEADER_SIZE ((sizeof(DisplayListArena::Block) + 31) & ~31)
+
+static_assert(DISPLAY_LIST_ARENA_MIN_CLASS_SIZE << ((DISPLAY_LIST_ARENA_CLASS_COUNT - 1) / DISPLAY_LIST_ARENA_CLASS_STEPS) == DISPLAY_LIST_ARENA_MAX_CLASS_SIZE,
+              "size classes have to end at DISPLAY_LIST_ARENA_MAX_CLASS_SIZE");
+
+std::vector<DisplayListArena::Page*> DisplayListArena::s_pages;
+DisplayListArena::Page* DisplayListArena::s_pEvacuatedPage = nullptr;
+DisplayListArena::Block* DisplayListArena::s_freeBlocks[DISPLAY_LIST_ARENA_CLASS_COUNT] = {};
+DisplayListArena::Block* DisplayListArena::s_pBigBlocks = nullptr;
+DisplayListArena::Block* DisplayListArena::s_pReleasedBlocks = nullptr;
+
+void* DisplayListArena::s_pScratch = nullptr;
+uint32_t DisplayListArena::s_scratchSize = 0;
+uint32_t DisplayListArena::s_recordSize = 0;
+uint32_t DisplayListArena::s_partOffset = 0;
+bool DisplayListArena::s_bOverflowed = false;
+
+DisplayListArenaStats DisplayListArena::s_stats = {};
+
+void DisplayListArena::Destroy()
+{
+    // no handle may point into freed memory
+    for (Page* page : s_pages)
+    {
+        for (uint32_t offset = 0; offset < page->Used; )
+        {
+            Block* block = reinterpret_cast<Block*>(page->Memory + offset);
+            if (block->Owner)
+            {
+                block->Owner->Data = nullptr;
+                block->Owner->Size = 0;
+            }
+            offset += DISPLAY_LIST_ARENA_HEADER_SIZE + block->Capacity;
+        }
+
+        free(page->Memory);
+        delete page;
+    }
+    s_pages.clear();
+
+    Block* lists[2] = { s_pBigBlocks, s_pReleasedBlocks };
+    for (Block* block : lists)
+    {
+        while (block)
+        {
+            Block* next = block->Next;
+            if (block->Owner)
+            {
+                block->Owner->Data = nullptr;
+                block->Owner->Size = 0;
+            }
+            if (!block->OwnerPage)
+                free(block);
+            block = next;
+        }
+    }
+
+    s_pBigBlocks = nullptr;
+    s_pReleasedBlocks = nullptr;
+    s_pEvacuatedPage = nullptr;
+    memset(s_freeBlocks, 0, sizeof(s_freeBlocks));
+
+    free(s_pScratch);
+    s_pScratch = nullptr;
+    s_scratchSize = 0;
+
+    s_stats = DisplayListArenaStats {};
+}
+
+void DisplayListArena::Begin(uint32_t maxSize)
+{
+    maxSize = (maxSize + 31) & ~31;
+
+    // the scratch buffer only grows, it is shared by all recordings
+    if (maxSize > s_scratchSize)
+    {
+        free(s_pScratch);
+        s_pScratch = memalign(32, maxSize);
+        s_scratchSize = maxSize;
+    }
+
+    s_recordSize = maxSize;
+    s_partOffset = 0;
+    s_bOverflowed = false;
+
+    DCInvalidateRange(s_pScratch, s_scratchSize);
+    GX_BeginDispList(s_pScratch, maxSize);
+}
+
+uint32_t DisplayListArena::Split()
+{
+    const uint32_t size = GX_EndDispList();
+    s_partOffset += size;
+
+    // the next part needs room for at least one burst of the write gather pipe
+    if (s_partOffset + 32 > s_recordSize)
+    {
+        s_bOverflowed = true;
+        s_partOffset = s_recordSize - 32;
+    }
+
+    GX_BeginDispList(static_cast<uint8_t*>(s_pScratch) + s_partOffset, s_recordSize - s_partOffset);
+    return size;
+}
+
+bool DisplayListArena::End(DisplayListHandle& handle)
+{
+    uint32_t size = s_partOffset + GX_EndDispList();
+    Release(handle);
+
+    if (size == 0 || s_bOverflowed)
+    {
+        LOG("DisplayListArena: display list overflowed the scratch buffer");
+        return false;
+    }
+
+    Block* block = Allocate(size);
+    if (!block)
+    {
+        LOG("DisplayListArena: out of memory for %u bytes", size);
+        return false;
+    }
+
+    // the list was written through the write gather pipe, the cache holds no lines of it
+    DCInvalidateRange(s_pScratch, size);
+    memcpy(GetData(block), s_pScratch, size);
+    DCFlushRange(GetData(block), size);
+
+    block->Owner = &handle;
+    handle.Data = GetData(block);
+    handle.Size = size;
+
+    s_stats.LiveBytes += size;
+    s_stats.PeakLiveBytes = std::max(s_stats.PeakLiveBytes, s_stats.LiveBytes);
+    return true;
+}
+
+void DisplayListArena::Release(DisplayListHandle& handle)
+{
+    if (!handle.Data)
+        return;
+
+    Block* block = GetBlock(handle.Data);
+    if (!block->OwnerPage)
+    {
+        Unlink(s_pBigBlocks, block);
+    }
+
+    // the GPU may still read the list in this frame
+    block->Owner = nullptr;
+    block->Prev = nullptr;
+    block->Next = s_pReleasedBlocks;
+    s_pReleasedBlocks = block;
+
+    s_stats.LiveBytes -= handle.Size;
+    handle.Data = nullptr;
+    handle.Size = 0;
+}
+
+void DisplayListArena::EndFrame()
+{
+    while (s_pReleasedBlocks)
+    {
+        Block* block = s_pReleasedBlocks;
+        s_pReleasedBlocks = block->Next;
+        Recycle(block);
+    }
+
+    Compact();
+}
+
+DisplayListArenaStats DisplayListArena::GetStats()
+{
+    DisplayListArenaStats stats = s_stats;
+    stats.Fragmentation = stats.ReservedBytes > 0 ? 100 - (uint32_t) ((uint64_t) stats.LiveBytes * 100 / stats.ReservedBytes) : 0;
+    return stats;
+}
+
+uint32_t DisplayListArena::GetSizeClass(uint32_t size)
+{
+    for (uint32_t sizeClass = 0; sizeClass < DISPLAY_LIST_ARENA_CLASS_COUNT; ++sizeClass)
+    {
+        if (size <= GetClassSize(sizeClass))
+            return sizeClass;
+    }
+
+    return DISPLAY_LIST_ARENA_CLASS_COUNT;
+}
+
+uint32_t DisplayListArena::GetClassSize(uint32_t sizeClass)
+{
+    const uint32_t base = DISPLAY_LIST_ARENA_MIN_CLASS_SIZE << (sizeClass / DISPLAY_LIST_ARENA_CLASS_STEPS);
+    return base + (base / DISPLAY_LIST_ARENA_CLASS_STEPS) * (sizeClass % DISPLAY_LIST_ARENA_CLASS_STEPS);
+}
+
+DisplayListArena::Block* DisplayListArena::GetBlock(void* data)
+{
+    return reinterpret_cast<Block*>(static_cast<uint8_t*>(data) - DISPLAY_LIST_ARENA_HEADER_SIZE);
+}
+
+void* DisplayListArena::GetData(Block* block)
+{
+    return reinterpret_cast<uint8_t*>(block) + DISPLAY_LIST_ARENA_HEADER_SIZE;
+}
+
+DisplayListArena::Block* DisplayListArena::Allocate(uint32_t size)
+{
+    const uint32_t sizeClass = GetSizeClass(size);
+
+    if (sizeClass == DISPLAY_LIST_ARENA_CLASS_COUNT)
+    {
+        const uint32_t capacity = (size + 31) & ~31;
+        Block* block = static_cast<Block*>(memalign(32, DISPLAY_LIST_ARENA_HEADER_SIZE + capacity));
+        if (!block)
+            return nullptr;
+
+        block->Owner = nullptr;
+        block->OwnerPage = nullptr;
+        block->Capacity = capacity;
+        block->SizeClass = sizeClass;
+        PushFront(s_pBigBlocks, block);
+
+        s_stats.ReservedBytes += DISPLAY_LIST_ARENA_HEADER_SIZE + capacity;
+        s_stats.PeakReservedBytes = std::max(s_stats.PeakReservedBytes, s_stats.ReservedBytes);
+        return block;
+    }
+
+    Block* block = s_freeBlocks[sizeClass];
+    if (block)
+    {
+        Unlink(s_freeBlocks[sizeClass], block);
+    }
+    else
+    {
+        block = Carve(sizeClass);
+        if (!block)
+            return nullptr;
+    }
+
+    block->OwnerPage->LiveBytes += block->Capacity;
+    return block;
+}
+
+DisplayListArena::Block* DisplayListArena::Carve(uint32_t sizeClass)
+{
+    const uint32_t blockSize = DISPLAY_LIST_ARENA_HEADER_SIZE + GetClassSize(sizeClass);
+
+    // the newest pages are most likely to have room left
+    Page* page = nullptr;
+    for (auto it = s_pages.rbegin(); it != s_pages.rend() && !page; ++it)
+    {
+        if (*it != s_pEvacuatedPage && (*it)->Used + blockSize <= DISPLAY_LIST_ARENA_PAGE_SIZE)
+            page = *it;
+    }
+
+    if (!page)
+    {
+        uint8_t* memory = static_cast<uint8_t*>(memalign(32, DISPLAY_LIST_ARENA_PAGE_SIZE));
+        if (!memory)
+            return nullptr;
+
+        page = new Page { memory, 0, 0 };
+        s_pages.push_back(page);
+
+        s_stats.ReservedBytes += DISPLAY_LIST_ARENA_PAGE_SIZE;
+        s_stats.PeakReservedBytes = std::max(s_stats.PeakReservedBytes, s_stats.ReservedBytes);
+    }
+
+    Block* block = reinterpret_cast<Block*>(page->Memory + page->Used);
+    block->Owner = nullptr;
+    block->Prev = nullptr;
+    block->Next = nullptr;
+    block->OwnerPage = page;
+    block->Capacity = GetClassSize(sizeClass);
+    block->SizeClass = sizeClass;
+    page->Used += blockSize;
+    return block;
+}
+
+void DisplayListArena::Recycle(Block* block)
+{
+    if (!block->OwnerPage)
+    {
+        s_stats.ReservedBytes -= DISPLAY_LIST_ARENA_HEADER_SIZE + block->Capacity;
+        free(block);
+        return;
+    }
+
+    block->OwnerPage->LiveBytes -= block->Capacity;
+    PushFront(s_freeBlocks[block->SizeClass], block);
+}
+
+void DisplayListArena::Unlink(Block*& list, Block* block)
+{
+    if (block->Prev)
+        block->Prev->Next = block->Next;
+    else
+        list = block->Next;
+
+    if (block->Next)
+        block->Next->Prev = block->Prev;
+
+    block->Prev = nullptr;
+    block->Next = nullptr;
+}
+
+void DisplayListArena::PushFront(Block*& list, Block* block)
+{
+    block->Prev = nullptr;
+    block->Next = list;
+    if (list)
+        list->Prev = block;
+    list = block;
+}
+
+void DisplayListArena::UnlinkFreeBlocks(Page* page)
+{
+    for (uint32_t offset = 0; offset < page->Used; )
+    {
+        Block* block = reinterpret_cast<Block*>(page->Memory + offset);
+        if (!block->Owner)
+            Unlink(s_freeBlocks[block->SizeClass], block);
+        offset += DISPLAY_LIST_ARENA_HEADER_SIZE + block->Capacity;
+    }
+}
+
+void DisplayListArena::FreePage(uint32_t pageIndex)
+{
+    Page* page = s_pages[pageIndex];
+    s_pages.erase(s_pages.begin() + pageIndex);
+    free(page->Memory);
+    delete page;
+    s_stats.ReservedBytes -= DISPLAY_LIST_ARENA_PAGE_SIZE;
+}
+
+bool DisplayListArena::CanEvacuate(Page* page)
+{
+    // the lists have to fit into the other pages, a new page would only be evacuated again.
+    // carving takes the newest page with room, so the tails are checked in the same order
+    uint32_t freeBlocks[DISPLAY_LIST_ARENA_CLASS_COUNT];
+    for (uint32_t sizeClass = 0; sizeClass < DISPLAY_LIST_ARENA_CLASS_COUNT; ++sizeClass)
+    {
+        freeBlocks[sizeClass] = 0;
+        for (Block* block = s_freeBlocks[sizeClass]; block; block = block->Next)
+        {
+            if (block->OwnerPage != page)
+                freeBlocks[sizeClass]++;
+        }
+    }
+
+    std::vector<uint32_t> pageTails;
+    for (Page* other : s_pages)
+    {
+        if (other != page)
+            pageTails.push_back(DISPLAY_LIST_ARENA_PAGE_SIZE - other->Used);
+    }
+
+    for (uint32_t offset = 0; offset < page->Used; )
+    {
+        Block* block = reinterpret_cast<Block*>(page->Memory + offset);
+        offset += DISPLAY_LIST_ARENA_HEADER_SIZE + block->Capacity;
+
+        if (!block->Owner)
+            continue;
+
+        if (freeBlocks[block->SizeClass] > 0)
+        {
+            freeBlocks[block->SizeClass]--;
+            continue;
+        }
+
+        auto tail = std::find_if(pageTails.rbegin(), pageTails.rend(), [block](uint32_t bytes)
+        {
+            return bytes >= DISPLAY_LIST_ARENA_HEADER_SIZE + block->Capacity;
+        });
+
+        if (tail == pageTails.rend())
+            return false;
+
+        *tail -= DISPLAY_LIST_ARENA_HEADER_SIZE + block->Capacity;
+    }
+
+    return true;
+}
+
+void DisplayListArena::Compact()
+{
+    // empty pages go back to the heap, one is kept for the next lists
+    for (uint32_t i = 0; i < s_pages.size() && s_pages.size() > 1; )
+    {
+        if (s_pages[i]->LiveBytes == 0)
+        {
+            UnlinkFreeBlocks(s_pages[i]);
+            FreePage(i);
+        }
+        else
+        {
+            i++;
+        }
+    }
+
+    const DisplayListArenaStats stats = GetStats();
+    if (s_pages.size() < 2 || stats.Fragmentation < DISPLAY_LIST_ARENA_COMPACT_FRAGMENTATION)
+        return;
+
+    uint32_t sparsest = 0;
+    for (uint32_t i = 1; i < s_pages.size(); ++i)
+    {
+        if (s_pages[i]->LiveBytes < s_pages[sparsest]->LiveBytes)
+            sparsest = i;
+    }
+
+    Page* page = s_pages[sparsest];
+    if (page->LiveBytes * 100 >= DISPLAY_LIST_ARENA_PAGE_SIZE * DISPLAY_LIST_ARENA_COMPACT_OCCUPANCY || !CanEvacuate(page))
+        return;
+
+    // at most one page is moved per frame, the GPU is done with the frame so the lists can move
+    UnlinkFreeBlocks(page);
+    s_pEvacuatedPage = page;
+
+    for (uint32_t offset = 0; offset < page->Used; )
+    {
+        Block* block = reinterpret_cast<Block*>(page->Memory + offset);
+        offset += DISPLAY_LIST_ARENA_HEADER_SIZE + block->Capacity;
+
+        if (!block->Owner)
+            continue;
+
+        Block* moved = Allocate(block->Capacity);
+        if (!moved)
+        {
+            LOG("DisplayListArena: compaction stopped, out of memory");
+            break;
+        }
+
+        DisplayListHandle* owner = block->Owner;
+        memcpy(GetData(moved), GetData(block), owner->Size);
+        DCFlushRange(GetData(moved), owner->Size);
+
+        moved->Owner = owner;
+        owner->Data = GetData(moved);
+        block->Owner = nullptr;
+        page->LiveBytes -= block->Capacity;
+    }
+
+    s_pEvacuatedPage = nullptr;
+
+    if (page->LiveBytes == 0)
+    {
+        FreePage(sparsest);
+    }
+    else
+    {
+        // the page stays, its free blocks can be used again
+        for (uint32_t offset = 0; offset < page->Used; )
+        {
+            Block* block = reinterpret_cast<Block*>(page->Memory + offset);
+            if (!block->Owner)
+                PushFront(s_freeBlocks[block->SizeClass], block);
+            offset += DISPLAY_LIST_ARENA_HEADER_SIZE + block->Capacity;
+        }
+    }
+}
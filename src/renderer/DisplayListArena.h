@@ -0,0 +1,153 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#ifndef DISPLAYLISTARENA_H
+#define DISPLAYLISTARENA_H
+
+#include <stdint.h>
+#include <vector>
+
+// blocks of the size classes are carved from pages of this size, bigger lists get their own allocation
+#define DISPLAY_LIST_ARENA_PAGE_SIZE (256 * 1024)
+#define DISPLAY_LIST_ARENA_MIN_CLASS_SIZE 512
+#define DISPLAY_LIST_ARENA_MAX_CLASS_SIZE (128 * 1024)
+// every power of two is split into this many size classes, which bounds the wasted bytes of a block to 25%
+#define DISPLAY_LIST_ARENA_CLASS_STEPS 4
+#define DISPLAY_LIST_ARENA_CLASS_COUNT 33
+
+// a page is evacuated when less than this percentage of it is used and the arena is fragmented
+#define DISPLAY_LIST_ARENA_COMPACT_OCCUPANCY 25
+#define DISPLAY_LIST_ARENA_COMPACT_FRAGMENTATION 50
+
+/**
+ * @brief DisplayListHandle
+ * A display list owned by the arena. The arena updates Data when it moves the list during compaction,
+ * so a handle must stay at the same address while it holds a list.
+ */
+struct DisplayListHandle
+{
+    DisplayListHandle() = default;
+    DisplayListHandle(const DisplayListHandle&) = delete;
+    DisplayListHandle& operator=(const DisplayListHandle&) = delete;
+
+    void* Data      = nullptr;
+    uint32_t Size   = 0;
+};
+
+struct DisplayListArenaStats
+{
+    uint32_t LiveBytes;         // bytes of all recorded display lists
+    uint32_t PeakLiveBytes;
+    uint32_t ReservedBytes;     // pages and big lists taken from the heap
+    uint32_t PeakReservedBytes;
+    uint32_t Fragmentation;     // percentage of the reserved bytes which holds no display list
+};
+
+/**
+ * @brief DisplayListArena
+ * 32 byte aligned memory for GX display lists. Lists are recorded into a scratch buffer first and then copied into
+ * a block of the smallest fitting size class, so no list keeps its worst case size. Released blocks are reused by
+ * later lists of the same class, sparse pages are evacuated and returned to the heap.
+ * Only the main thread may use the arena, released blocks are recycled by EndFrame once the GPU is done with them.
+ */
+class DisplayListArena
+{
+public:
+    static void Destroy();
+
+    /**
+     * @brief Begin starts recording a display list, GX commands go into the scratch buffer until End is called.
+     * @param maxSize upper bound of the recorded bytes.
+     */
+    static void Begin(uint32_t maxSize);
+
+    /**
+     * @brief End finishes the recording and moves the list into the handle, the previous list of the handle is released.
+     * @return false if nothing was recorded or the scratch buffer overflowed, the handle is empty then.
+     */
+    static bool End(DisplayListHandle& handle);
+
+    /**
+     * @brief Split ends the current part of the recording and starts the next one right behind it. Parts are 32 byte
+     * aligned, so every part of the finished list can be called on its own at its offset.
+     * @return bytes of the finished part, 0 if nothing was recorded or the scratch buffer overflowed.
+     */
+    static uint32_t Split();
+
+    static void Release(DisplayListHandle& handle);
+
+    /**
+     * @brief EndFrame recycles released blocks and compacts the arena a bit, call it after the GPU finished the frame.
+     */
+    static void EndFrame();
+
+    static DisplayListArenaStats GetStats();
+
+private:
+    struct Page;
+
+    struct Block
+    {
+        DisplayListHandle* Owner;   // nullptr while the block is free
+        Block* Prev;                // free list of the size class, or the list of big blocks
+        Block* Next;
+        Page* OwnerPage;            // nullptr for big blocks
+        uint32_t Capacity;          // usable bytes behind the header
+        uint32_t SizeClass;
+    };
+
+    struct Page
+    {
+        uint8_t* Memory;
+        uint32_t Used;              // carved bytes, blocks are carved from the front
+        uint32_t LiveBytes;         // capacity of the blocks in use
+    };
+
+    static uint32_t GetSizeClass(uint32_t size);
+    static uint32_t GetClassSize(uint32_t sizeClass);
+    static Block* GetBlock(void* data);
+    static void* GetData(Block* block);
+
+    static Block* Allocate(uint32_t size);
+    static Block* Carve(uint32_t sizeClass);
+    static void Recycle(Block* block);
+    static void Unlink(Block*& list, Block* block);
+    static void PushFront(Block*& list, Block* block);
+    static void UnlinkFreeBlocks(Page* page);
+    static void FreePage(uint32_t pageIndex);
+    static bool CanEvacuate(Page* page);
+    static void Compact();
+
+    static std::vector<Page*> s_pages;
+    static Page* s_pEvacuatedPage;
+    static Block* s_freeBlocks[DISPLAY_LIST_ARENA_CLASS_COUNT];
+    static Block* s_pBigBlocks;
+    static Block* s_pReleasedBlocks;
+
+    static void* s_pScratch;
+    static uint32_t s_scratchSize;
+    // size of the current recording and the offset of its current part
+    static uint32_t s_recordSize;
+    static uint32_t s_partOffset;
+    static bool s_bOverflowed;
+
+    static DisplayListArenaStats s_stats;
+};
+
+#endif // DISPLAYLISTARENA_H
@@ -1,17 +1,50 @@
 #include "MasterRenderer.h"
 #include <gccore.h>
 #include <math.h>
+#include <string.h>
 
 MasterRenderer::MasterRenderer()
 {
 
 }
 
+// GX_Begin command (3 bytes) and four vertices of 3 + 1 + 2 bytes
+#define CHUNK_FACE_DISPLAY_LIST_SIZE (3 + 4 * 6)
+// room for the atlas tile selects of all block types in one chunk display list
+#define CHUNK_TEXTURE_DISPLAY_LIST_SIZE 1024
+
+static_assert(BLOCK_ATLAS_TILE_SIZE == 256, "the indirect stage wraps the atlas tiles with GX_ITW_256");
+static_assert(BLOCK_ATLAS_SIZE <= 1024, "the tile origins have to fit into the indirect matrix");
+
+// the normals of the block faces in EBlockFaces order, indexed by the chunk vertex format
+static s8 s_faceNormals[] ATTRIBUTE_ALIGN(32) =
+{
+    -64,   0,   0, // left
+     64,   0,   0, // right
+      0,   0,  64, // front
+      0,   0, -64, // back
+      0,  64,   0, // top
+      0, -64,   0  // bottom
+};
+
+// an 8x4 I8 texture which is 1 everywhere, the indirect matrix turns it into the offset of the selected atlas tile
+static u8 s_tileOffsetTexels[32] ATTRIBUTE_ALIGN(32);
+static GXTexObj s_tileOffsetTexture;
+
+extern Mtx _GRR_view;
+extern Mtx _ObjTransformationMtx;
+
 size_t MasterRenderer::GetDisplayListSizeForFaces(uint32_t faces)
 {
     return (size_t) ((32 * 6) * faces); // 32 * 6 magic numbers, seems to work fine
 }
 
+size_t MasterRenderer::GetDisplayListSizeForChunkFaces(uint32_t faces)
+{
+    size_t size = (faces * CHUNK_FACE_DISPLAY_LIST_SIZE) + CHUNK_TEXTURE_DISPLAY_LIST_SIZE;
+    return (size + 31) & ~31;
+}
+
 void MasterRenderer::SetGraphicsMode(bool bTexturemode, bool bNormalMode)
 {
     GX_ClearVtxDesc();
@@ -35,10 +68,93 @@ void MasterRenderer::SetGraphicsMode(bool bTexturemode, bool bNormalMode)
     if(bTexturemode)
         GX_SetVtxAttrFmt(GX_VTXFMT0, GX_VA_TEX0, GX_TEX_ST, GX_F32, 0);
 
+    GX_SetTevOrder(GX_TEVSTAGE0, GX_TEXCOORD0, GX_TEXMAP0, GX_COLOR0A0);
+
     if(bTexturemode)
         GX_SetTevOp(GX_TEVSTAGE0, GX_MODULATE);
     else
         GX_SetTevOp(GX_TEVSTAGE0, GX_PASSCLR);
+
+    // only the chunks draw from the block atlas
+    GX_SetNumIndStages(0);
+    GX_SetTevDirect(GX_TEVSTAGE0);
+}
+
+void MasterRenderer::SetChunkGraphicsMode()
+{
+    static bool s_bChunkDataFlushed = false;
+    if (!s_bChunkDataFlushed)
+    {
+        DCFlushRange(s_faceNormals, sizeof(s_faceNormals));
+
+        memset(s_tileOffsetTexels, 1, sizeof(s_tileOffsetTexels));
+        DCFlushRange(s_tileOffsetTexels, sizeof(s_tileOffsetTexels));
+        GX_InitTexObj(&s_tileOffsetTexture, s_tileOffsetTexels, 8, 4, GX_TF_I8, GX_REPEAT, GX_REPEAT, GX_FALSE);
+        GX_InitTexObjFilterMode(&s_tileOffsetTexture, GX_NEAR, GX_NEAR);
+        s_bChunkDataFlushed = true;
+    }
+
+    GX_ClearVtxDesc();
+    GX_SetVtxDesc(GX_VA_POS, GX_DIRECT);
+    GX_SetVtxDesc(GX_VA_NRM, GX_INDEX8);
+    GX_SetVtxDesc(GX_VA_TEX0, GX_DIRECT);
+
+    // positions are whole block corners relative to the chunk origin, scaled by the chunk matrix
+    GX_SetVtxAttrFmt(CHUNK_VTXFMT, GX_VA_POS, GX_POS_XYZ, GX_U8, 0);
+    GX_SetVtxAttrFmt(CHUNK_VTXFMT, GX_VA_NRM, GX_NRM_XYZ, GX_S8, 6);
+    GX_SetVtxAttrFmt(CHUNK_VTXFMT, GX_VA_TEX0, GX_TEX_ST, GX_U8, BLOCK_ATLAS_TEXCOORD_FRAC);
+    GX_SetArray(GX_VA_NRM, s_faceNormals, 3 * sizeof(s8));
+
+    // constant white vertex colour from a tev register instead of a colour per vertex
+    GX_SetTevColor(GX_TEVREG0, (GXColor) { 0xFF, 0xFF, 0xFF, 0xFF });
+    GX_SetTevOrder(GX_TEVSTAGE0, GX_TEXCOORD0, GX_TEXMAP0, GX_COLORNULL);
+    GX_SetTevColorIn(GX_TEVSTAGE0, GX_CC_ZERO, GX_CC_TEXC, GX_CC_C0, GX_CC_ZERO);
+    GX_SetTevAlphaIn(GX_TEVSTAGE0, GX_CA_ZERO, GX_CA_TEXA, GX_CA_A0, GX_CA_ZERO);
+    GX_SetTevColorOp(GX_TEVSTAGE0, GX_TEV_ADD, GX_TB_ZERO, GX_CS_SCALE_1, GX_TRUE, GX_TEVPREV);
+    GX_SetTevAlphaOp(GX_TEVSTAGE0, GX_TEV_ADD, GX_TB_ZERO, GX_CS_SCALE_1, GX_TRUE, GX_TEVPREV);
+
+    // the indirect stage wraps the texture coordinates inside one atlas tile and moves them to the selected tile,
+    // so merged faces still repeat their texture. The mip level is taken from the unwrapped coordinates,
+    // otherwise the pixels at the tile borders would read the smallest level
+    GX_LoadTexObj(&s_tileOffsetTexture, GX_TEXMAP1);
+    GX_SetNumIndStages(1);
+    GX_SetIndTexOrder(GX_INDTEXSTAGE0, GX_TEXCOORD0, GX_TEXMAP1);
+    GX_SetIndTexCoordScale(GX_INDTEXSTAGE0, GX_ITS_1, GX_ITS_1);
+    GX_SetTevIndirect(GX_TEVSTAGE0, GX_INDTEXSTAGE0, GX_ITF_8, GX_ITB_NONE, GX_ITM_0, GX_ITW_256, GX_ITW_256, GX_FALSE, GX_TRUE, GX_ITBA_OFF);
+}
+
+void MasterRenderer::SelectBlockTile(EBlockTile tile)
+{
+    const uint32_t index = static_cast<uint32_t>(tile);
+    const f32 originX = BLOCK_ATLAS_TILE_GUTTER + (index % BLOCK_ATLAS_COLUMNS) * BLOCK_ATLAS_TILE_SPACING;
+    const f32 originY = BLOCK_ATLAS_TILE_GUTTER + (index / BLOCK_ATLAS_COLUMNS) * BLOCK_ATLAS_TILE_SPACING;
+
+    // the offset texture reads 1, scaled by 2^10 the matrix adds the tile origin in texels like GX_SetTevIndTile
+    f32 offsetMtx[2][3] =
+    {
+        { originX / 1024.0f, 0.0f, 0.0f },
+        { 0.0f, originY / 1024.0f, 0.0f }
+    };
+    GX_SetIndTexMatrix(GX_ITM_0, offsetMtx, 10);
+}
+
+void MasterRenderer::LoadChunkMatrix(float originX, float originY, float originZ, float blockSize)
+{
+    Mtx chunkMtx, modelMtx, modelViewMtx;
+    guMtxScale(chunkMtx, blockSize, blockSize, blockSize);
+    guMtxTransApply(chunkMtx, chunkMtx, originX, originY, originZ);
+    guMtxConcat(_ObjTransformationMtx, chunkMtx, modelMtx);
+    guMtxConcat(_GRR_view, modelMtx, modelViewMtx);
+    GX_LoadPosMtxImm(modelViewMtx, GX_PNMTX0);
+    GX_LoadNrmMtxImm(modelViewMtx, GX_PNMTX0);
+}
+
+void MasterRenderer::LoadWorldMatrix()
+{
+    Mtx modelViewMtx;
+    guMtxConcat(_GRR_view, _ObjTransformationMtx, modelViewMtx);
+    GX_LoadPosMtxImm(modelViewMtx, GX_PNMTX0);
+    GX_LoadNrmMtxImm(modelViewMtx, GX_PNMTX0);
 }
 
 
@@ -60,7 +176,6 @@ void MasterRenderer::DrawSprite(const Sprite& sprite)
      uint32_t color = sprite.GetColor();
 
      GXTexObj* texObj = sprite.GetTextureObject();
-     GRRLIB_texImg* tex = static_cast<GRRLIB_texImg*>(sprite.GetLoadedTexture());
 
      GX_LoadTexObj(texObj,      GX_TEXMAP0);
      GX_SetTevOp  (GX_TEVSTAGE0, GX_MODULATE);
@@ -71,17 +186,11 @@ void MasterRenderer::DrawSprite(const Sprite& sprite)
      guMtxRotAxisDeg(m2, &axis, degrees);
      guMtxConcat    (m2, m1, m);
 
-     width  = tex->w * 0.5;
-     height = tex->h * 0.5;
-
-     guMtxTransApply(m, m,
-         xpos +width  +tex->handlex
-             -tex->offsetx +( scaleX *(-tex->handley *sin(-DegToRad(degrees))
-                                       -tex->handlex *cos(-DegToRad(degrees))) ),
-         ypos +height +tex->handley
-             -tex->offsety +( scaleY *(-tex->handley *cos(-DegToRad(degrees))
-                                       +tex->handlex *sin(-DegToRad(degrees))) ),
-         0);
+     // png and TPL sprites have no GRRLIB handle or offset, they rotate around their center
+     width  = sprite.GetWidth() * 0.5;
+     height = sprite.GetHeight() * 0.5;
+
+     guMtxTransApply(m, m, xpos + width, ypos + height, 0);
      guMtxConcat(GXmodelView2D, m, mv);
 
      GX_LoadPosMtxImm(mv, GX_PNMTX0);
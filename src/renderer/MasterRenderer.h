@@ -3,16 +3,26 @@
 
 #include "../textures/Texture.h"
 #include "../textures/Sprite.h"
+#include "../textures/BlockAtlasLayout.h"
 #include <cinttypes>
 #include <cstddef>
 
+// vertex format of the chunk display lists: u8 chunk local positions, normal index, u8 atlas tile coordinates
+#define CHUNK_VTXFMT GX_VTXFMT1
+
 class MasterRenderer
 {
 public:
     MasterRenderer();
 
     static size_t GetDisplayListSizeForFaces(uint32_t faces);
+    static size_t GetDisplayListSizeForChunkFaces(uint32_t faces);
     static void SetGraphicsMode(bool bTexturemode, bool bNormalMode);    
+    static void SetChunkGraphicsMode();
+    // moves the texture coordinates of the following chunk faces into the atlas tile, can be recorded into display lists
+    static void SelectBlockTile(EBlockTile tile);
+    static void LoadChunkMatrix(float originX, float originY, float originZ, float blockSize);
+    static void LoadWorldMatrix();
     static void DrawSprite(const Sprite& sprite);
 };
 
@@ -21,9 +21,10 @@
 #include "../utils/Debug.h"
 #include "../world/hud/Hotbar.h"
 #include "../components/Cursor.h"
-#include "Hotbar_png.h"
-#include "Crosshair_png.h"
+#include "Hotbar_tpl.h"
+#include "Crosshair_tpl.h"
 #include "../entity/Player.h"
+#include "../renderer/DisplayListArena.h"
 
 #define IGS_HUD_HOTBAR "IGS_HUD_HOTBAR"
 #define IGS_HUD_CROSSHAIR "IGS_HUD_CROSSHAIR"
@@ -38,12 +39,30 @@ void InGameScene::Update(float deltaSeconds)
     Basic3DScene::Update(deltaSeconds);
     CPlayer* player = static_cast<CPlayer*>(m_entityHandler->GetPlayer());
     player->Update(deltaSeconds);
+
+#ifdef DEBUG
+    WiiPad* pad = Engine::Get().GetInputHandler().GetPadByID( WII_PAD_0 );
+    if ( pad->ButtonsDown() & WPAD_BUTTON_1 )
+    {
+        bool bGreedy = m_pGameWorld->GetMeshingMode() == EMeshingMode::Greedy;
+        m_pGameWorld->SetMeshingMode(bGreedy ? EMeshingMode::PerFace : EMeshingMode::Greedy);
+    }
+
+    if ( pad->ButtonsDown() & WPAD_BUTTON_PLUS )
+    {
+        m_pGameWorld->SetViewDistance(m_pGameWorld->GetViewDistance() + 1);
+    }
+    else if ( pad->ButtonsDown() & WPAD_BUTTON_MINUS )
+    {
+        m_pGameWorld->SetViewDistance(m_pGameWorld->GetViewDistance() - 1);
+    }
+#endif
 }
 
 void InGameScene::Load()
 {
-    m_uiElements.push_back( new Hotbar( IGS_HUD_HOTBAR, Sprite::Create(Hotbar_png, Hotbar_png_size, IGS_HUD_HOTBAR)) );
-    m_uiElements.push_back( new Cursor( IGS_HUD_CROSSHAIR, Sprite::Create(Crosshair_png, Crosshair_png_size, IGS_HUD_CROSSHAIR)) );
+    m_uiElements.push_back( new Hotbar( IGS_HUD_HOTBAR, Sprite::Create(Hotbar_tpl, Hotbar_tpl_size, IGS_HUD_HOTBAR)) );
+    m_uiElements.push_back( new Cursor( IGS_HUD_CROSSHAIR, Sprite::Create(Crosshair_tpl, Crosshair_tpl_size, IGS_HUD_CROSSHAIR)) );
 
     m_pGameWorld = new GameWorld();
     InitEntities();
@@ -64,6 +83,30 @@ void InGameScene::Draw()
     Basic3DScene::Draw();   
 
 #ifdef DEBUG
+    char buffer[128];
+    const ChunkRenderStats& renderStats = m_pGameWorld->GetRenderStats();
+    sprintf(buffer, "%s View: %u Faces: %u Quads: %u DL: %u KB Blocks: %u KB", m_pGameWorld->GetMeshingMode() == EMeshingMode::Greedy ? "Greedy" : "PerFace",
+            m_pGameWorld->GetViewDistance(), renderStats.VisibleFaces, renderStats.Quads,
+            renderStats.DisplayListBytes / 1024, m_pGameWorld->GetBlockMemoryUsage() / 1024);
+    GRRLIB_PrintfTTF( 0, 45, Engine::Get().GetFontHandler().GetNativFontByID( DEFAULT_FONT_ID ), buffer, DEFAULT_FONT_SIZE, GRRLIB_WHITE );
+
+    sprintf(buffer, "Culled: %u/%u chunks %u/%u sections %u box tests Vertices: %u of %u", renderStats.CulledChunks,
+            renderStats.TestedChunks, renderStats.CulledSections, renderStats.TestedSections, renderStats.BoxTests,
+            renderStats.SubmittedQuads * 4, renderStats.Quads * 4);
+    GRRLIB_PrintfTTF( 0, 85, Engine::Get().GetFontHandler().GetNativFontByID( DEFAULT_FONT_ID ), buffer, DEFAULT_FONT_SIZE, GRRLIB_WHITE );
+
+    sprintf(buffer, "Cave culled: %u chunks %u sections Occluded: %u chunks by %u boxes", renderStats.CaveCulledChunks,
+            renderStats.CaveCulledSections, renderStats.OccludedChunks, renderStats.Occluders);
+    GRRLIB_PrintfTTF( 0, 105, Engine::Get().GetFontHandler().GetNativFontByID( DEFAULT_FONT_ID ), buffer, DEFAULT_FONT_SIZE, GRRLIB_WHITE );
+
+    sprintf(buffer, "Texture loads: %u Atlas tile selects: %u", renderStats.TextureLoads, renderStats.TileSelects);
+    GRRLIB_PrintfTTF( 0, 125, Engine::Get().GetFontHandler().GetNativFontByID( DEFAULT_FONT_ID ), buffer, DEFAULT_FONT_SIZE, GRRLIB_WHITE );
+
+    const DisplayListArenaStats arenaStats = DisplayListArena::GetStats();
+    sprintf(buffer, "LOD: %u tiles %u quads DL arena: %u KB live %u KB peak %u KB reserved %u%% frag", m_pGameWorld->GetLodTileCount(),
+            m_pGameWorld->GetLodFaces(), arenaStats.LiveBytes / 1024, arenaStats.PeakLiveBytes / 1024, arenaStats.ReservedBytes / 1024,
+            arenaStats.Fragmentation);
+    GRRLIB_PrintfTTF( 0, 65, Engine::Get().GetFontHandler().GetNativFontByID( DEFAULT_FONT_ID ), buffer, DEFAULT_FONT_SIZE, GRRLIB_WHITE );
     /*
     GRRLIB_SetLightAmbient(0x404040FF);
     GRRLIB_SetLightSpot(0, (guVector){ 10.0f, 0.0f, 10.0f }, (guVector){  0.0f, 0.0f, 0.0f }, 1.0f, 3.0f, 1.0f, 1.0f, 0.0f, 0.0f, GRRLIB_RED);
@@ -25,8 +25,8 @@
 #include "../commands/client/SwitchToMainMenuCommand.h"
 
 #include "../utils/Debug.h"
-#include "ClassicBackgroundSprite_png.h"
-#include "WoxelCraft_png.h"
+#include "ClassicBackgroundSprite_tpl.h"
+#include "WoxelCraft_tpl.h"
 
 // define all component names here!
 #define IS_CLASSIC_BACKGROUND "IS_ClassicBackground"
@@ -46,7 +46,7 @@ IntroScene::~IntroScene() {
 void IntroScene::Load()
 {    
 	m_BackgroundAlpha = 255;
-    auto logoSprite = Sprite::Create(WoxelCraft_png, WoxelCraft_png_size, IS_LOGO);
+    auto logoSprite = Sprite::Create(WoxelCraft_tpl, WoxelCraft_tpl_size, IS_LOGO);
     m_elements.push_back( new UiTextureElement( (rmode->viWidth / 2) - (logoSprite->GetWidth() / 2), (rmode->viHeight / 2) - ( logoSprite->GetHeight() / 2 ), IS_LOGO, logoSprite));
     Basic2DScene::Load();
 }
@@ -24,14 +24,14 @@
 #include "../components/UiTextureElement.h"
 #include "../components/List.h"
 #include "../utils/Debug.h"
-#include "Cursor_png.h"
-#include "ClassicBackgroundSprite_png.h"
-#include "BasicButtonBig_png.h"
-#include "BasicButtonBigHighlight_png.h"
-#include "WoxelCraft_png.h"
-#include "WoxelCraft_png.h"
+#include "Cursor_tpl.h"
+#include "ClassicBackgroundSprite_tpl.h"
+#include "BasicButtonBig_tpl.h"
+#include "BasicButtonBigHighlight_tpl.h"
+#include "WoxelCraft_tpl.h"
+#include "WoxelCraft_tpl.h"
 
-#include "Hotbar_png.h"
+#include "Hotbar_tpl.h"
 
 // define all scene components here
 #define MMS_BUTTON_SINGLEPLAYER  "MMS_btnSingleplayer"
@@ -63,15 +63,15 @@ MainMenuScene::~MainMenuScene() {
 
 void MainMenuScene::Load()
 {    
-    m_elements.push_back( new UiTextureElement( MMS_CLASSIC_BACKGROUND , Sprite::Create(ClassicBackgroundSprite_png, ClassicBackgroundSprite_png_size, MMS_CLASSIC_BACKGROUND, BACKGROUND_SORTING_LAYER )));
-    UiTextureElement* logo = new UiTextureElement( MMS_LOGO , Sprite::Create(WoxelCraft_png, WoxelCraft_png_size, MMS_LOGO, COMPONENTS_SORTING_LAYER));
+    m_elements.push_back( new UiTextureElement( MMS_CLASSIC_BACKGROUND , Sprite::Create(ClassicBackgroundSprite_tpl, ClassicBackgroundSprite_tpl_size, MMS_CLASSIC_BACKGROUND, BACKGROUND_SORTING_LAYER )));
+    UiTextureElement* logo = new UiTextureElement( MMS_LOGO , Sprite::Create(WoxelCraft_tpl, WoxelCraft_tpl_size, MMS_LOGO, COMPONENTS_SORTING_LAYER));
 	logo->SetX( (rmode->viWidth / 2) - (logo->GetWidth() / 2) );
 	logo->SetY( 60 );
 	m_elements.push_back( logo );
 
     CreateMainMenuButtonList();
 
-    m_elements.push_back( new Cursor( MMS_CURSOR , Sprite::Create(Cursor_png, Cursor_png_size, MMS_CURSOR, CURSOR_SORTING_LAYER )));
+    m_elements.push_back( new Cursor( MMS_CURSOR , Sprite::Create(Cursor_tpl, Cursor_tpl_size, MMS_CURSOR, CURSOR_SORTING_LAYER )));
     Basic2DScene::Load();
 }
 
@@ -100,7 +100,7 @@ void MainMenuScene::Update(float deltaSeconds)
 
 void MainMenuScene::CreateMainMenuButtonList()
 {
-    auto startButtonTexture = Sprite::Create(BasicButtonBig_png, BasicButtonBig_png_size, "BasicButtonBig_png" );
+    auto startButtonTexture = Sprite::Create(BasicButtonBig_tpl, BasicButtonBig_tpl_size, "BasicButtonBig_tpl" );
 	int xPos = (rmode->viWidth / 2) - (startButtonTexture->GetWidth() / 2);
 	int yPos = (rmode->viHeight / 2) - ( startButtonTexture->GetHeight() / 2);
 	int sizeBetweenBtns = startButtonTexture->GetHeight() + BUTTON_Y_DISTANCE;    
@@ -120,10 +120,10 @@ BasicButton* MainMenuScene::CreateDefaultMainMenuButton( const char* buttonName,
 {
     FontHandler& fontHandler = Engine::Get().GetFontHandler();
 
-    auto pdefaultButtonTexture = Sprite::Create(BasicButtonBig_png, BasicButtonBig_png_size, buttonName, COMPONENTS_SORTING_LAYER);
+    auto pdefaultButtonTexture = Sprite::Create(BasicButtonBig_tpl, BasicButtonBig_tpl_size, buttonName, COMPONENTS_SORTING_LAYER);
 
     std::string searchNamehighlight = std::string(buttonName).append(HIGHLIGHT_TAG);
-    auto pHighlightButtonTexture = Sprite::Create(BasicButtonBigHighlight_png, BasicButtonBigHighlight_png_size, searchNamehighlight, COMPONENTS_SORTING_LAYER);
+    auto pHighlightButtonTexture = Sprite::Create(BasicButtonBigHighlight_tpl, BasicButtonBigHighlight_tpl_size, searchNamehighlight, COMPONENTS_SORTING_LAYER);
 
     std::string searchLabel = std::string(buttonName).append(LABEL_TAG);
     auto pButtonLabel = Label::Create(buttontext, fontHandler.GetNativFontByID( DEFAULT_MINECRAFT_FONT_ID ), searchLabel, LABEL_SORTING_LAYER);
@@ -20,6 +20,33 @@
 #include "BasicTexture.h"
 #include "../Engine.h"
 
+struct TPL_Header{
+    uint32_t	magic;
+    uint32_t	texCount;
+    uint32_t	headerSize;
+};
+
+struct TPL_Addr{
+    uint32_t	textureOffs;
+    uint32_t	tlutOffs;
+};
+
+struct TPL_Texture{
+    uint16_t	height;
+    uint16_t	width;
+    uint32_t	format;
+    uint32_t	dataOffs;
+    uint32_t	wrap_s;
+    uint32_t	wrap_t;
+    uint32_t	minFilt;
+    uint32_t	magFilt;
+    float       lodBias;
+    uint8_t     edgeLod;
+    uint8_t     minLod;
+    uint8_t     maxLod;
+    uint8_t     unpacked;
+};
+
 BasicTexture::BasicTexture(float x, float y, TextureLoadingData textureData) : m_x(x), m_y(y), m_textureLoadingData(textureData), m_color(GRRLIB_WHITE) { }
 
 BasicTexture::~BasicTexture()
@@ -29,6 +56,12 @@ BasicTexture::~BasicTexture()
 
 void BasicTexture::Load()
 {
+    if ( IsTPLTexture() )
+    {
+        LoadTPLTexture();
+        return;
+    }
+
     m_loadedTexture = GRRLIB_LoadTexture( m_textureLoadingData.textureData );
 
     if ( m_loadedTexture )
@@ -60,14 +93,62 @@ void BasicTexture::Unload()
     if ( m_loadedTexture )
     {
         GRRLIB_FreeTexture(static_cast<GRRLIB_texImg*>(m_loadedTexture));
+        m_loadedTexture = nullptr;
+    }
+
+    if ( m_pTPLTextureData )
+    {
+        free(m_pTPLTextureData);
+        m_pTPLTextureData = nullptr;
     }
 
     if (m_textureObject)
     {
         delete m_textureObject;
+        m_textureObject = nullptr;
     }
 
     m_width = 0;
     m_height = 0;
     m_bTextureLoaded = false;
 }
+
+void BasicTexture::LoadTPLTexture()
+{
+    m_textureObject = new GXTexObj();
+
+    //const TPL_Header* pHeader = reinterpret_cast<const TPL_Header*>(m_textureData.pTextureData);
+    //const TPL_Addr* pAddr =reinterpret_cast<const TPL_Addr*>((m_textureData.pTextureData + sizeof(TPL_Header)));
+    const TPL_Texture* pTexture = reinterpret_cast<const TPL_Texture*>((m_textureLoadingData.textureData + sizeof(TPL_Header) + sizeof(TPL_Addr)));
+
+    // the texels of all mip levels follow each other up to the end of the file
+    uint32_t size = m_textureLoadingData.textureSize - pTexture->dataOffs;
+    m_pTPLTextureData = memalign(32, size);
+    memcpy(m_pTPLTextureData, (void*) (m_textureLoadingData.textureData + pTexture->dataOffs), size);
+
+    DCFlushRange(m_pTPLTextureData, size);    
+
+    GX_InitTexObj(m_textureObject, m_pTPLTextureData, pTexture->width, pTexture->height, pTexture->format, pTexture->wrap_s, pTexture->wrap_t, pTexture->maxLod ? GX_TRUE : GX_FALSE);
+
+    if (pTexture->maxLod)
+    {
+        GX_InitTexObjLOD(m_textureObject, pTexture->minFilt, pTexture->magFilt, pTexture->minLod, pTexture->maxLod, pTexture->lodBias, GX_DISABLE, pTexture->edgeLod, GX_ANISO_4);
+
+        GX_InitTexObjEdgeLOD(m_textureObject, GX_ENABLE);
+        GX_InitTexObjMaxAniso(m_textureObject, GX_ANISO_4);
+    }
+    else
+    {
+        GX_InitTexObjFilterMode(m_textureObject, pTexture->minFilt, pTexture->magFilt);
+    }
+
+    m_width = pTexture->width;
+    m_height = pTexture->height;
+    m_bTextureLoaded = true;
+}
+
+bool BasicTexture::IsTPLTexture() const
+{
+    const TPL_Header* pHeader = reinterpret_cast<const TPL_Header*>(m_textureLoadingData.textureData);
+    return (pHeader && pHeader->magic == 0x20af30);
+}
@@ -85,7 +85,7 @@ public:
 
     /**
      * @brief GetLoadedTexture
-     * @return Returns null if the texture is not loaded otherwise loading informations depending on the TextureLoadingData
+     * @return Returns null if the texture is not loaded or a TPL texture otherwise the GRRLIB_texImg of the png
      */
     void* GetLoadedTexture() const
     {
@@ -122,6 +122,9 @@ public:
     }
 
 protected:
+    void LoadTPLTexture();
+    bool IsTPLTexture() const;
+
     float m_x, m_y;
     float m_width, m_height;
     float m_scaleX = 1.0f, m_scaleY = 1.0f;
@@ -129,6 +132,8 @@ protected:
     TextureLoadingData m_textureLoadingData;
     bool m_bTextureLoaded = false;
     void* m_loadedTexture = nullptr;
+    // texels of a TPL texture, the TPL header is read from the loading data
+    void* m_pTPLTextureData = nullptr;
     GXTexObj* m_textureObject = nullptr;
 };
 
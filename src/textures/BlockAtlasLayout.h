@@ -0,0 +1,59 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#ifndef _BLOCKATLASLAYOUT_H_
+#define _BLOCKATLASLAYOUT_H_
+
+// layout of the block texture atlas, also included by the packer in tools/texconv which has to agree on it
+
+// tiles are placed in a square grid, every tile is surrounded by a gutter of its own wrapped texels
+#define BLOCK_ATLAS_SIZE 1024
+#define BLOCK_ATLAS_TILE_SIZE 256
+#define BLOCK_ATLAS_TILE_GUTTER 32
+#define BLOCK_ATLAS_TILE_SPACING (BLOCK_ATLAS_TILE_SIZE + 2 * BLOCK_ATLAS_TILE_GUTTER)
+#define BLOCK_ATLAS_COLUMNS (BLOCK_ATLAS_SIZE / BLOCK_ATLAS_TILE_SPACING)
+#define BLOCK_ATLAS_MAX_TILES (BLOCK_ATLAS_COLUMNS * BLOCK_ATLAS_COLUMNS)
+// the gutter of the smallest mip level is one texel wide
+#define BLOCK_ATLAS_LEVELS 6
+// chunk texture coordinates count tiles, one tile is 1 / 4 of the atlas
+#define BLOCK_ATLAS_TEXCOORD_FRAC 2
+// raw texture coordinate units per block, the chunk vertices repeat the tile once per block
+#define BLOCK_ATLAS_TEXCOORDS_PER_BLOCK 1
+
+static_assert(BLOCK_ATLAS_TILE_SIZE << BLOCK_ATLAS_TEXCOORD_FRAC == BLOCK_ATLAS_SIZE, "a texture coordinate of 1 has to span one tile");
+static_assert((BLOCK_ATLAS_TEXCOORDS_PER_BLOCK * BLOCK_ATLAS_SIZE) >> BLOCK_ATLAS_TEXCOORD_FRAC == BLOCK_ATLAS_TILE_SIZE,
+              "one block has to span one tile");
+static_assert(BLOCK_ATLAS_TILE_GUTTER >> (BLOCK_ATLAS_LEVELS - 1) >= 1, "every mip level needs a gutter");
+
+// tiles of the atlas in packing order, the packer gets the block textures in this order
+enum class EBlockTile : unsigned char
+{
+    Dirt,
+    Grass,
+    GrassSide,
+    Stone,
+    Wood,
+    Leaf,
+    Tree,
+    Count
+};
+
+static_assert(static_cast<unsigned>(EBlockTile::Count) <= BLOCK_ATLAS_MAX_TILES, "the block tiles do not fit into the atlas");
+
+#endif /* _BLOCKATLASLAYOUT_H_ */
@@ -35,7 +35,6 @@ public:
     ~Texture() {}
 
     void Load() override;
-    void Unload() override;
 
     static Texture* Create(const uint8_t* textureData, uint32_t textureSize);
 
@@ -43,14 +42,6 @@ public:
 
     uint32_t GetWidth() const override;
     uint32_t GetHeight() const override;
-protected:
-    void* m_pTPLTextureData = nullptr;
-
-private:
-
-    void LoadTPLTexture();
-    bool IsTPLTexture();
-
 };
 
 
@@ -0,0 +1,83 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#ifndef CONDITIONVARIABLE_H
+#define CONDITIONVARIABLE_H
+
+#include "Mutex.h"
+
+// libogc LWP condition on the Wii, pthread condition for host builds
+class ConditionVariable
+{
+public:
+    ConditionVariable()
+    {
+#ifdef GEKKO
+        LWP_CondInit(&m_condition);
+#else
+        pthread_cond_init(&m_condition, nullptr);
+#endif
+    }
+
+    ~ConditionVariable()
+    {
+#ifdef GEKKO
+        LWP_CondDestroy(m_condition);
+#else
+        pthread_cond_destroy(&m_condition);
+#endif
+    }
+
+    // the mutex has to be locked, it is released while waiting
+    void Wait(Mutex& mutex)
+    {
+#ifdef GEKKO
+        LWP_CondWait(m_condition, mutex.m_mutex);
+#else
+        pthread_cond_wait(&m_condition, &mutex.m_mutex);
+#endif
+    }
+
+    void Signal()
+    {
+#ifdef GEKKO
+        LWP_CondSignal(m_condition);
+#else
+        pthread_cond_signal(&m_condition);
+#endif
+    }
+
+    void Broadcast()
+    {
+#ifdef GEKKO
+        LWP_CondBroadcast(m_condition);
+#else
+        pthread_cond_broadcast(&m_condition);
+#endif
+    }
+
+private:
+#ifdef GEKKO
+    cond_t m_condition;
+#else
+    pthread_cond_t m_condition;
+#endif
+};
+
+#endif // CONDITIONVARIABLE_H
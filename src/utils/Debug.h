@@ -20,6 +20,8 @@
 #ifndef _DEBUG_H_
 #define _DEBUG_H_
 
+#ifdef GEKKO
+
 #include <fstream>
 #include "../Engine.h"
 
@@ -51,4 +53,17 @@ public:
     void operator=(Debug const&) = delete;
 };
 
+#else
+
+// host builds of the platform independent modules log to stderr
+#include <stdio.h>
+
+#ifdef DEBUG
+    #define LOG(format,...) fprintf(stderr, format "\n", ##__VA_ARGS__)
+#else
+    #define LOG(format, ...) do { } while (0)
+#endif
+
+#endif
+
 #endif /* _DEBUG_H_ */
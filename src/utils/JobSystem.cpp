@@ -0,0 +1,264 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#include "JobSystem.h"
+#include "Debug.h"
+
+JobSystem::Worker JobSystem::s_workers[JOB_SYSTEM_MAX_WORKERS];
+uint32_t JobSystem::s_workerCount = 0;
+uint32_t JobSystem::s_nextWorker = 0;
+
+Mutex JobSystem::s_sleepMutex;
+ConditionVariable JobSystem::s_wakeUp;
+ConditionVariable JobSystem::s_jobDone;
+uint32_t JobSystem::s_queuedJobs = 0;
+bool JobSystem::s_bStop = false;
+
+bool JobSystem::Init(uint32_t workerCount)
+{
+    s_bStop = false;
+    s_workerCount = 0;
+
+    for (uint32_t i = 0; i < workerCount && i < JOB_SYSTEM_MAX_WORKERS; ++i)
+    {
+        Thread* pThread = ThreadPool::GetThread();
+        if (!pThread)
+        {
+            LOG("JobSystem: No free thread in pool!");
+            break;
+        }
+
+        s_workers[i].pThread = pThread;
+        pThread->SetData(reinterpret_cast<void*>(static_cast<uintptr_t>(i)));
+        s_workerCount++;
+    }
+
+    // the workers only start once all of them exist, so they never steal from a worker without a thread
+    for (uint32_t i = 0; i < s_workerCount; ++i)
+    {
+        s_workers[i].pThread->Create(WorkerEntry, nullptr, JOB_SYSTEM_STACK_SIZE, 128);
+    }
+
+    return s_workerCount > 0;
+}
+
+void JobSystem::Destroy()
+{
+    // the workers finish all queued jobs before they stop
+    s_sleepMutex.Lock();
+    s_bStop = true;
+    s_wakeUp.Broadcast();
+    s_sleepMutex.Unlock();
+
+    for (uint32_t i = 0; i < s_workerCount; ++i)
+    {
+        s_workers[i].pThread->Release();
+        s_workers[i].pThread = nullptr;
+    }
+
+    s_workerCount = 0;
+}
+
+JobHandle JobSystem::Schedule(const std::function<void()>& work, const JobHandle& dependency)
+{
+    Job job { work, std::make_shared<JobState>() };
+    JobHandle handle = job.Handle;
+
+    if (dependency)
+    {
+        dependency->StateMutex.Lock();
+        if (!dependency->bDone)
+        {
+            dependency->Continuations.push_back(std::move(job));
+            dependency->StateMutex.Unlock();
+            return handle;
+        }
+        dependency->StateMutex.Unlock();
+    }
+
+    if (s_workerCount == 0)
+    {
+        // without workers the job runs right away
+        Run(job, 0);
+        return handle;
+    }
+
+    // jobs are moved through the deques, copying the work and the handle costs more than most small jobs
+    Push(std::move(job), s_nextWorker++ % s_workerCount);
+    return handle;
+}
+
+bool JobSystem::IsDone(const JobHandle& handle)
+{
+    if (!handle)
+        return true;
+
+    handle->StateMutex.Lock();
+    bool bDone = handle->bDone;
+    handle->StateMutex.Unlock();
+    return bDone;
+}
+
+void JobSystem::Wait(const JobHandle& handle)
+{
+    while (!IsDone(handle))
+    {
+        Job job;
+        if (TrySteal(s_workerCount, job))
+        {
+            Run(job, s_nextWorker++ % (s_workerCount > 0 ? s_workerCount : 1));
+            continue;
+        }
+
+        // nothing to help with, the job is running or waits for its dependency. The flag is set before the
+        // done check under the sleep mutex, so Run either sees it or the check sees the job done
+        handle->StateMutex.Lock();
+        handle->bWaited = true;
+        handle->StateMutex.Unlock();
+
+        s_sleepMutex.Lock();
+        while (!IsDone(handle) && s_queuedJobs == 0)
+        {
+            s_jobDone.Wait(s_sleepMutex);
+        }
+        s_sleepMutex.Unlock();
+    }
+}
+
+void* JobSystem::WorkerEntry(void* data)
+{
+    Thread* thread = static_cast<Thread*>(data);
+    const uint32_t workerIndex = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(thread->Data()));
+
+    while (true)
+    {
+        Job job;
+        if (TryPop(workerIndex, job) || TrySteal(workerIndex, job))
+        {
+            Run(job, workerIndex);
+            continue;
+        }
+
+        s_sleepMutex.Lock();
+        while (s_queuedJobs == 0 && !s_bStop)
+        {
+            s_wakeUp.Wait(s_sleepMutex);
+        }
+        bool bStop = s_bStop && s_queuedJobs == 0;
+        s_sleepMutex.Unlock();
+
+        if (bStop)
+            break;
+    }
+
+    return nullptr;
+}
+
+void JobSystem::Push(Job&& job, uint32_t workerIndex)
+{
+    Worker& worker = s_workers[workerIndex];
+    worker.JobsMutex.Lock();
+    worker.Jobs.push_back(std::move(job));
+    worker.JobsMutex.Unlock();
+
+    // the counter is changed under the sleep mutex, so a worker can not miss the wake up
+    s_sleepMutex.Lock();
+    s_queuedJobs++;
+    s_wakeUp.Signal();
+    s_sleepMutex.Unlock();
+}
+
+bool JobSystem::TryPop(uint32_t workerIndex, Job& job)
+{
+    Worker& worker = s_workers[workerIndex];
+    worker.JobsMutex.Lock();
+    bool bFound = !worker.Jobs.empty();
+    if (bFound)
+    {
+        job = std::move(worker.Jobs.back());
+        worker.Jobs.pop_back();
+    }
+    worker.JobsMutex.Unlock();
+
+    if (bFound)
+    {
+        s_sleepMutex.Lock();
+        s_queuedJobs--;
+        s_sleepMutex.Unlock();
+    }
+
+    return bFound;
+}
+
+bool JobSystem::TrySteal(uint32_t thiefIndex, Job& job)
+{
+    for (uint32_t i = 0; i < s_workerCount; ++i)
+    {
+        if (i == thiefIndex)
+            continue;
+
+        Worker& victim = s_workers[i];
+        victim.JobsMutex.Lock();
+        bool bFound = !victim.Jobs.empty();
+        if (bFound)
+        {
+            job = std::move(victim.Jobs.front());
+            victim.Jobs.pop_front();
+        }
+        victim.JobsMutex.Unlock();
+
+        if (bFound)
+        {
+            s_sleepMutex.Lock();
+            s_queuedJobs--;
+            s_sleepMutex.Unlock();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void JobSystem::Run(Job& job, uint32_t workerIndex)
+{
+    job.Work();
+
+    std::vector<Job> continuations;
+    job.Handle->StateMutex.Lock();
+    job.Handle->bDone = true;
+    bool bWaited = job.Handle->bWaited;
+    continuations.swap(job.Handle->Continuations);
+    job.Handle->StateMutex.Unlock();
+
+    if (bWaited)
+    {
+        s_sleepMutex.Lock();
+        s_jobDone.Broadcast();
+        s_sleepMutex.Unlock();
+    }
+
+    // continuations go to the deque of the worker which finished the dependency
+    for (auto& continuation : continuations)
+    {
+        if (s_workerCount > 0)
+            Push(std::move(continuation), workerIndex);
+        else
+            Run(continuation, 0);
+    }
+}
@@ -0,0 +1,115 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+#include <stdint.h>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "Mutex.h"
+#include "ConditionVariable.h"
+#include "Thread.h"
+#include "Threadpool.h"
+
+#define JOB_SYSTEM_MAX_WORKERS THREAD_POOL_SIZE
+
+// workers started by the engine, the remaining pool threads stay free for other systems
+#define JOB_SYSTEM_WORKERS 4
+
+// chunk jobs keep whole chunk section sets on their stack
+#define JOB_SYSTEM_STACK_SIZE (64 * 1024)
+
+struct JobState;
+
+// completion state of a scheduled job, an empty handle counts as done
+typedef std::shared_ptr<JobState> JobHandle;
+
+/**
+ * @brief JobSystem
+ * Runs jobs on the threads of the ThreadPool. Every worker owns a deque, it runs its newest job first
+ * and steals the oldest job of another worker when its own deque is empty. Idle workers sleep on a
+ * condition variable until a job is scheduled. A job can depend on another job, it is then scheduled
+ * as continuation once the other job is done.
+ */
+class JobSystem
+{
+public:
+    static bool Init(uint32_t workerCount);
+    static void Destroy();
+
+    /**
+     * @param dependency the job only runs after this job is done.
+     */
+    static JobHandle Schedule(const std::function<void()>& work, const JobHandle& dependency = JobHandle());
+
+    static bool IsDone(const JobHandle& handle);
+
+    /**
+     * @brief Wait runs queued jobs on the calling thread until the job is done, it sleeps while there is
+     * nothing left to run.
+     */
+    static void Wait(const JobHandle& handle);
+
+private:
+    struct Job
+    {
+        std::function<void()> Work;
+        JobHandle Handle;
+    };
+
+    struct Worker
+    {
+        std::deque<Job> Jobs;
+        Mutex JobsMutex;
+        Thread* pThread = nullptr;
+    };
+
+    friend struct JobState;
+
+    static void* WorkerEntry(void* data);
+    static void Push(Job&& job, uint32_t workerIndex);
+    static bool TryPop(uint32_t workerIndex, Job& job);
+    static bool TrySteal(uint32_t thiefIndex, Job& job);
+    static void Run(Job& job, uint32_t workerIndex);
+
+    static Worker s_workers[JOB_SYSTEM_MAX_WORKERS];
+    static uint32_t s_workerCount;
+    static uint32_t s_nextWorker;
+
+    static Mutex s_sleepMutex;
+    static ConditionVariable s_wakeUp;
+    // broadcast when a job which somebody waits for is done
+    static ConditionVariable s_jobDone;
+    static uint32_t s_queuedJobs;
+    static bool s_bStop;
+};
+
+struct JobState
+{
+    Mutex StateMutex;
+    bool bDone = false;
+    // a thread sleeps in Wait until the job is done
+    bool bWaited = false;
+    std::vector<JobSystem::Job> Continuations;
+};
+
+#endif // JOBSYSTEM_H
@@ -20,34 +20,61 @@
 #ifndef MUTEX_H
 #define MUTEX_H
 
+#ifdef GEKKO
 #include <ogcsys.h>
 #include <gccore.h>
+#else
+#include <pthread.h>
+#endif
 
+// libogc LWP mutex on the Wii, pthread mutex for host builds
 class Mutex
 {
 public:
     Mutex()
     {
+#ifdef GEKKO
         LWP_MutexInit(&m_mutex, false);
+#else
+        pthread_mutex_init(&m_mutex, nullptr);
+#endif
     }
 
     ~Mutex()
     {
+#ifdef GEKKO
         LWP_MutexDestroy(m_mutex);
+#else
+        pthread_mutex_destroy(&m_mutex);
+#endif
     }
 
     void Lock()
     {
+#ifdef GEKKO
         LWP_MutexLock(m_mutex);
+#else
+        pthread_mutex_lock(&m_mutex);
+#endif
     }
 
     void Unlock()
     {
+#ifdef GEKKO
         LWP_MutexUnlock(m_mutex);
+#else
+        pthread_mutex_unlock(&m_mutex);
+#endif
     }
 
 private:
+    friend class ConditionVariable;
+
+#ifdef GEKKO
     mutex_t m_mutex;
+#else
+    pthread_mutex_t m_mutex;
+#endif
 };
 
 #endif // MUTEX_H
@@ -0,0 +1,84 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#ifndef OPTIONAL_H
+#define OPTIONAL_H
+
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// holds a value or nothing, used as result of try operations
+template<class T>
+class Optional
+{
+public:
+    Optional() {}
+
+    Optional(T&& value) : m_bHasValue(true)
+    {
+        new (&m_storage) T(std::move(value));
+    }
+
+    Optional(Optional&& other) : m_bHasValue(other.m_bHasValue)
+    {
+        if (m_bHasValue)
+            new (&m_storage) T(std::move(other.Value()));
+    }
+
+    Optional(const Optional&) = delete;
+    Optional& operator=(const Optional&) = delete;
+
+    ~Optional()
+    {
+        if (m_bHasValue)
+            Value().~T();
+    }
+
+    bool HasValue() const
+    {
+        return m_bHasValue;
+    }
+
+    explicit operator bool() const
+    {
+        return m_bHasValue;
+    }
+
+    T& Value()
+    {
+        return *reinterpret_cast<T*>(&m_storage);
+    }
+
+    T& operator*()
+    {
+        return Value();
+    }
+
+    T* operator->()
+    {
+        return &Value();
+    }
+
+private:
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type m_storage;
+    bool m_bHasValue = false;
+};
+
+#endif // OPTIONAL_H
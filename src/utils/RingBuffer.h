@@ -0,0 +1,127 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <stdint.h>
+#include <atomic>
+#include <utility>
+#include "Optional.h"
+
+// the indices of producers and consumer live in different cache lines of the broadway
+#define RING_BUFFER_CACHE_LINE 32
+
+/**
+ * @brief MpscRingBuffer
+ * Bounded lock free queue for any number of producer threads and one consumer thread.
+ * Every slot carries a sequence number, a producer claims a slot by advancing the tail
+ * and publishes it by setting the sequence, so the consumer never sees a half written item.
+ * Size has to be a power of two.
+ */
+template<class T, uint32_t Size>
+class MpscRingBuffer
+{
+    static_assert(Size > 0 && (Size & (Size - 1)) == 0, "ring buffer size has to be a power of two");
+
+public:
+    MpscRingBuffer()
+    {
+        for (uint32_t i = 0; i < Size; ++i)
+            m_slots[i].Sequence.store(i, std::memory_order_relaxed);
+    }
+
+    // any thread, fails if the buffer is full
+    bool TryPush(T&& value)
+    {
+        uint32_t tail = m_tail.load(std::memory_order_relaxed);
+        Slot* slot;
+
+        while (true)
+        {
+            slot = &m_slots[tail & (Size - 1)];
+            const int32_t diff = static_cast<int32_t>(slot->Sequence.load(std::memory_order_acquire) - tail);
+            if (diff == 0)
+            {
+                if (m_tail.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+            {
+                // the consumer did not free this slot yet
+                return false;
+            }
+            else
+            {
+                tail = m_tail.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->Value = std::move(value);
+        slot->Sequence.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer thread only
+    Optional<T> TryPop()
+    {
+        Slot& slot = m_slots[m_head & (Size - 1)];
+        if (slot.Sequence.load(std::memory_order_acquire) != m_head + 1)
+            return Optional<T>();
+
+        Optional<T> value(std::move(slot.Value));
+        slot.Sequence.store(m_head + Size, std::memory_order_release);
+        m_head++;
+        return value;
+    }
+
+    // consumer thread only, appends up to maxCount published items to the container
+    template<class Container>
+    uint32_t Drain(Container& container, uint32_t maxCount = Size)
+    {
+        uint32_t count = 0;
+        while (count < maxCount)
+        {
+            Slot& slot = m_slots[m_head & (Size - 1)];
+            if (slot.Sequence.load(std::memory_order_acquire) != m_head + 1)
+                break;
+
+            container.push_back(std::move(slot.Value));
+            slot.Sequence.store(m_head + Size, std::memory_order_release);
+            m_head++;
+            count++;
+        }
+
+        return count;
+    }
+
+private:
+    struct Slot
+    {
+        std::atomic<uint32_t> Sequence;
+        T Value;
+    };
+
+    Slot m_slots[Size];
+    alignas(RING_BUFFER_CACHE_LINE) std::atomic<uint32_t> m_tail { 0 };
+    // only touched by the consumer
+    alignas(RING_BUFFER_CACHE_LINE) uint32_t m_head = 0;
+};
+
+#endif // RINGBUFFER_H
@@ -1,17 +1,36 @@
 #ifndef THREAD_H
 #define THREAD_H
 
+#include <stdint.h>
 #include "Mutex.h"
+#ifdef GEKKO
 #include <ogcsys.h>
 #include <gccore.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 class Thread
 {
 public:
 
-    int Create(void* (*entry)(void *),void *stackbase,u32 stack_size,u8 prio)
+    int Create(void* (*entry)(void *),void *stackbase,uint32_t stack_size,uint8_t prio)
     {
+#ifdef GEKKO
         return LWP_CreateThread(&m_threadID, entry, this, stackbase, stack_size, prio);
+#else
+        // the stack is allocated by pthreads, the priority is left to the host system
+        (void) stackbase;
+        (void) prio;
+
+        pthread_attr_t attributes;
+        pthread_attr_init(&attributes);
+        pthread_attr_setstacksize(&attributes, stack_size);
+        int result = pthread_create(&m_threadID, &attributes, entry, this);
+        pthread_attr_destroy(&attributes);
+        return result;
+#endif
     }
 
     bool Stop()
@@ -51,7 +70,11 @@ public:
             {
                 Resume();
             }
+#ifdef GEKKO
             LWP_JoinThread(m_threadID, nullptr);
+#else
+            pthread_join(m_threadID, nullptr);
+#endif
 
             m_mutex.Lock();
             m_bAvailable = true;
@@ -65,19 +88,37 @@ public:
         Release();
     }
 
+    // suspending threads is only supported by libogc
     bool IsSuspended()
     {
+#ifdef GEKKO
         return LWP_ThreadIsSuspended(m_threadID);
+#else
+        return false;
+#endif
     }
 
     void Resume()
     {
+#ifdef GEKKO
         LWP_ResumeThread(m_threadID);
+#endif
     }
 
     void Suspend()
     {
+#ifdef GEKKO
         LWP_SuspendThread(m_threadID);
+#endif
+    }
+
+    static void Yield()
+    {
+#ifdef GEKKO
+        LWP_YieldThread();
+#else
+        sched_yield();
+#endif
     }
 
     void* Data()
@@ -91,7 +132,11 @@ public:
     }
 
 private:
+#ifdef GEKKO
     lwp_t m_threadID;
+#else
+    pthread_t m_threadID;
+#endif
     bool m_bAvailable = true;
     bool m_bStop = false;
     void* m_data = nullptr;
@@ -21,8 +21,6 @@
 #define THREADPOOL_H
 
 #include "Mutex.h"
-#include <ogcsys.h>
-#include <gccore.h>
 #include "Thread.h"
 
 #define THREAD_POOL_SIZE 5
@@ -31,7 +29,9 @@ class ThreadPool
 {
 
 private:
+#ifdef GEKKO
     static lwpq_t s_thread_queue;
+#endif
     static Thread s_threads[THREAD_POOL_SIZE];
 
 public:
@@ -39,7 +39,9 @@ public:
     static void             Init();
     static Thread*          GetThread();
     static void             Destroy();
+#ifdef GEKKO
     static const lwpq_t&    GetThreadQueue();
+#endif
 
 
 };
@@ -19,12 +19,16 @@
 
 #include "Threadpool.h"
 
+#ifdef GEKKO
 lwpq_t ThreadPool::s_thread_queue;
+#endif
 Thread ThreadPool::s_threads[THREAD_POOL_SIZE];
 
 void ThreadPool::Init()
 {
+#ifdef GEKKO
     LWP_InitQueue(&s_thread_queue);
+#endif
 }
 
 Thread* ThreadPool::GetThread()
@@ -47,10 +51,14 @@ void ThreadPool::Destroy()
         s_threads[i].Destroy();
     }
 
+#ifdef GEKKO
     LWP_CloseQueue(s_thread_queue);
+#endif
 }
 
+#ifdef GEKKO
 const lwpq_t &ThreadPool::GetThreadQueue()
 {
      return s_thread_queue;
 }
+#endif
@@ -0,0 +1,127 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#include <math.h>
+#include "CaveCuller.h"
+#include "FrustumCuller.h"
+#include "chunk/Chunk.h"
+#include "chunk/SectionConnectivity.h"
+
+namespace
+{
+    // chunk x, chunk z and section offset of the neighbor behind every face, in EBlockFaces order
+    const int8_t FACE_STEPS[SECTION_FACE_COUNT][3] =
+    {
+        { -1, 0,  0 },
+        {  1, 0,  0 },
+        {  0, 1,  0 },
+        {  0, -1, 0 },
+        {  0, 0,  1 },
+        {  0, 0, -1 },
+    };
+}
+
+bool CaveCuller::Update(const std::vector<Chunk*>& chunks, const Vector3& cameraPosition, const FrustumCuller& culler)
+{
+    // blocks are centered on their position, so the sections start half a block below it
+    const float sectionHeight = CHUNK_SECTION_SIZE * BLOCK_SIZE;
+    const int32_t cameraX = (int32_t) floor((cameraPosition.GetX() + BLOCK_SIZE_HALF) / CHUNK_BLOCK_SIZE_X);
+    const int32_t cameraZ = (int32_t) floor((cameraPosition.GetZ() + BLOCK_SIZE_HALF) / CHUNK_BLOCK_SIZE_Z);
+    const int32_t cameraSection = (int32_t) floor((cameraPosition.GetY() + BLOCK_SIZE_HALF) / sectionHeight);
+
+    m_origin = ChunkCoord { cameraX - CAVE_CULLER_GRID_RADIUS, cameraZ - CAVE_CULLER_GRID_RADIUS };
+    for (Cell& cell : m_grid)
+    {
+        cell.ChunkObj = nullptr;
+        cell.VisitedSections = 0;
+    }
+
+    for (Chunk* chunk : chunks)
+    {
+        const int32_t x = chunk->GetChunkCoord().X - m_origin.X;
+        const int32_t z = chunk->GetChunkCoord().Z - m_origin.Z;
+        if (x >= 0 && x < CAVE_CULLER_GRID_SIZE && z >= 0 && z < CAVE_CULLER_GRID_SIZE)
+            m_grid[x * CAVE_CULLER_GRID_SIZE + z].ChunkObj = chunk;
+    }
+
+    // above the world everything can be seen from the sky
+    Cell& cameraCell = m_grid[CAVE_CULLER_GRID_RADIUS * CAVE_CULLER_GRID_SIZE + CAVE_CULLER_GRID_RADIUS];
+    if (cameraSection < 0 || cameraSection >= CHUNK_SECTION_COUNT || !cameraCell.ChunkObj)
+        return false;
+
+    cameraCell.VisitedSections = 1 << cameraSection;
+    m_queue.clear();
+    m_queue.push_back(Step { CAVE_CULLER_GRID_RADIUS, CAVE_CULLER_GRID_RADIUS, (uint8_t) cameraSection, SECTION_FACE_COUNT, 0 });
+
+    CullBox box;
+    uint8_t cachedPlane = 0;
+    for (size_t head = 0; head < m_queue.size(); ++head)
+    {
+        const Step step = m_queue[head];
+        const uint16_t connectivity = m_grid[step.X * CAVE_CULLER_GRID_SIZE + step.Z].ChunkObj->GetSectionConnectivity(step.Section);
+
+        for (uint8_t face = 0; face < SECTION_FACE_COUNT; ++face)
+        {
+            if (step.Directions & (1 << SectionConnectivity::GetOppositeFace(face)))
+                continue;
+
+            if (step.EntryFace < SECTION_FACE_COUNT && !SectionConnectivity::IsConnected(connectivity, step.EntryFace, face))
+                continue;
+
+            const int32_t x = step.X + FACE_STEPS[face][0];
+            const int32_t z = step.Z + FACE_STEPS[face][1];
+            const int32_t section = step.Section + FACE_STEPS[face][2];
+            if (x < 0 || x >= CAVE_CULLER_GRID_SIZE || z < 0 || z >= CAVE_CULLER_GRID_SIZE || section < 0 || section >= CHUNK_SECTION_COUNT)
+                continue;
+
+            Cell& cell = m_grid[x * CAVE_CULLER_GRID_SIZE + z];
+            if (!cell.ChunkObj || (cell.VisitedSections & (1 << section)))
+                continue;
+
+            box.Bounds[0] = (m_origin.X + x) * CHUNK_BLOCK_SIZE_X - BLOCK_SIZE_HALF;
+            box.Bounds[1] = section * sectionHeight - BLOCK_SIZE_HALF;
+            box.Bounds[2] = (m_origin.Z + z) * CHUNK_BLOCK_SIZE_Z - BLOCK_SIZE_HALF;
+            box.Bounds[3] = box.Bounds[0] + CHUNK_BLOCK_SIZE_X;
+            box.Bounds[4] = box.Bounds[1] + sectionHeight;
+            box.Bounds[5] = box.Bounds[2] + CHUNK_BLOCK_SIZE_Z;
+
+            // neighboring sections are mostly rejected by the same plane
+            uint8_t planeMask = FRUSTUM_ALL_PLANES;
+            if (culler.TestBox(box, planeMask, cachedPlane) == ECullResult::Outside)
+                continue;
+
+            cell.VisitedSections |= 1 << section;
+            m_queue.push_back(Step { (int16_t) x, (int16_t) z, (uint8_t) section, SectionConnectivity::GetOppositeFace(face),
+                                     (uint8_t) (step.Directions | (1 << face)) });
+        }
+    }
+
+    return true;
+}
+
+uint8_t CaveCuller::GetVisibleSections(const Chunk* chunk) const
+{
+    const int32_t x = chunk->GetChunkCoord().X - m_origin.X;
+    const int32_t z = chunk->GetChunkCoord().Z - m_origin.Z;
+    if (x < 0 || x >= CAVE_CULLER_GRID_SIZE || z < 0 || z >= CAVE_CULLER_GRID_SIZE)
+        return 0;
+
+    const Cell& cell = m_grid[x * CAVE_CULLER_GRID_SIZE + z];
+    return cell.ChunkObj == chunk ? cell.VisitedSections : 0;
+}
@@ -0,0 +1,74 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#ifndef _CAVECULLER_H_
+#define _CAVECULLER_H_
+
+#include <stdint.h>
+#include <vector>
+#include "chunk/ChunkManager.h"
+#include "../utils/Vector3.h"
+
+// the cashed chunks around the camera, the camera may be one chunk away from the center of the cash
+#define CAVE_CULLER_GRID_RADIUS (CHUNK_VIEW_DISTANCE_MAX + 1)
+#define CAVE_CULLER_GRID_SIZE (2 * CAVE_CULLER_GRID_RADIUS + 1)
+
+/**
+ * @brief CaveCuller
+ * Walks the sections from the one of the camera to their neighbors, but only through faces which are connected
+ * inside of the section (see SectionConnectivity), never back against a direction it already went and only into
+ * sections inside the frustum. Sections which are not reached are hidden behind solid blocks.
+ */
+class CaveCuller
+{
+public:
+    /**
+     * @brief Update finds the sections which can be seen from the camera.
+     * @return false if the camera is not inside of a cashed section, nothing can be culled then.
+     */
+    bool Update(const std::vector<class Chunk*>& chunks, const Vector3& cameraPosition, const class FrustumCuller& culler);
+
+    // one bit per section of the chunk which was reached by the last update
+    uint8_t GetVisibleSections(const class Chunk* chunk) const;
+
+private:
+    struct Cell
+    {
+        class Chunk* ChunkObj;
+        uint8_t VisitedSections;
+    };
+
+    struct Step
+    {
+        int16_t X;
+        int16_t Z;
+        uint8_t Section;
+        // the face the section was entered through, SECTION_FACE_COUNT for the section of the camera
+        uint8_t EntryFace;
+        // one bit per face direction which was taken to get here
+        uint8_t Directions;
+    };
+
+private:
+    Cell m_grid[CAVE_CULLER_GRID_SIZE * CAVE_CULLER_GRID_SIZE];
+    ChunkCoord m_origin = { 0, 0 };
+    std::vector<Step> m_queue;
+};
+
+#endif /* _CAVECULLER_H_ */
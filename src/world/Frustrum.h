@@ -25,11 +25,16 @@ public:
 	Frustrum();
 	virtual ~Frustrum();
 
-	bool CubeInFrustum( float x1, float y1, float z1, float x2, float y2, float z2  );
-	bool SphereInFrustum(float x, float y, float z, float radius);
-	bool PointInFrustum(float x, float y, float z);
+	bool CubeInFrustum( float x1, float y1, float z1, float x2, float y2, float z2  ) const;
+	bool SphereInFrustum(float x, float y, float z, float radius) const;
+	bool PointInFrustum(float x, float y, float z) const;
+	// extracts the world space planes from the current projection, view and object matrix
 	void CalculateFrustum();
 	void NormalizePlane(float frustum[6][4], int side);
+	// normal x, y, z and distance of the plane, points with a positive distance are on the inner side
+	const float* GetPlane(int side) const;
+	// row major projection * view * object matrix of the last calculation
+	const float* GetClipMatrix() const;
 
 	static Frustrum& Instance();
 
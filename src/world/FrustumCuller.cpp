@@ -0,0 +1,272 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#include <algorithm>
+#include "FrustumCuller.h"
+
+namespace
+{
+    // spreads the low 16 bits to the even bits
+    uint32_t SpreadBits(uint32_t value)
+    {
+        value &= 0xFFFF;
+        value = (value | (value << 8)) & 0x00FF00FF;
+        value = (value | (value << 4)) & 0x0F0F0F0F;
+        value = (value | (value << 2)) & 0x33333333;
+        value = (value | (value << 1)) & 0x55555555;
+        return value;
+    }
+}
+
+void FrustumCuller::SetPlane(uint32_t plane, const float* values)
+{
+    m_normalX[plane] = values[0];
+    m_normalY[plane] = values[1];
+    m_normalZ[plane] = values[2];
+    m_distance[plane] = values[3];
+
+    m_pVertexX[plane] = values[0] > 0.0f ? 3 : 0;
+    m_pVertexY[plane] = values[1] > 0.0f ? 4 : 1;
+    m_pVertexZ[plane] = values[2] > 0.0f ? 5 : 2;
+    m_nVertexX[plane] = values[0] > 0.0f ? 0 : 3;
+    m_nVertexY[plane] = values[1] > 0.0f ? 1 : 4;
+    m_nVertexZ[plane] = values[2] > 0.0f ? 2 : 5;
+}
+
+ECullResult FrustumCuller::TestBox(const CullBox& box, uint8_t& planeMask, uint8_t& cachedPlane) const
+{
+    const float* bounds = box.Bounds;
+    uint8_t plane = cachedPlane;
+    for (uint32_t i = 0; i < FRUSTUM_PLANE_COUNT; ++i)
+    {
+        if (planeMask & (1 << plane))
+        {
+            const float farthest = m_normalX[plane] * bounds[m_pVertexX[plane]] + m_normalY[plane] * bounds[m_pVertexY[plane]] +
+                                   m_normalZ[plane] * bounds[m_pVertexZ[plane]] + m_distance[plane];
+            if (farthest <= 0.0f)
+            {
+                cachedPlane = plane;
+                return ECullResult::Outside;
+            }
+
+            const float nearest = m_normalX[plane] * bounds[m_nVertexX[plane]] + m_normalY[plane] * bounds[m_nVertexY[plane]] +
+                                  m_normalZ[plane] * bounds[m_nVertexZ[plane]] + m_distance[plane];
+            if (nearest > 0.0f)
+                planeMask &= ~(1 << plane);
+        }
+
+        plane = plane + 1 < FRUSTUM_PLANE_COUNT ? plane + 1 : 0;
+    }
+
+    return planeMask ? ECullResult::Intersecting : ECullResult::Inside;
+}
+
+void FrustumCuller::Update(const std::vector<CullChunk>& chunks)
+{
+    if (IsLayoutChanged(chunks))
+        Build(chunks);
+
+    Refit(chunks);
+}
+
+void FrustumCuller::Cull(std::vector<VisibleChunk>& visibleChunks, ChunkRenderStats& stats)
+{
+    if (m_root < 0)
+        return;
+
+    stats.TestedChunks += m_nodes[m_root].GeometryChunks;
+    CullNode(m_root, FRUSTUM_ALL_PLANES, visibleChunks, stats);
+}
+
+bool FrustumCuller::IsLayoutChanged(const std::vector<CullChunk>& chunks) const
+{
+    if (chunks.size() != m_chunkCount)
+        return true;
+
+    // the chunk objects are reused when the player moves, the tree is sorted by their coordinates
+    for (const Node& node : m_nodes)
+    {
+        if (node.IsLeaf && (chunks[node.Source].ChunkObj != node.ChunkObj || chunks[node.Source].Coord != node.Coord))
+            return true;
+    }
+
+    return false;
+}
+
+void FrustumCuller::Build(const std::vector<CullChunk>& chunks)
+{
+    m_chunkCount = chunks.size();
+    m_nodes.clear();
+    m_root = -1;
+    if (chunks.empty())
+        return;
+
+    int32_t minX = chunks[0].Coord.X;
+    int32_t minZ = chunks[0].Coord.Z;
+    for (const CullChunk& chunk : chunks)
+    {
+        minX = std::min(minX, chunk.Coord.X);
+        minZ = std::min(minZ, chunk.Coord.Z);
+    }
+
+    // chunks which are close on the map are close in the z-order, every two bits of the code are one tree level
+    std::vector<TreeEntry> entries;
+    entries.reserve(chunks.size());
+    for (uint32_t i = 0; i < chunks.size(); ++i)
+    {
+        const ChunkCoord& coord = chunks[i].Coord;
+        entries.push_back(TreeEntry { SpreadBits(coord.X - minX) | (SpreadBits(coord.Z - minZ) << 1), i });
+    }
+    std::sort(entries.begin(), entries.end(), [](const TreeEntry& a, const TreeEntry& b) { return a.Code < b.Code; });
+
+    m_nodes.reserve(chunks.size() * 2);
+    m_root = BuildNode(chunks, entries, 0, entries.size(), 30);
+}
+
+int32_t FrustumCuller::BuildNode(const std::vector<CullChunk>& chunks, const std::vector<TreeEntry>& entries, uint32_t begin, uint32_t end, int32_t shift)
+{
+    // the coordinates of the cashed chunks are unique, so a single chunk is left before the codes run out
+    if (end - begin == 1 || shift < 0)
+    {
+        Node leaf;
+        leaf.Source = entries[begin].Source;
+        leaf.ChunkObj = chunks[leaf.Source].ChunkObj;
+        leaf.Coord = chunks[leaf.Source].Coord;
+        leaf.IsLeaf = true;
+        m_nodes.push_back(leaf);
+        return m_nodes.size() - 1;
+    }
+
+    uint32_t ranges[5] = { begin, begin, begin, begin, begin };
+    uint32_t quadrants = 0;
+    for (uint32_t quadrant = 0; quadrant < 4; ++quadrant)
+    {
+        uint32_t rangeEnd = ranges[quadrant];
+        while (rangeEnd < end && ((entries[rangeEnd].Code >> shift) & 3) == quadrant)
+            rangeEnd++;
+
+        ranges[quadrant + 1] = rangeEnd;
+        if (rangeEnd > ranges[quadrant])
+            quadrants++;
+    }
+
+    // levels where all chunks are in one quadrant get no node
+    if (quadrants == 1)
+        return BuildNode(chunks, entries, begin, end, shift - 2);
+
+    Node node;
+    for (uint32_t quadrant = 0; quadrant < 4; ++quadrant)
+    {
+        if (ranges[quadrant + 1] > ranges[quadrant])
+            node.Children[quadrant] = BuildNode(chunks, entries, ranges[quadrant], ranges[quadrant + 1], shift - 2);
+    }
+
+    m_nodes.push_back(node);
+    return m_nodes.size() - 1;
+}
+
+void FrustumCuller::Refit(const std::vector<CullChunk>& chunks)
+{
+    for (Node& node : m_nodes)
+    {
+        if (node.IsLeaf)
+        {
+            node.Box = chunks[node.Source].Box;
+            node.HasGeometry = chunks[node.Source].HasGeometry;
+            node.GeometryChunks = node.HasGeometry ? 1 : 0;
+            continue;
+        }
+
+        node.HasGeometry = false;
+        node.GeometryChunks = 0;
+        for (int32_t childIndex : node.Children)
+        {
+            if (childIndex < 0 || !m_nodes[childIndex].HasGeometry)
+                continue;
+
+            const Node& child = m_nodes[childIndex];
+            if (!node.HasGeometry)
+            {
+                node.Box = child.Box;
+                node.HasGeometry = true;
+            }
+            else
+            {
+                for (uint32_t i = 0; i < 3; ++i)
+                {
+                    node.Box.Bounds[i] = std::min(node.Box.Bounds[i], child.Box.Bounds[i]);
+                    node.Box.Bounds[i + 3] = std::max(node.Box.Bounds[i + 3], child.Box.Bounds[i + 3]);
+                }
+            }
+            node.GeometryChunks += child.GeometryChunks;
+        }
+    }
+}
+
+void FrustumCuller::CullNode(int32_t index, uint8_t planeMask, std::vector<VisibleChunk>& visibleChunks, ChunkRenderStats& stats)
+{
+    Node& node = m_nodes[index];
+    if (!node.HasGeometry)
+        return;
+
+    stats.BoxTests++;
+    const ECullResult result = TestBox(node.Box, planeMask, node.CachedPlane);
+    if (result == ECullResult::Outside)
+    {
+        stats.CulledChunks += node.GeometryChunks;
+        return;
+    }
+
+    if (result == ECullResult::Inside)
+    {
+        AddNode(index, visibleChunks);
+        return;
+    }
+
+    if (node.IsLeaf)
+    {
+        visibleChunks.push_back(VisibleChunk { node.ChunkObj, planeMask });
+        return;
+    }
+
+    for (int32_t childIndex : node.Children)
+    {
+        if (childIndex >= 0)
+            CullNode(childIndex, planeMask, visibleChunks, stats);
+    }
+}
+
+void FrustumCuller::AddNode(int32_t index, std::vector<VisibleChunk>& visibleChunks)
+{
+    const Node& node = m_nodes[index];
+    if (!node.HasGeometry)
+        return;
+
+    if (node.IsLeaf)
+    {
+        visibleChunks.push_back(VisibleChunk { node.ChunkObj, 0 });
+        return;
+    }
+
+    for (int32_t childIndex : node.Children)
+    {
+        if (childIndex >= 0)
+            AddNode(childIndex, visibleChunks);
+    }
+}
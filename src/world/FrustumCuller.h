@@ -0,0 +1,134 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#ifndef _FRUSTUMCULLER_H_
+#define _FRUSTUMCULLER_H_
+
+#include <stdint.h>
+#include <vector>
+#include "chunk/ChunkData.h"
+
+#define FRUSTUM_PLANE_COUNT 6
+#define FRUSTUM_ALL_PLANES ((1 << FRUSTUM_PLANE_COUNT) - 1)
+
+// min x, y, z in 0..2 and max x, y, z in 3..5, so a corner is picked per axis by index instead of a branch
+struct CullBox
+{
+    float Bounds[6];
+};
+
+enum class ECullResult : uint8_t
+{
+    Outside,
+    Intersecting,
+    Inside
+};
+
+// a chunk column handed to the culler, the bounds only span the sections with geometry
+struct CullChunk
+{
+    class Chunk* ChunkObj;
+    ChunkCoord Coord;
+    CullBox Box;
+    bool HasGeometry;
+};
+
+struct VisibleChunk
+{
+    class Chunk* ChunkObj;
+    // planes the chunk intersects, the sections of a chunk which is fully inside are not tested
+    uint8_t PlaneMask;
+};
+
+/**
+ * @brief FrustumCuller
+ * Tests boxes against the frustum planes, which are kept as structure of arrays. Only the corner of a box which
+ * is farthest along a plane normal (p-vertex) is tested for rejection and the nearest one (n-vertex) for
+ * acceptance. The plane which rejected a box last time is tested first next frame.
+ * The chunk columns are grouped in a quadtree, so whole quadrants are accepted or rejected with one test.
+ * The culler only reads the coordinates and bounds it is handed, so it does not depend on the chunks or the GPU.
+ */
+class FrustumCuller
+{
+public:
+    // copies a plane of the frustum, the planes have to be set once per frame after the frustum was calculated
+    void SetPlane(uint32_t plane, const float* values);
+
+    /**
+     * @brief TestBox tests the box against the planes in the plane mask.
+     * @param planeMask planes to test, the planes the box is fully inside of are removed.
+     * @param cachedPlane the plane tested first, set to the plane which rejected the box.
+     */
+    ECullResult TestBox(const CullBox& box, uint8_t& planeMask, uint8_t& cachedPlane) const;
+
+    // rebuilds the quadtree if the chunks were moved and refits the bounds to the current meshes
+    void Update(const std::vector<CullChunk>& chunks);
+
+    // appends the chunks intersecting the frustum
+    void Cull(std::vector<VisibleChunk>& visibleChunks, ChunkRenderStats& stats);
+
+private:
+    struct Node
+    {
+        CullBox Box;
+        // children are stored before their parent, so the bounds are refit in one pass
+        int32_t Children[4]     = { -1, -1, -1, -1 };
+        class Chunk* ChunkObj   = nullptr;
+        ChunkCoord Coord        = { 0, 0 };
+        // index of the chunk of a leaf in the chunks passed to Update
+        uint32_t Source         = 0;
+        // chunks below the node which have a mesh
+        uint32_t GeometryChunks = 0;
+        uint8_t CachedPlane     = 0;
+        bool HasGeometry        = false;
+        bool IsLeaf             = false;
+    };
+
+    struct TreeEntry
+    {
+        uint32_t Code;
+        uint32_t Source;
+    };
+
+    void Build(const std::vector<CullChunk>& chunks);
+    int32_t BuildNode(const std::vector<CullChunk>& chunks, const std::vector<TreeEntry>& entries, uint32_t begin, uint32_t end, int32_t shift);
+    bool IsLayoutChanged(const std::vector<CullChunk>& chunks) const;
+    void Refit(const std::vector<CullChunk>& chunks);
+    void CullNode(int32_t index, uint8_t planeMask, std::vector<VisibleChunk>& visibleChunks, ChunkRenderStats& stats);
+    void AddNode(int32_t index, std::vector<VisibleChunk>& visibleChunks);
+
+private:
+    float m_normalX[FRUSTUM_PLANE_COUNT];
+    float m_normalY[FRUSTUM_PLANE_COUNT];
+    float m_normalZ[FRUSTUM_PLANE_COUNT];
+    float m_distance[FRUSTUM_PLANE_COUNT];
+    // index of the p-vertex and n-vertex coordinates in CullBox::Bounds per plane
+    uint8_t m_pVertexX[FRUSTUM_PLANE_COUNT];
+    uint8_t m_pVertexY[FRUSTUM_PLANE_COUNT];
+    uint8_t m_pVertexZ[FRUSTUM_PLANE_COUNT];
+    uint8_t m_nVertexX[FRUSTUM_PLANE_COUNT];
+    uint8_t m_nVertexY[FRUSTUM_PLANE_COUNT];
+    uint8_t m_nVertexZ[FRUSTUM_PLANE_COUNT];
+
+    std::vector<Node> m_nodes;
+    uint32_t m_chunkCount = 0;
+    int32_t m_root = -1;
+};
+
+#endif /* _FRUSTUMCULLER_H_ */
@@ -22,8 +22,8 @@
 #include <time.h>
 #include <string>
 #include <inttypes.h>
+#include <algorithm>
 #include "GameWorld.h"
-#include "Frustrum.h"
 #include "../renderer/MasterRenderer.h"
 #include "../utils/Debug.h"
 #include "../utils/Filesystem.h"
@@ -53,28 +53,95 @@ void GameWorld::GenerateWorld()
 
 void GameWorld::Draw()
 {
-    auto& playerPosition = static_cast<Basic3DScene&>(Engine::Get().GetSceneHandler().GetCurrentScene()).GetEntityHandler().GetPlayer()->GetPosition();
+    Entity* player = static_cast<Basic3DScene&>(Engine::Get().GetSceneHandler().GetCurrentScene()).GetEntityHandler().GetPlayer();
+    auto& playerPosition = player->GetPosition();
+    auto& playerRotation = player->GetRotation();
     auto& loadedChunks = m_chunkLoader.GetLoadedChunks();
-    for( auto& chunk : loadedChunks)
+    m_renderStats = ChunkRenderStats();
+    m_frustum.CalculateFrustum();
+    for (uint32_t plane = 0; plane < FRUSTUM_PLANE_COUNT; ++plane)
+        m_culler.SetPlane(plane, m_frustum.GetPlane(plane));
+
+    // chunk display lists are recorded and drawn with the compact chunk vertex format
+    MasterRenderer::SetChunkGraphicsMode();
+    m_chunkLoader.UpdateMeshes(playerPosition, playerRotation);
+    // uploaded meshes change the bounds of the chunks, so the tree is refit after them
+    m_cullChunks.clear();
+    for (Chunk* chunk : loadedChunks)
+    {
+        CullChunk cullChunk;
+        cullChunk.ChunkObj = chunk;
+        cullChunk.Coord = chunk->GetChunkCoord();
+        cullChunk.HasGeometry = chunk->GetRenderBounds(cullChunk.Box);
+        m_cullChunks.push_back(cullChunk);
+    }
+    m_culler.Update(m_cullChunks);
+    m_visibleChunks.clear();
+    m_culler.Cull(m_visibleChunks, m_renderStats);
+
+    // the sections reached by the cave culling were tested against the frustum already
+    const bool bCaveCulling = m_caveCuller.Update(loadedChunks, playerPosition, m_culler);
+    RasterizeOccluders(playerPosition);
+    for( auto& visibleChunk : m_visibleChunks)
     {        
-        if (chunk->IsDirty())
-        {             
-            chunk->RebuildDisplayList();            
+        const uint8_t visibleSections = bCaveCulling ? m_caveCuller.GetVisibleSections(visibleChunk.ChunkObj) : 0xFF;
+        if (!visibleSections)
+        {
+            m_renderStats.CaveCulledChunks++;
+            continue;
         }
-        chunk->Render();
-    }    
-    m_chunkLoader.UpdateChunksBy(playerPosition);
+
+        CullBox bounds;
+        if (visibleChunk.ChunkObj->GetRenderBounds(bounds) && m_occlusionBuffer.IsOccluded(bounds))
+        {
+            m_renderStats.OccludedChunks++;
+            continue;
+        }
+
+        visibleChunk.ChunkObj->Render(m_culler, playerPosition, bCaveCulling ? 0 : visibleChunk.PlaneMask, visibleSections, m_renderStats);
+    }
+    m_chunkLoader.GetLodTerrain().Render(m_culler);
+
+    MasterRenderer::LoadWorldMatrix();
+    MasterRenderer::SetGraphicsMode(true, true);
+
+    m_chunkLoader.UpdateChunksBy(playerPosition, playerRotation);
     DrawFocusOnSelectedCube();
 }
 
+void GameWorld::RasterizeOccluders(const Vector3& cameraPosition)
+{
+    m_occlusionBuffer.Begin(m_frustum.GetClipMatrix(), cameraPosition.GetX(), cameraPosition.GetY(), cameraPosition.GetZ());
+
+    // the closest chunks hide the most, the rest are drawn front to back as well
+    const ChunkCoord cameraCoord = GetChunkCoordByWorldPosition(cameraPosition);
+    auto closerToCamera = [&cameraCoord](const VisibleChunk& a, const VisibleChunk& b)
+    {
+        return GetChunkDistanceSquared(a.ChunkObj->GetChunkCoord(), cameraCoord) < GetChunkDistanceSquared(b.ChunkObj->GetChunkCoord(), cameraCoord);
+    };
+    const size_t occluderChunks = std::min<size_t>(m_visibleChunks.size(), OCCLUSION_OCCLUDER_CHUNKS);
+    std::partial_sort(m_visibleChunks.begin(), m_visibleChunks.begin() + occluderChunks, m_visibleChunks.end(), closerToCamera);
+
+    CullBox occluders[CHUNK_OCCLUDER_COUNT];
+    for (size_t i = 0; i < occluderChunks; ++i)
+    {
+        const uint32_t count = m_visibleChunks[i].ChunkObj->GetOccluders(occluders);
+        for (uint32_t j = 0; j < count; ++j)
+            m_occlusionBuffer.AddOccluder(occluders[j]);
+    }
+
+    m_occlusionBuffer.End();
+    m_renderStats.Occluders = m_occlusionBuffer.GetOccluderCount();
+}
+
 BlockManager& GameWorld::GetBlockManager()
 {
 	return *m_blockManager;
 }
 
-Chunk* GameWorld::GetCashedChunkAt(const Vector3& centerPosition)
+Chunk* GameWorld::GetCashedChunkAt(const ChunkCoord& coord)
 {
-    return m_chunkLoader.GetChunkFromCash(centerPosition);
+    return m_chunkLoader.GetChunkFromCash(coord);
 }
 
 Chunk* GameWorld::GetCashedChunkByWorldPosition(const Vector3& worldPosition)
@@ -193,3 +260,40 @@ void GameWorld::Serialize(const BlockChangeData& data)
 {
     m_chunkLoader.Serialize(data);
 }
+
+uint32_t GameWorld::GetLodTileCount()
+{
+    return m_chunkLoader.GetLodTerrain().GetTileCount();
+}
+
+uint32_t GameWorld::GetLodFaces()
+{
+    return m_chunkLoader.GetLodTerrain().GetAmountOfFaces();
+}
+
+uint32_t GameWorld::GetViewDistance() const
+{
+    return m_chunkLoader.GetViewDistance();
+}
+
+void GameWorld::SetViewDistance(uint32_t viewDistance)
+{
+    m_chunkLoader.SetViewDistance(viewDistance);
+}
+
+EMeshingMode GameWorld::GetMeshingMode() const
+{
+    return m_meshingMode;
+}
+
+void GameWorld::SetMeshingMode(EMeshingMode mode)
+{
+    if (m_meshingMode != mode)
+    {
+        m_meshingMode = mode;
+        for (auto& chunk : m_chunkLoader.GetLoadedChunks())
+        {
+            chunk->SetDirty(true);
+        }
+    }
+}
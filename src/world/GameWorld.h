@@ -24,6 +24,10 @@
 #include "chunk/ChunkManager.h"
 #include "blocks/BlockManager.h"
 #include "PerlinNoise.h"
+#include "Frustrum.h"
+#include "FrustumCuller.h"
+#include "CaveCuller.h"
+#include "OcclusionBuffer.h"
 #include "../renderer/BlockRenderer.h"
 #include "../scenes/Basic3DScene.h"
 #include "../utils/MathHelper.h"
@@ -36,7 +40,7 @@ public:
 	void Draw();
 
 	class BlockManager& GetBlockManager();
-    class Chunk* GetCashedChunkAt(const Vector3& centerPosition);
+    class Chunk* GetCashedChunkAt(const ChunkCoord& coord);
     class Chunk* GetCashedChunkByWorldPosition(const Vector3& worldPosition);
 	void RemoveBlockByWorldPosition(const Vector3& blockPosition);
 	void AddBlockAtWorldPosition(const Vector3& blockPosition, BlockType type);
@@ -47,9 +51,32 @@ public:
     PerlinNoise GetNoise() const;
     void Serialize(const struct BlockChangeData& data);
 
+    // simplified terrain tiles beyond the view distance
+    uint32_t GetLodTileCount();
+    uint32_t GetLodFaces();
+
+    // radius of the loaded chunks around the player in chunks
+    uint32_t GetViewDistance() const;
+    void SetViewDistance(uint32_t viewDistance);
+
+    EMeshingMode GetMeshingMode() const;
+    void SetMeshingMode(EMeshingMode mode);
+
+    // chunks and sections tested against the frustum and what was drawn in the last frame
+    const ChunkRenderStats& GetRenderStats() const
+    {
+        return m_renderStats;
+    }
+
+    uint32_t GetBlockMemoryUsage() const
+    {
+        return m_chunkLoader.GetBlockMemoryUsage();
+    }
+
 
 private:    
 	void DrawFocusOnSelectedCube();
+    void RasterizeOccluders(const Vector3& cameraPosition);
     void SetSeed();
 
 private:	   
@@ -62,6 +89,16 @@ private:
     BlockManager* m_blockManager        = nullptr;
     PerlinNoise m_noise;
 
+    EMeshingMode m_meshingMode          = EMeshingMode::Greedy;
+    // calculated once per frame, the chunks and LOD tiles are tested against it
+    Frustrum m_frustum;
+    FrustumCuller m_culler;
+    CaveCuller m_caveCuller;
+    OcclusionBuffer m_occlusionBuffer;
+    std::vector<CullChunk> m_cullChunks;
+    std::vector<VisibleChunk> m_visibleChunks;
+    ChunkRenderStats m_renderStats;
+
 };
 
 #endif /* _GAMEWORLD_H_ */
@@ -0,0 +1,219 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#include <math.h>
+#include <algorithm>
+#include "OcclusionBuffer.h"
+
+static_assert(OCCLUSION_BUFFER_WIDTH % (1 << (OCCLUSION_BUFFER_LEVELS - 1)) == 0 && OCCLUSION_BUFFER_HEIGHT % (1 << (OCCLUSION_BUFFER_LEVELS - 1)) == 0,
+              "every level has to halve the level below");
+
+namespace
+{
+    // corner i of a box has the max x if bit 0 is set, the max y for bit 1 and the max z for bit 2
+    const uint8_t BOX_FACES[6][4] =
+    {
+        { 0, 2, 6, 4 },     // min x
+        { 1, 3, 7, 5 },     // max x
+        { 0, 1, 5, 4 },     // min y
+        { 2, 3, 7, 6 },     // max y
+        { 0, 1, 3, 2 },     // min z
+        { 4, 5, 7, 6 },     // max z
+    };
+}
+
+uint32_t OcclusionBuffer::GetLevelOffset(uint32_t level)
+{
+    uint32_t offset = 0;
+    for (uint32_t i = 0; i < level; ++i)
+        offset += (OCCLUSION_BUFFER_WIDTH >> i) * (OCCLUSION_BUFFER_HEIGHT >> i);
+    return offset;
+}
+
+void OcclusionBuffer::Begin(const float clip[16], float cameraX, float cameraY, float cameraZ)
+{
+    std::copy(clip, clip + 16, m_clip);
+    m_camera[0] = cameraX;
+    m_camera[1] = cameraY;
+    m_camera[2] = cameraZ;
+    m_occluders = 0;
+
+    // nothing in front of the far plane is hidden yet
+    std::fill(m_depth, m_depth + OCCLUSION_BUFFER_WIDTH * OCCLUSION_BUFFER_HEIGHT, 0.0f);
+}
+
+void OcclusionBuffer::AddOccluder(const CullBox& box)
+{
+    ScreenVertex corners[8];
+    if (!ProjectCorners(box, corners))
+        return;
+
+    // a face can be seen if the camera is outside of its plane
+    for (uint32_t face = 0; face < 6; ++face)
+    {
+        const uint32_t axis = face / 2;
+        const bool bMaxFace = face & 1;
+        if (bMaxFace ? m_camera[axis] <= box.Bounds[axis + 3] : m_camera[axis] >= box.Bounds[axis])
+            continue;
+
+        const uint8_t* quad = BOX_FACES[face];
+        RasterizeTriangle(corners[quad[0]], corners[quad[1]], corners[quad[2]]);
+        RasterizeTriangle(corners[quad[0]], corners[quad[2]], corners[quad[3]]);
+    }
+
+    m_occluders++;
+}
+
+void OcclusionBuffer::End()
+{
+    for (uint32_t level = 1; level < OCCLUSION_BUFFER_LEVELS; ++level)
+    {
+        const float* below = m_depth + GetLevelOffset(level - 1);
+        float* texels = m_depth + GetLevelOffset(level);
+        const uint32_t width = OCCLUSION_BUFFER_WIDTH >> level;
+        const uint32_t height = OCCLUSION_BUFFER_HEIGHT >> level;
+
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                const float* row0 = below + (y * 2) * (width * 2) + x * 2;
+                const float* row1 = row0 + width * 2;
+                texels[y * width + x] = std::min(std::min(row0[0], row0[1]), std::min(row1[0], row1[1]));
+            }
+        }
+    }
+}
+
+bool OcclusionBuffer::IsOccluded(const CullBox& box) const
+{
+    ScreenVertex corners[8];
+    if (!ProjectCorners(box, corners))
+        return false;
+
+    float minX = corners[0].X, maxX = corners[0].X;
+    float minY = corners[0].Y, maxY = corners[0].Y;
+    float closest = corners[0].InvW;
+    for (uint32_t i = 1; i < 8; ++i)
+    {
+        minX = std::min(minX, corners[i].X);
+        maxX = std::max(maxX, corners[i].X);
+        minY = std::min(minY, corners[i].Y);
+        maxY = std::max(maxY, corners[i].Y);
+        closest = std::max(closest, corners[i].InvW);
+    }
+
+    closest *= OCCLUSION_BUFFER_DEPTH_BIAS;
+    if (maxX < 0.0f || maxY < 0.0f || minX >= OCCLUSION_BUFFER_WIDTH || minY >= OCCLUSION_BUFFER_HEIGHT)
+        return false;
+
+    const int32_t x0 = std::max<int32_t>(0, (int32_t) floor(minX));
+    const int32_t y0 = std::max<int32_t>(0, (int32_t) floor(minY));
+    const int32_t x1 = std::min<int32_t>(OCCLUSION_BUFFER_WIDTH - 1, (int32_t) floor(maxX));
+    const int32_t y1 = std::min<int32_t>(OCCLUSION_BUFFER_HEIGHT - 1, (int32_t) floor(maxY));
+
+    // the level where the box touches two texels in each direction, its texels are as far as the farthest below them
+    uint32_t level = 0;
+    while (level + 1 < OCCLUSION_BUFFER_LEVELS && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1))
+        level++;
+
+    const float* texels = m_depth + GetLevelOffset(level);
+    const int32_t width = OCCLUSION_BUFFER_WIDTH >> level;
+    bool bOccluded = true;
+    for (int32_t y = y0 >> level; y <= (y1 >> level) && bOccluded; ++y)
+    {
+        for (int32_t x = x0 >> level; x <= (x1 >> level) && bOccluded; ++x)
+            bOccluded = texels[y * width + x] > closest;
+    }
+
+    if (bOccluded || level == 0)
+        return bOccluded;
+
+    // the coarse texels also cover what is next to the box, only the full resolution is exact
+    for (int32_t y = y0; y <= y1; ++y)
+    {
+        for (int32_t x = x0; x <= x1; ++x)
+        {
+            if (m_depth[y * OCCLUSION_BUFFER_WIDTH + x] <= closest)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+uint32_t OcclusionBuffer::GetOccluderCount() const
+{
+    return m_occluders;
+}
+
+bool OcclusionBuffer::ProjectCorners(const CullBox& box, ScreenVertex corners[8]) const
+{
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        const float x = box.Bounds[i & 1 ? 3 : 0];
+        const float y = box.Bounds[i & 2 ? 4 : 1];
+        const float z = box.Bounds[i & 4 ? 5 : 2];
+
+        const float w = m_clip[12] * x + m_clip[13] * y + m_clip[14] * z + m_clip[15];
+        if (w < OCCLUSION_BUFFER_MIN_W)
+            return false;
+
+        const float invW = 1.0f / w;
+        const float clipX = m_clip[0] * x + m_clip[1] * y + m_clip[2] * z + m_clip[3];
+        const float clipY = m_clip[4] * x + m_clip[5] * y + m_clip[6] * z + m_clip[7];
+        corners[i].X = (clipX * invW * 0.5f + 0.5f) * OCCLUSION_BUFFER_WIDTH;
+        corners[i].Y = (0.5f - clipY * invW * 0.5f) * OCCLUSION_BUFFER_HEIGHT;
+        corners[i].InvW = invW;
+    }
+
+    return true;
+}
+
+void OcclusionBuffer::RasterizeTriangle(const ScreenVertex& a, const ScreenVertex& b, const ScreenVertex& c)
+{
+    const float area = (b.X - a.X) * (c.Y - a.Y) - (b.Y - a.Y) * (c.X - a.X);
+    if (fabs(area) < 1e-6f)
+        return;
+
+    // texels whose center is inside of the bounds of the triangle
+    const int32_t minX = std::max<int32_t>(0, (int32_t) ceil(std::min(a.X, std::min(b.X, c.X)) - 0.5f));
+    const int32_t minY = std::max<int32_t>(0, (int32_t) ceil(std::min(a.Y, std::min(b.Y, c.Y)) - 0.5f));
+    const int32_t maxX = std::min<int32_t>(OCCLUSION_BUFFER_WIDTH - 1, (int32_t) floor(std::max(a.X, std::max(b.X, c.X)) - 0.5f));
+    const int32_t maxY = std::min<int32_t>(OCCLUSION_BUFFER_HEIGHT - 1, (int32_t) floor(std::max(a.Y, std::max(b.Y, c.Y)) - 0.5f));
+
+    // barycentric weights divided by the signed area are positive inside for both windings
+    const float invArea = 1.0f / area;
+    for (int32_t y = minY; y <= maxY; ++y)
+    {
+        const float py = y + 0.5f;
+        for (int32_t x = minX; x <= maxX; ++x)
+        {
+            const float px = x + 0.5f;
+            const float weightA = ((b.X - px) * (c.Y - py) - (b.Y - py) * (c.X - px)) * invArea;
+            const float weightB = ((c.X - px) * (a.Y - py) - (c.Y - py) * (a.X - px)) * invArea;
+            const float weightC = 1.0f - weightA - weightB;
+            if (weightA < 0.0f || weightB < 0.0f || weightC < 0.0f)
+                continue;
+
+            float& depth = m_depth[y * OCCLUSION_BUFFER_WIDTH + x];
+            depth = std::max(depth, weightA * a.InvW + weightB * b.InvW + weightC * c.InvW);
+        }
+    }
+}
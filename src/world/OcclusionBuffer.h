@@ -0,0 +1,86 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#ifndef _OCCLUSIONBUFFER_H_
+#define _OCCLUSIONBUFFER_H_
+
+#include <stdint.h>
+#include "FrustumCuller.h"
+
+#define OCCLUSION_BUFFER_WIDTH 128
+#define OCCLUSION_BUFFER_HEIGHT 64
+// the full resolution and three levels which keep the farthest depth of 2x2 texels of the level below
+#define OCCLUSION_BUFFER_LEVELS 4
+// occluders are taken from this many of the closest chunks, farther ones cover too few texels
+#define OCCLUSION_OCCLUDER_CHUNKS 48
+// boxes have to be this much behind the occluders, so a chunk is not hidden by an occluder on its own border
+#define OCCLUSION_BUFFER_DEPTH_BIAS 1.001f
+// corners closer to the camera than this are not projected, the box is not used as occluder or counts as visible
+#define OCCLUSION_BUFFER_MIN_W 0.1f
+
+/**
+ * @brief OcclusionBuffer
+ * A small depth buffer rasterized on the CPU from solid boxes, boxes behind them can be skipped before they are drawn.
+ * The buffer keeps 1 / w of the closest occluder per texel, which is linear in screen space.
+ * Occluders cover the texels whose center they cover and tested boxes every texel they touch, so only
+ * a gap of less than a texel between two occluders can hide a box which is still visible.
+ */
+class OcclusionBuffer
+{
+public:
+    /**
+     * @brief Begin clears the buffer.
+     * @param clip row major projection * view matrix which transforms column vectors to clip space.
+     */
+    void Begin(const float clip[16], float cameraX, float cameraY, float cameraZ);
+
+    // rasterizes the faces of the solid box which face the camera
+    void AddOccluder(const CullBox& box);
+
+    // builds the lower resolution levels, has to be called after the occluders were added
+    void End();
+
+    // true if the box is behind the occluders everywhere
+    bool IsOccluded(const CullBox& box) const;
+
+    uint32_t GetOccluderCount() const;
+
+private:
+    struct ScreenVertex
+    {
+        float X;
+        float Y;
+        float InvW;
+    };
+
+    static uint32_t GetLevelOffset(uint32_t level);
+    bool ProjectCorners(const CullBox& box, ScreenVertex corners[8]) const;
+    void RasterizeTriangle(const ScreenVertex& a, const ScreenVertex& b, const ScreenVertex& c);
+
+private:
+    float m_clip[16];
+    float m_camera[3];
+    static_assert(OCCLUSION_BUFFER_LEVELS == 4, "the depth buffer is sized for four levels");
+    // all levels one after another, starting with the full resolution
+    float m_depth[OCCLUSION_BUFFER_WIDTH * OCCLUSION_BUFFER_HEIGHT + (OCCLUSION_BUFFER_WIDTH * OCCLUSION_BUFFER_HEIGHT >> 2) +
+                  (OCCLUSION_BUFFER_WIDTH * OCCLUSION_BUFFER_HEIGHT >> 4) + (OCCLUSION_BUFFER_WIDTH * OCCLUSION_BUFFER_HEIGHT >> 6)];
+    uint32_t m_occluders = 0;
+};
+
+#endif /* _OCCLUSIONBUFFER_H_ */
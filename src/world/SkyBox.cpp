@@ -21,12 +21,12 @@
 #include "../renderer/MasterRenderer.h"
 #include "../utils/Vector3.h"
 
-#include "SkyBox_Top_png.h"
-#include "SkyBox_Left_png.h"
-#include "SkyBox_Right_png.h"
-#include "SkyBox_Bottom_png.h"
-#include "SkyBox_Front_png.h"
-#include "SkyBox_Back_png.h"
+#include "SkyBox_Top_tpl.h"
+#include "SkyBox_Left_tpl.h"
+#include "SkyBox_Right_tpl.h"
+#include "SkyBox_Bottom_tpl.h"
+#include "SkyBox_Front_tpl.h"
+#include "SkyBox_Back_tpl.h"
 
 
 #define SKY_FRONT 0
@@ -48,12 +48,12 @@ SkyBox::~SkyBox() {}
 
 void SkyBox::Init()
 {
-    m_pSkyBoxTextures[SKY_FRONT] = Texture::Create(SkyBox_Front_png, SkyBox_Front_png_size);
-    m_pSkyBoxTextures[SKY_RIGHT] = Texture::Create(SkyBox_Right_png, SkyBox_Right_png_size);
-    m_pSkyBoxTextures[SKY_LEFT]  = Texture::Create(SkyBox_Left_png, SkyBox_Left_png_size);
-    m_pSkyBoxTextures[SKY_BACK]  = Texture::Create(SkyBox_Back_png, SkyBox_Back_png_size);
-    m_pSkyBoxTextures[SKY_UP]    = Texture::Create(SkyBox_Top_png, SkyBox_Top_png_size);
-    m_pSkyBoxTextures[SKY_DOWN]  = Texture::Create(SkyBox_Bottom_png, SkyBox_Bottom_png_size);
+    m_pSkyBoxTextures[SKY_FRONT] = Texture::Create(SkyBox_Front_tpl, SkyBox_Front_tpl_size);
+    m_pSkyBoxTextures[SKY_RIGHT] = Texture::Create(SkyBox_Right_tpl, SkyBox_Right_tpl_size);
+    m_pSkyBoxTextures[SKY_LEFT]  = Texture::Create(SkyBox_Left_tpl, SkyBox_Left_tpl_size);
+    m_pSkyBoxTextures[SKY_BACK]  = Texture::Create(SkyBox_Back_tpl, SkyBox_Back_tpl_size);
+    m_pSkyBoxTextures[SKY_UP]    = Texture::Create(SkyBox_Top_tpl, SkyBox_Top_tpl_size);
+    m_pSkyBoxTextures[SKY_DOWN]  = Texture::Create(SkyBox_Bottom_tpl, SkyBox_Bottom_tpl_size);
 
 	CreateSkyBox();    
 }
@@ -66,21 +66,12 @@ void SkyBox::Clear()
         m_pSkyBoxTextures[i] = nullptr;
     }
 
-    if ( m_displayListSize > 0 )
-    {
-        free(m_pDispList);
-        m_displayListSize = 0;
-        m_pDispList = nullptr;
-    }
+    DisplayListArena::Release(m_displayList);
 }
 
 void SkyBox::CreateSkyBox()
 {
-    size_t size = MasterRenderer::GetDisplayListSizeForFaces(SKYBOX_FACES);
-	m_pDispList = memalign(32, size);
-	memset(m_pDispList, 0, size);
-	DCInvalidateRange(m_pDispList, size);
-	GX_BeginDispList(m_pDispList, size);
+    DisplayListArena::Begin(MasterRenderer::GetDisplayListSizeForFaces(SKYBOX_FACES));
 
 	GX_SetCullMode(GX_CULL_BACK);
 
@@ -185,17 +176,16 @@ void SkyBox::CreateSkyBox()
 
 	GX_SetCullMode(GX_CULL_BACK);
 
-    m_displayListSize = GX_EndDispList();
-    realloc(m_pDispList, m_displayListSize);
+    DisplayListArena::End(m_displayList);
 }
 
 
 
 void SkyBox::Render()
 {
-    if ( m_displayListSize > 0 )
+    if ( m_displayList.Size > 0 )
 	{
-        GX_CallDispList(m_pDispList, m_displayListSize);
+        GX_CallDispList(m_displayList.Data, m_displayList.Size);
 	}
 }
 
@@ -22,6 +22,7 @@
 
 #include "../textures/Texture.h"
 #include "../Engine.h"
+#include "../renderer/DisplayListArena.h"
 
 
 class SkyBox {
@@ -35,8 +36,7 @@ public:
 private:
 	void CreateSkyBox();    
     Texture* m_pSkyBoxTextures[6];
-	uint32_t m_displayListSize = 0;
-    void* m_pDispList = nullptr;
+    DisplayListHandle m_displayList;
 
 };
 
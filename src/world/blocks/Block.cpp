@@ -17,6 +17,7 @@
  *
 ***/
 
+#include <algorithm>
 #include "Block.h"
 
 Block::Block() {
@@ -24,9 +25,9 @@ Block::Block() {
 }
 
 
-Block::Block( float size, std::map<const Texture*, std::vector<EBlockFaces>> textureMap ) : m_size(size), m_textureMap(textureMap)
+Block::Block( float size, const EBlockTile faceTiles[6] ) : m_size(size)
 {
-
+    std::copy(faceTiles, faceTiles + 6, m_faceTiles);
 }
 
 Block::~Block() {
@@ -34,9 +35,9 @@ Block::~Block() {
 }
 
 
-const std::map<const Texture*, std::vector<EBlockFaces>>& Block::GetTextures() const
+EBlockTile Block::GetTile(EBlockFaces face) const
 {
-    return m_textureMap;
+    return m_faceTiles[face];
 }
 
 float Block::GetSize() const
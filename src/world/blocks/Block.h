@@ -20,9 +20,7 @@
 #ifndef _BLOCK_H_
 #define _BLOCK_H_
 
-#include <vector>
-#include <map>
-#include "../../textures/Texture.h"
+#include "../../textures/BlockAtlasLayout.h"
 
 enum EBlockFaces
 {
@@ -37,14 +35,15 @@ enum EBlockFaces
 class Block {
 public:
     Block();
-    Block( float size, std::map<const Texture*, std::vector<EBlockFaces>> textureMap);
+    Block( float size, const EBlockTile faceTiles[6]);
     virtual ~Block();
 	float GetSize() const;
-    const std::map<const Texture*, std::vector<EBlockFaces>>& GetTextures() const;
+    // tile of the block texture atlas drawn on the face
+    EBlockTile GetTile(EBlockFaces face) const;
 
 protected:
 	float m_size; // the size from the middle point to each axis   
-    std::map<const Texture*, std::vector<EBlockFaces>> m_textureMap;
+    EBlockTile m_faceTiles[6];
 
 };
 
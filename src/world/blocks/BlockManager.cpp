@@ -23,120 +23,36 @@
 #include "../../utils/Vector3.h"
 #include "../../utils/Debug.h"
 
-#include "Dirt_tpl.h"
-#include "Grass_tpl.h"
-#include "Grass_Side_tpl.h"
-#include "Stone_tpl.h"
-#include "Wood_tpl.h"
-#include "Leaf_tpl.h"
-#include "Tree_tpl.h"
+#include "BlockAtlas_tpl.h"
+
+// atlas tile of every face of a block type in EBlockFaces order: left, right, front, back, top, bottom
+static const EBlockTile s_blockFaceTiles[][6] =
+{
+    // air, never drawn
+    { EBlockTile::Dirt,      EBlockTile::Dirt,      EBlockTile::Dirt,      EBlockTile::Dirt,      EBlockTile::Dirt,  EBlockTile::Dirt  },
+    // dirt
+    { EBlockTile::Dirt,      EBlockTile::Dirt,      EBlockTile::Dirt,      EBlockTile::Dirt,      EBlockTile::Dirt,  EBlockTile::Dirt  },
+    // grass
+    { EBlockTile::GrassSide, EBlockTile::GrassSide, EBlockTile::GrassSide, EBlockTile::GrassSide, EBlockTile::Grass, EBlockTile::Dirt  },
+    // stone
+    { EBlockTile::Stone,     EBlockTile::Stone,     EBlockTile::Stone,     EBlockTile::Stone,     EBlockTile::Stone, EBlockTile::Stone },
+    // wood
+    { EBlockTile::Wood,      EBlockTile::Wood,      EBlockTile::Wood,      EBlockTile::Wood,      EBlockTile::Tree,  EBlockTile::Tree  },
+    // leaf
+    { EBlockTile::Leaf,      EBlockTile::Leaf,      EBlockTile::Leaf,      EBlockTile::Leaf,      EBlockTile::Leaf,  EBlockTile::Leaf  }
+};
+
+static_assert(sizeof(s_blockFaceTiles) / sizeof(s_blockFaceTiles[0]) == static_cast<size_t>(BlockType::LEAF) + 1, "every block type needs its tiles");
 
 void BlockManager::LoadBlocks()
 {
-    const Texture* pDirtTexture       =    AddToTextureList(Texture::Create(Dirt_tpl, Dirt_tpl_size ));
-    const Texture* pGrassTexture      =    AddToTextureList(Texture::Create(Grass_tpl, Grass_tpl_size ));
-    const Texture* pGrassSideTexture  =    AddToTextureList(Texture::Create(Grass_Side_tpl, Grass_Side_tpl_size ));
-    const Texture* pStoneTexture      =    AddToTextureList(Texture::Create(Stone_tpl, Stone_tpl_size));
-    const Texture* pWoodTexture       =    AddToTextureList(Texture::Create(Wood_tpl, Wood_tpl_size ));
-    const Texture* pLeafTexture       =    AddToTextureList( Texture::Create(Leaf_tpl, Leaf_tpl_size ));
-    const Texture* pTreeTexture       =    AddToTextureList(Texture::Create(Tree_tpl, Tree_tpl_size ));
-
-    std::map<const Texture*, std::vector<EBlockFaces>> dirtTextureMap =
-    {
-        {
-          pDirtTexture,
-          {
-              EBlockFaces::Left,
-              EBlockFaces::Right,
-              EBlockFaces::Front,
-              EBlockFaces::Back,
-              EBlockFaces::Top,
-              EBlockFaces::Bottom,
-          }
-        }
-    };
-
-    std::map<const Texture*, std::vector<EBlockFaces>> stoneTextureMap =
-    {
-        {
-          pStoneTexture,
-          {
-              EBlockFaces::Left,
-              EBlockFaces::Right,
-              EBlockFaces::Front,
-              EBlockFaces::Back,
-              EBlockFaces::Top,
-              EBlockFaces::Bottom,
-          }
-        }
-    };
-
-    std::map<const Texture*, std::vector<EBlockFaces>> leafTextureMap =
-    {
-        {
-          pLeafTexture,
-          {
-              EBlockFaces::Left,
-              EBlockFaces::Right,
-              EBlockFaces::Front,
-              EBlockFaces::Back,
-              EBlockFaces::Top,
-              EBlockFaces::Bottom,
-          }
-        }
-    };
-
-    std::map<const Texture*, std::vector<EBlockFaces>> grassTextureMap =
-    {
-        {
-            pGrassTexture,
-            {
-                  EBlockFaces::Top
-            }
-        },
-        {
-            pDirtTexture,
-            {
-                  EBlockFaces::Bottom
-            }
-        },
-        {
-            pGrassSideTexture,
-            {
-                EBlockFaces::Left,
-                EBlockFaces::Right,
-                EBlockFaces::Front,
-                EBlockFaces::Back
-            }
-        }
-    };
-
-    std::map<const Texture*, std::vector<EBlockFaces>> woodTextureMap =
+    // all block textures are packed into one atlas at build time, see tools/texconv
+    m_pAtlas = Texture::Create(BlockAtlas_tpl, BlockAtlas_tpl_size);
+
+    for (uint32_t type = 0; type <= static_cast<uint32_t>(BlockType::LEAF); ++type)
     {
-        {
-            pTreeTexture,
-            {
-                  EBlockFaces::Top,
-                  EBlockFaces::Bottom
-            }
-        },
-        {
-            pWoodTexture,
-            {
-                EBlockFaces::Left,
-                EBlockFaces::Right,
-                EBlockFaces::Front,
-                EBlockFaces::Back
-            }
-        }
-    };
-
-    m_blocks.insert(std::pair< BlockType, Block* >( BlockType::AIR, new Block( BLOCK_SIZE_HALF, {}))); // no texture for air!
-    m_blocks.insert(std::pair< BlockType, Block* >( BlockType::DIRT, new Block( BLOCK_SIZE_HALF, dirtTextureMap )));
-    m_blocks.insert(std::pair< BlockType, Block* >( BlockType::GRASS, new Block( BLOCK_SIZE_HALF, grassTextureMap)));
-    m_blocks.insert(std::pair< BlockType, Block* >( BlockType::STONE, new Block( BLOCK_SIZE_HALF, stoneTextureMap)));
-    m_blocks.insert(std::pair< BlockType, Block* >( BlockType::WOOD, new Block( BLOCK_SIZE_HALF, woodTextureMap)));
-    m_blocks.insert(std::pair< BlockType, Block* >( BlockType::LEAF, new Block( BLOCK_SIZE_HALF, leafTextureMap)));
+        m_blocks.insert(std::pair< BlockType, Block* >( static_cast<BlockType>(type), new Block( BLOCK_SIZE_HALF, s_blockFaceTiles[type])));
+    }
 }
 
 void BlockManager::UnloadBlocks()
@@ -148,10 +64,8 @@ void BlockManager::UnloadBlocks()
 
 	m_blocks.clear();
 
-    for (auto texture : m_textures)
-    {
-        delete texture;
-    }
+    delete m_pAtlas;
+    m_pAtlas = nullptr;
 }
 
 
@@ -171,8 +85,7 @@ Block* BlockManager::GetBlockByType(const BlockType type)
     return nullptr;
 }
 
-const Texture* BlockManager::AddToTextureList(const Texture *texture)
+const Texture& BlockManager::GetAtlas() const
 {
-    m_textures.push_back(texture);
-    return texture;
+    return *m_pAtlas;
 }
@@ -23,22 +23,10 @@
 #include <map>
 #include <vector>
 #include "Block.h"
+#include "BlockType.h"
 #include "../../renderer/BlockRenderer.h"
 #include "../../utils/Vector3.h"
 
-#define BLOCK_SIZE_HALF .25f
-#define BLOCK_SIZE BLOCK_SIZE_HALF * 2
-
-enum class BlockType : unsigned char {
-
-    AIR     = 0,
-    DIRT    = 1,
-    GRASS   = 2,
-    STONE   = 3,
-    WOOD    = 4,
-    LEAF    = 5
-};
-
 class BlockManager {
 public:
     BlockManager();
@@ -48,13 +36,14 @@ public:
 
 	Block* GetBlockByType(const BlockType type);
 
-private:
+    // the texture of all blocks, chunks select the tile of a face with MasterRenderer::SelectBlockTile
+    const Texture& GetAtlas() const;
 
-    const Texture* AddToTextureList(const Texture* texture);
+private:
 
 	std::map<BlockType, Block*> m_blocks;
 	std::map<BlockType, std::vector<Vector3*> > m_mBlockRenderList;
-    std::vector<const Texture*> m_textures;
+    Texture* m_pAtlas = nullptr;
 	BlockRenderer* m_blockRenderer;
 
 };
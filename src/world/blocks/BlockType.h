@@ -0,0 +1,37 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#ifndef _BLOCKTYPE_H_
+#define _BLOCKTYPE_H_
+
+// the block types and sizes without the block renderer, so the chunk data can be used without the GPU
+#define BLOCK_SIZE_HALF .25f
+#define BLOCK_SIZE BLOCK_SIZE_HALF * 2
+
+enum class BlockType : unsigned char {
+
+    AIR     = 0,
+    DIRT    = 1,
+    GRASS   = 2,
+    STONE   = 3,
+    WOOD    = 4,
+    LEAF    = 5
+};
+
+#endif /* _BLOCKTYPE_H_ */
@@ -19,14 +19,38 @@
 
 
 #include <sstream>
+#include <algorithm>
 #include "Chunk.h"
-#include "../PerlinNoise.h"
+#include "ChunkGenerator.h"
+#include "ChunkMesher.h"
+#include "ChunkSnapshot.h"
 #include "../../utils/MathHelper.h"
 #include "../../renderer/MasterRenderer.h"
 #include "../../renderer/BlockRenderer.h"
 #include "../../utils/Debug.h"
 
-Chunk::Chunk(class GameWorld& gameWorld) : m_bIsDirty(false)
+namespace
+{
+    // reads the live blocks of a chunk and the border of its neighbors, main thread only
+    struct LiveBlockAccess
+    {
+        const Chunk* Center;
+        const Chunk* Neighbors[CHUNK_NEIGHBOR_COUNT];
+
+        BlockType Get(int32_t x, int32_t y, int32_t z) const
+        {
+            const Chunk* chunk = Center;
+            if (x < 0)                  { chunk = Neighbors[EBlockFaces::Left];  x += CHUNK_SIZE_X; }
+            else if (x >= CHUNK_SIZE_X) { chunk = Neighbors[EBlockFaces::Right]; x -= CHUNK_SIZE_X; }
+            else if (z >= CHUNK_SIZE_Z) { chunk = Neighbors[EBlockFaces::Front]; z -= CHUNK_SIZE_Z; }
+            else if (z < 0)             { chunk = Neighbors[EBlockFaces::Back];  z += CHUNK_SIZE_Z; }
+
+            return chunk ? chunk->GetBlock(x, y, z) : CHUNK_SNAPSHOT_MISSING_BLOCK;
+        }
+    };
+}
+
+Chunk::Chunk(class GameWorld& gameWorld)
 {
 	m_pWorldManager = &gameWorld;
 }
@@ -34,139 +58,87 @@ Chunk::Chunk(class GameWorld& gameWorld) : m_bIsDirty(false)
 Chunk::~Chunk()
 {
     Clear();
-
-    for (int x = 0; x < CHUNK_SIZE_X; ++x)
-    {
-        for (int y = 0; y < CHUNK_SIZE_Y; ++y)
-        {
-            delete [] m_blocks[x][y];
-        }
-
-        delete [] m_blocks[x];
-    }
-    delete [] m_blocks;
 }
 
 void Chunk::Init()
 {
-    m_blocks = new BlockType**[CHUNK_SIZE_X];
-	for (uint32_t x = 0; x < CHUNK_SIZE_X; x++)
-	{
-        m_blocks[x] = new BlockType*[CHUNK_SIZE_Y];
-
-		for (uint32_t y = 0; y < CHUNK_SIZE_Y; y++)
-        {
-            m_blocks[x][y] = new BlockType[CHUNK_SIZE_Z];
-		}
-	}
+    m_blocks.Fill(BlockType::AIR);
 }
 
-void Chunk::Build()
+void Chunk::Build(ChunkSections& blocks)
 {
-    PerlinNoise pn = m_pWorldManager->GetNoise();
+    ChunkGenerator::Generate(m_pWorldManager->GetNoise(), m_coord, blocks);
+}
 
-    for ( uint32_t x = 0; x < CHUNK_SIZE_X; x++)
+void Chunk::SetLoadedBlocks(ChunkSections&& blocks, uint32_t generation)
+{
+    m_mutex.Lock();
+    if (generation == m_generation)
     {
-        for ( uint32_t z = 0; z < CHUNK_SIZE_Z; z++)
-        {
-            for ( uint32_t y = 0; y < CHUNK_SIZE_Y; y++)
-            {
-                m_blocks[x][y][z] = BlockType::AIR;
-            }
+        m_loadedBlocks = std::move(blocks);
+        m_loadedGeneration = generation;
+        m_bBlocksLoaded = true;
+    }
+    m_mutex.Unlock();
+}
 
-            double xWorld, zWorld;
-            xWorld = (m_centerPosition.GetX() - (CHUNK_BLOCK_SIZE_X / 2) + (x * BLOCK_SIZE));
-            zWorld = (m_centerPosition.GetZ() - (CHUNK_BLOCK_SIZE_Z / 2) + (z * BLOCK_SIZE));
+bool Chunk::CommitLoadedBlocks()
+{
+    m_mutex.Lock();
+    bool bCommit = m_bBlocksLoaded && m_loadedGeneration == m_generation;
+    m_bBlocksLoaded = false;
+    m_mutex.Unlock();
 
-            double noise = pn.GetHeight(xWorld, zWorld);
-            uint32_t height = (uint32_t) MathHelper::Clamp((CHUNK_SIZE_Y * noise) + CHUNK_MIN_GROUND, CHUNK_MIN_GROUND, CHUNK_SIZE_Y);
+    if (!bCommit)
+        return false;
 
-            for (uint32_t y = 0; y < height; y++)
-            {
-                if ( y == height - 1 )
-                {
-                    m_blocks[x][y][z] = BlockType::GRASS;
-                }
-                else if (y <= STONE_LEVEL )
-                {
-                    m_blocks[x][y][z] = BlockType::STONE;
-                }
-                else
-                {
-                    m_blocks[x][y][z] = BlockType::DIRT;
-                }
-            }
-        }
-    }
+    std::swap(m_blocks, m_loadedBlocks);
+    m_bOccludersDirty = true;
 
-    CreateTrees();
-}
+    // release the packed indices of the old sections
+    m_loadedBlocks.Fill(BlockType::AIR);
+    SetLoaded(true);
 
+    // the border faces of the neighbors depend on the new blocks
+    Chunk* neighbors[4] = { m_pChunkLeft, m_pChunkRight, m_pChunkFront, m_pChunkBack };
+    for (Chunk* neighbor : neighbors)
+    {
+        if (neighbor && neighbor->IsLoaded())
+            neighbor->SetDirty(true);
+    }
 
+    return true;
+}
 
-void Chunk::Clear()
+void Chunk::SetBlock(uint32_t x, uint32_t y, uint32_t z, BlockType type)
 {
-    DeleteDisplayList();
-    ClearBlockRenderList();
+    m_blocks.Set(x, y, z, type);
+    m_bOccludersDirty = true;
 }
 
-void Chunk::CreateTrees()
+uint32_t Chunk::GetBlockMemoryUsage() const
 {
-    //srand (time(NULL));
-    uint32_t x = 6;//2 + (rand() % (CHUNK_SIZE_X - 4)); // value range 2 - 14
-    //srand (time(NULL));
-    uint32_t z = 8;// + (rand() % (CHUNK_SIZE_Z - 4));
-
-    double xWorld = (m_centerPosition.GetX() - (CHUNK_BLOCK_SIZE_X / 2) + (x * BLOCK_SIZE));
-    double zWorld = (m_centerPosition.GetZ() - (CHUNK_BLOCK_SIZE_Z / 2) + (z * BLOCK_SIZE));
+    return m_blocks.GetMemoryUsage();
+}
 
-    double noise = m_pWorldManager->GetNoise().GetHeight(xWorld, zWorld);
 
-    uint32_t y = (uint32_t) MathHelper::Clamp((CHUNK_SIZE_Y * noise) + CHUNK_MIN_GROUND, CHUNK_MIN_GROUND, CHUNK_SIZE_Y);
 
-    if ( y < CHUNK_SIZE_Y - TREE_HIGHT)
+void Chunk::Clear()
+{
+    DeleteDisplayList();
+    for (SectionMesh& mesh : m_sectionMeshes)
     {
-        if ( m_blocks[x][y-1][z] == BlockType::GRASS)
-        {
-
-            for (int8_t i = -2; i <= 2; i++)
-            {
-                for (int8_t j = -2; j <= 2; j++)
-                {
-                    m_blocks[x+i][y+3][z+j] = BlockType::LEAF;
-                    m_blocks[x+i][y+4][z+j] = BlockType::LEAF;
-                }
-            }
-
-            for (int8_t i = -1; i <= 1; i++)
-            {
-                for (int8_t j = -1; j <= 1; j++)
-                {
-                    m_blocks[x+i][y+5][z+j] = BlockType::LEAF;
-                    m_blocks[x+i][y+6][z+j] = ((i % 2) == 0) || ((j % 2) == 0) ? (BlockType::LEAF) : (BlockType::AIR);
-                }
-            }
-
-
-            for (uint32_t i = 0; i < 3; i++)
-            {
-                m_blocks[x][y+i][z] = BlockType::WOOD;
-            }
-        }
+        ClearBlockRenderList(mesh);
+        mesh.HasRenderList = false;
     }
 }
 
 void Chunk::SetChunkNeighbors()
 {
-    Vector3 leftChunkPos(m_centerPosition.GetX() - CHUNK_BLOCK_SIZE_X, m_centerPosition.GetY(), m_centerPosition.GetZ());
-    Vector3 rightChunkPos(m_centerPosition.GetX() + CHUNK_BLOCK_SIZE_X, m_centerPosition.GetY(), m_centerPosition.GetZ());
-    Vector3 frontChunkPos(m_centerPosition.GetX(), m_centerPosition.GetY(), m_centerPosition.GetZ() + CHUNK_BLOCK_SIZE_Z);
-    Vector3 backChunkPos(m_centerPosition.GetX(), m_centerPosition.GetY(), m_centerPosition.GetZ() - CHUNK_BLOCK_SIZE_X);
-
-    m_pChunkLeft  =  m_pWorldManager->GetCashedChunkAt(leftChunkPos);
-    m_pChunkRight =  m_pWorldManager->GetCashedChunkAt(rightChunkPos);
-    m_pChunkFront =  m_pWorldManager->GetCashedChunkAt(frontChunkPos);
-    m_pChunkBack  =  m_pWorldManager->GetCashedChunkAt(backChunkPos);
+    m_pChunkLeft  =  m_pWorldManager->GetCashedChunkAt(ChunkCoord { m_coord.X - 1, m_coord.Z });
+    m_pChunkRight =  m_pWorldManager->GetCashedChunkAt(ChunkCoord { m_coord.X + 1, m_coord.Z });
+    m_pChunkFront =  m_pWorldManager->GetCashedChunkAt(ChunkCoord { m_coord.X, m_coord.Z + 1 });
+    m_pChunkBack  =  m_pWorldManager->GetCashedChunkAt(ChunkCoord { m_coord.X, m_coord.Z - 1 });
 }
 
 bool Chunk::NeighborsLoaded()
@@ -186,232 +158,245 @@ bool Chunk::NeighborsLoaded()
     return false;
 }
 
-void Chunk::Render()
+bool Chunk::GetRenderBounds(CullBox& box) const
 {
-    if ( m_displayListSize > 0 )
-	{
-        GX_CallDispList(m_pDispList, m_displayListSize);
+    if ( !HasDisplayList() )
+        return false;
+
+    // the box only spans the sections with geometry, most of the upper sections are air
+    uint32_t lowestSection = CHUNK_SECTION_COUNT;
+    uint32_t highestSection = 0;
+    for (uint32_t section = 0; section < CHUNK_SECTION_COUNT; ++section)
+    {
+        if (m_sectionMeshes[section].DisplayList.Size > 0)
+        {
+            lowestSection = std::min(lowestSection, section);
+            highestSection = section;
+        }
     }
+
+    if (lowestSection == CHUNK_SECTION_COUNT)
+        return false;
+
+    const Vector3& origin = LocalPositionToGlobalPosition(Vec3i{ 0, 0, 0 });
+    box.Bounds[0] = origin.GetX() - BLOCK_SIZE_HALF;
+    box.Bounds[1] = origin.GetY() - BLOCK_SIZE_HALF + lowestSection * CHUNK_SECTION_SIZE * BLOCK_SIZE;
+    box.Bounds[2] = origin.GetZ() - BLOCK_SIZE_HALF;
+    box.Bounds[3] = box.Bounds[0] + CHUNK_BLOCK_SIZE_X;
+    box.Bounds[4] = origin.GetY() - BLOCK_SIZE_HALF + (highestSection + 1) * CHUNK_SECTION_SIZE * BLOCK_SIZE;
+    box.Bounds[5] = box.Bounds[2] + CHUNK_BLOCK_SIZE_Z;
+    return true;
 }
 
-bool Chunk::AddBlockToRenderList(BlockType type, const BlockRenderVO& blockRenderVO)
+uint32_t Chunk::GetOccluders(CullBox occluders[CHUNK_OCCLUDER_COUNT])
 {
-	bool bSuccessful = false;
-	auto blockRenderListIt = m_mBlockRenderList.find(type);
-	if (blockRenderListIt != m_mBlockRenderList.end())
-	{
-        blockRenderListIt->second.emplace_back(blockRenderVO);
-		bSuccessful = true;
-	}
-	else
-	{
-        std::vector<BlockRenderVO> blockList;
-        blockList.emplace_back(blockRenderVO);
-        m_mBlockRenderList.insert(std::pair<BlockType, std::vector<BlockRenderVO> >(type, blockList ));
-		bSuccessful = true;
-	}
+    const uint32_t cellSize = CHUNK_SIZE_X / CHUNK_OCCLUDER_CELLS;
+    if (m_bOccludersDirty)
+    {
+        std::fill(m_occluderHeights, m_occluderHeights + CHUNK_OCCLUDER_COUNT, CHUNK_SIZE_Y);
+        for (uint32_t x = 0; x < CHUNK_SIZE_X; ++x)
+        {
+            for (uint32_t z = 0; z < CHUNK_SIZE_Z; ++z)
+            {
+                uint8_t& height = m_occluderHeights[(x / cellSize) * CHUNK_OCCLUDER_CELLS + z / cellSize];
+                height = std::min<uint8_t>(height, m_blocks.GetSolidHeight(x, z));
+            }
+        }
+        m_bOccludersDirty = false;
+    }
 
-	return bSuccessful;
+    const Vector3& origin = LocalPositionToGlobalPosition(Vec3i{ 0, 0, 0 });
+    uint32_t count = 0;
+    for (uint32_t cell = 0; cell < CHUNK_OCCLUDER_COUNT; ++cell)
+    {
+        if (m_occluderHeights[cell] == 0)
+            continue;
+
+        CullBox& box = occluders[count++];
+        box.Bounds[0] = origin.GetX() - BLOCK_SIZE_HALF + (cell / CHUNK_OCCLUDER_CELLS) * cellSize * BLOCK_SIZE;
+        box.Bounds[1] = origin.GetY() - BLOCK_SIZE_HALF;
+        box.Bounds[2] = origin.GetZ() - BLOCK_SIZE_HALF + (cell % CHUNK_OCCLUDER_CELLS) * cellSize * BLOCK_SIZE;
+        box.Bounds[3] = box.Bounds[0] + cellSize * BLOCK_SIZE;
+        box.Bounds[4] = box.Bounds[1] + m_occluderHeights[cell] * BLOCK_SIZE;
+        box.Bounds[5] = box.Bounds[2] + cellSize * BLOCK_SIZE;
+    }
+
+    return count;
 }
 
-bool Chunk::IsBlockVisible(uint32_t iX, uint32_t iY, uint32_t iZ, BlockRenderVO& blockRenderVO)
+uint16_t Chunk::GetSectionConnectivity(uint32_t section) const
 {
-    bool bIsAir = m_blocks[iX][iY][iZ] == BlockType::AIR;
+    return m_sectionMeshes[section].Connectivity;
+}
 
-	if ( iX == 0 )
-	{
-		if (bIsAir)
-		{
-            if ( !m_bNeighbourUpdate && m_pChunkLeft && m_pChunkLeft->m_blocks[CHUNK_SIZE_X -1][iY][iZ] != BlockType::AIR)
-			{
-				m_pChunkLeft->SetDirty(true); //rebuild neighbour
-				m_pChunkLeft->m_bNeighbourUpdate = true;
-			}
-		}
-        else if ( /*!m_pChunkLeft || */(m_pChunkLeft && m_pChunkLeft->m_blocks[CHUNK_SIZE_X -1][iY][iZ] == BlockType::AIR))
-		{
-            blockRenderVO.FaceMask |= LEFT_FACE;
-            blockRenderVO.Faces++;
-		}
-	}
+void Chunk::Render(const FrustumCuller& culler, const Vector3& cameraPosition, uint8_t planeMask, uint8_t sectionMask, ChunkRenderStats& stats)
+{
+    // the display lists hold block corners relative to the min corner of the chunk
+    const Vector3& origin = LocalPositionToGlobalPosition(Vec3i{ 0, 0, 0 });
+    const float minY = origin.GetY() - BLOCK_SIZE_HALF;
+    const float sectionHeight = CHUNK_SECTION_SIZE * BLOCK_SIZE;
+    MasterRenderer::LoadChunkMatrix(origin.GetX() - BLOCK_SIZE_HALF, minY, origin.GetZ() - BLOCK_SIZE_HALF, BLOCK_SIZE);
 
-	if ( iX == CHUNK_SIZE_X -1 )
-	{
-		if (bIsAir)
-		{
-            if ( !m_bNeighbourUpdate && m_pChunkRight && m_pChunkRight->m_blocks[0][iY][iZ] != BlockType::AIR)
-			{
-				m_pChunkRight->SetDirty(true); //rebuild neighbour
-				m_pChunkRight->m_bNeighbourUpdate = true;
-			}
-		}
-        else if ( /*!m_pChunkRight || */(m_pChunkRight && m_pChunkRight->m_blocks[0][iY][iZ] == BlockType::AIR))
-		{
-            blockRenderVO.FaceMask |= RIGHT_FACE;
-            blockRenderVO.Faces++;
-		}
-	}
+    CullBox sectionBox;
+    sectionBox.Bounds[0] = origin.GetX() - BLOCK_SIZE_HALF;
+    sectionBox.Bounds[2] = origin.GetZ() - BLOCK_SIZE_HALF;
+    sectionBox.Bounds[3] = sectionBox.Bounds[0] + CHUNK_BLOCK_SIZE_X;
+    sectionBox.Bounds[5] = sectionBox.Bounds[2] + CHUNK_BLOCK_SIZE_Z;
 
-	if ( iZ == 0 )
-	{
-		if (bIsAir)
-		{
-            if ( !m_bNeighbourUpdate && m_pChunkBack && m_pChunkBack->m_blocks[iX][iY][CHUNK_SIZE_Z -1] != BlockType::AIR)
-			{
-				m_pChunkBack->SetDirty(true); //rebuild neighbour
-				m_pChunkBack->m_bNeighbourUpdate = true;
-			}
-		}
-        else if (/*!m_pChunkBack || */(m_pChunkBack && m_pChunkBack->m_blocks[iX][iY][CHUNK_SIZE_Z -1] == BlockType::AIR))
-		{
-            blockRenderVO.FaceMask |= BACK_FACE;
-            blockRenderVO.Faces++;
-		}
-	}
+    // the atlas is loaded when the first section is drawn
+    bool bAtlasLoaded = false;
 
-	if (iZ == CHUNK_SIZE_Z -1 )
-	{
-		if (bIsAir)
-		{
-            if ( !m_bNeighbourUpdate && m_pChunkFront && m_pChunkFront->m_blocks[iX][iY][0] != BlockType::AIR)
-			{
-				m_pChunkFront->SetDirty(true); //rebuild neighbour
-				m_pChunkFront->m_bNeighbourUpdate = true;
-			}
-		}
-        else if ( /*!m_pChunkFront || */(m_pChunkFront && m_pChunkFront->m_blocks[iX][iY][0] == BlockType::AIR))
-		{
-            blockRenderVO.FaceMask |= FRONT_FACE;
-            blockRenderVO.Faces++;
-		}
-	}
+    // a face is front facing if the camera is in front of its plane, all planes of a direction lie inside the box
+    uint8_t sideDirections = 0;
+    if (cameraPosition.GetX() < sectionBox.Bounds[3])
+        sideDirections |= LEFT_FACE;
+    if (cameraPosition.GetX() > sectionBox.Bounds[0])
+        sideDirections |= RIGHT_FACE;
+    if (cameraPosition.GetZ() > sectionBox.Bounds[2])
+        sideDirections |= FRONT_FACE;
+    if (cameraPosition.GetZ() < sectionBox.Bounds[5])
+        sideDirections |= BACK_FACE;
 
-	if ( !bIsAir )
-	{
-		if ( iY == CHUNK_SIZE_Y -1 )
-		{
-            blockRenderVO.FaceMask |= TOP_FACE;
-            blockRenderVO.Faces++;
-		}
-
-		 // Check all 6 block faces if neighbor is air
-        if ( iX + 1 <= CHUNK_SIZE_X -1 && m_blocks[iX + 1][iY][iZ] == BlockType::AIR)
-		{
-            blockRenderVO.FaceMask |= RIGHT_FACE;
-            blockRenderVO.Faces++;
-		}
-
-        if ( iX > 0 && m_blocks[iX - 1][iY][iZ] == BlockType::AIR)
-		{
-            blockRenderVO.FaceMask |= LEFT_FACE;
-            blockRenderVO.Faces++;
-		}
-
-        if ( iY + 1 <= CHUNK_SIZE_Y -1 && m_blocks[iX][iY + 1][iZ] == BlockType::AIR)
-		{
-            blockRenderVO.FaceMask |= TOP_FACE;
-            blockRenderVO.Faces++;
-		}
-
-
-        if (iY > 0 && m_blocks[iX][iY - 1][iZ] == BlockType::AIR)
-		{
-            blockRenderVO.FaceMask |= BOTTOM_FACE;
-            blockRenderVO.Faces++;
-		}
-
-        if ( iZ + 1 <= CHUNK_SIZE_Z -1 && m_blocks[iX][iY][iZ + 1] == BlockType::AIR)
-		{
-            blockRenderVO.FaceMask |= FRONT_FACE;
-            blockRenderVO.Faces++;
-		}
-
-        if ( iZ > 0 && m_blocks[iX][iY][iZ - 1] == BlockType::AIR)
-		{
-            blockRenderVO.FaceMask |= BACK_FACE;
-            blockRenderVO.Faces++;
+    for (uint32_t section = 0; section < CHUNK_SECTION_COUNT; ++section)
+    {
+        SectionMesh& mesh = m_sectionMeshes[section];
+        if (mesh.DisplayList.Size == 0)
+            continue;
+
+        if (!(sectionMask & (1 << section)))
+        {
+            stats.CaveCulledSections++;
+            continue;
         }
-	}
 
-    if (blockRenderVO.Faces > 0)
-    {
-        const Vector3& worldBlockPos = LocalPositionToGlobalPosition(Vec3i{ iX, iY, iZ });
-        blockRenderVO.BlockPosition = Vector3(worldBlockPos.GetX(), worldBlockPos.GetY(), worldBlockPos.GetZ());
-        return true;
-    }
+        sectionBox.Bounds[1] = minY + section * sectionHeight;
+        sectionBox.Bounds[4] = sectionBox.Bounds[1] + sectionHeight;
+        if (planeMask)
+        {
+            uint8_t sectionPlaneMask = planeMask;
+            stats.TestedSections++;
+            stats.BoxTests++;
+            if (culler.TestBox(sectionBox, sectionPlaneMask, mesh.CullPlane) == ECullResult::Outside)
+            {
+                stats.CulledSections++;
+                continue;
+            }
+        }
 
-    return false;
-}
+        if (!bAtlasLoaded)
+        {
+            m_pWorldManager->GetBlockManager().GetAtlas().Bind();
+            stats.TextureLoads++;
+            bAtlasLoaded = true;
+        }
 
-void Chunk::BuildBlockRenderList()
-{
-    m_amountOfBlocks = 0;
-    m_amountOfFaces = 0;
+        uint8_t directions = sideDirections;
+        if (cameraPosition.GetY() > sectionBox.Bounds[1])
+            directions |= TOP_FACE;
+        if (cameraPosition.GetY() < sectionBox.Bounds[4])
+            directions |= BOTTOM_FACE;
 
-	for ( uint32_t x = 0; x < CHUNK_SIZE_X; x++)
-	{
-		for ( uint32_t y = 0; y < CHUNK_SIZE_Y; y++ )
-		{
-			for ( uint32_t z = 0; z < CHUNK_SIZE_Z; z++)
-			{                
-                BlockRenderVO renderVO;
-                if ( IsBlockVisible(x, y, z, renderVO))
-				{
-                    AddBlockToRenderList(m_blocks[x][y][z], renderVO);
-                    m_amountOfBlocks++;
-                    m_amountOfFaces += renderVO.Faces;
-                }
-			}
-		}
-	}
+        // neighboring parts are drawn with one call
+        uint32_t callStart = 0;
+        uint32_t callEnd = 0;
+        for (uint8_t face = EBlockFaces::Left; face <= EBlockFaces::Bottom; ++face)
+        {
+            if (!(directions & (1 << face)))
+                continue;
+
+            const uint32_t partStart = face > EBlockFaces::Left ? mesh.FaceListEnds[face - 1] : 0;
+            if (partStart != callEnd)
+            {
+                if (callEnd > callStart)
+                    GX_CallDispList(static_cast<uint8_t*>(mesh.DisplayList.Data) + callStart, callEnd - callStart);
+                stats.DisplayListBytes += callEnd - callStart;
+                callStart = partStart;
+            }
+
+            callEnd = mesh.FaceListEnds[face];
+            stats.SubmittedQuads += mesh.FaceListQuads[face];
+            stats.TileSelects += mesh.FaceListTiles[face];
+        }
+
+        if (callEnd > callStart)
+            GX_CallDispList(static_cast<uint8_t*>(mesh.DisplayList.Data) + callStart, callEnd - callStart);
+        stats.DisplayListBytes += callEnd - callStart;
+        stats.VisibleFaces += mesh.VisibleFaces;
+        stats.Quads += mesh.Faces;
+    }
 }
 
-void Chunk::ClearBlockRenderList()
+void Chunk::ClearBlockRenderList(SectionMesh& mesh)
 {
-	m_mBlockRenderList.clear();
+	mesh.BlockRenderList.clear();
+	mesh.BlockQuadList.clear();
 }
 
 
-void Chunk::CreateDisplayList(size_t sizeOfDisplayList)
+
+bool Chunk::IsDirty()
 {
-    m_pDispList = memalign(32, sizeOfDisplayList);
-    memset(m_pDispList, 0, sizeOfDisplayList);
-    DCInvalidateRange(m_pDispList, sizeOfDisplayList);
-    GX_BeginDispList(m_pDispList, sizeOfDisplayList);
+    m_mutex.Lock();
+    bool bDirty = m_dirtySections != 0;
+    m_mutex.Unlock();
+    return bDirty;
 }
 
-void Chunk::FinishDisplayList()
+void Chunk::SetDirty(bool dirty)
 {
-    m_displayListSize = GX_EndDispList();
-    m_bIsDirty = false;
-    // Update display list size to the size returned by GX_EndDispList() to save memory
-    realloc(m_pDispList, m_displayListSize);
+    m_mutex.Lock();
+    m_dirtySections = dirty ? (1u << CHUNK_SECTION_COUNT) - 1 : 0;
+    m_mutex.Unlock();
 }
 
-
-bool Chunk::IsDirty() const
+void Chunk::SetSectionDirty(uint32_t section)
 {
-    return m_bIsDirty;
+    m_mutex.Lock();
+    m_dirtySections |= 1u << section;
+    m_mutex.Unlock();
 }
 
-void Chunk::SetDirty(bool dirty)
+bool Chunk::HasDisplayList() const
 {
-    m_bIsDirty = dirty;
+    for (const SectionMesh& mesh : m_sectionMeshes)
+    {
+        if (mesh.DisplayList.Data)
+            return true;
+    }
+
+    return false;
 }
 
 uint32_t Chunk::GetDisplayListSize() const
 {
-    return m_displayListSize;
+    uint32_t size = 0;
+    for (const SectionMesh& mesh : m_sectionMeshes)
+        size += mesh.DisplayList.Size;
+    return size;
 }
 
 uint64_t Chunk::GetAmountOfBlocks() const
 {
-    return m_amountOfBlocks;
+    uint64_t blocks = 0;
+    for (const SectionMesh& mesh : m_sectionMeshes)
+        blocks += mesh.Blocks;
+    return blocks;
 }
 
 uint64_t Chunk::GetAmountOfFaces() const
 {
-    return m_amountOfFaces;
+    uint64_t faces = 0;
+    for (const SectionMesh& mesh : m_sectionMeshes)
+        faces += mesh.Faces;
+    return faces;
+}
+
+uint64_t Chunk::GetAmountOfVisibleFaces() const
+{
+    uint64_t faces = 0;
+    for (const SectionMesh& mesh : m_sectionMeshes)
+        faces += mesh.VisibleFaces;
+    return faces;
 }
 
 const Vector3& Chunk::GetCenterPosition() const
@@ -419,50 +404,225 @@ const Vector3& Chunk::GetCenterPosition() const
     return m_centerPosition;
 }
 
+const ChunkCoord& Chunk::GetChunkCoord() const
+{
+    return m_coord;
+}
+
 void Chunk::DeleteDisplayList()
 {
-    if ( m_displayListSize > 0 )
+    // nothing is known about the sections until they are meshed again
+    for (SectionMesh& mesh : m_sectionMeshes)
+    {
+        mesh.Connectivity = SECTION_ALL_CONNECTED;
+    }
+
+    if ( HasDisplayList() )
 	{
-        free(m_pDispList);
-        m_displayListSize = 0;
-        m_pDispList = nullptr;
-        m_bIsDirty = true;
+        for (SectionMesh& mesh : m_sectionMeshes)
+        {
+            ReleaseDisplayList(mesh);
+        }
+
+        SetDirty(true);
 	}
 }
 
-void Chunk::RebuildDisplayList()
+void Chunk::ReleaseDisplayList(SectionMesh& mesh)
 {
-	BlockRenderer blockRenderer;
+    DisplayListArena::Release(mesh.DisplayList);
+}
 
-	ClearBlockRenderList();        
-	BuildBlockRenderList();    
+std::shared_ptr<const ChunkSnapshot> Chunk::CreateMeshSnapshot() const
+{
+    const Chunk* neighbors[CHUNK_NEIGHBOR_COUNT] = { m_pChunkLeft, m_pChunkRight, m_pChunkFront, m_pChunkBack };
+    const ChunkSections* neighborBlocks[CHUNK_NEIGHBOR_COUNT];
+    for (uint32_t i = 0; i < CHUNK_NEIGHBOR_COUNT; ++i)
+    {
+        neighborBlocks[i] = neighbors[i] ? &neighbors[i]->m_blocks : nullptr;
+    }
 
-	DeleteDisplayList();
-    CreateDisplayList( MasterRenderer::GetDisplayListSizeForFaces(m_amountOfFaces) );
+    return std::make_shared<const ChunkSnapshot>(m_blocks, neighborBlocks, m_meshSections);
+}
 
-    for(auto it = m_mBlockRenderList.begin(); it != m_mBlockRenderList.end(); ++it)
-	{
-        Block* pBlockToRender = m_pWorldManager->GetBlockManager().GetBlockByType(it->first);
-        blockRenderer.Prepare( &it->second, *pBlockToRender);
-        blockRenderer.Draw();
-	}
+void Chunk::BuildMesh(const ChunkSnapshot& snapshot, uint32_t generation)
+{
+#ifdef DEBUG
+    const uint64_t startTime = gettime();
+#endif
+
+    const EMeshingMode meshingMode = m_pWorldManager->GetMeshingMode();
+    std::vector<uint8_t> faceMasks;
+    uint32_t meshedSections = 0;
+
+    for (uint32_t section = 0; section < CHUNK_SECTION_COUNT; ++section)
+    {
+        if (!(m_meshSections & (1u << section)))
+            continue;
+
+        SectionMesh& mesh = m_sectionMeshes[section];
+        ClearBlockRenderList(mesh);
+        mesh.HasRenderList = false;
+        mesh.Blocks = 0;
+        mesh.Faces = 0;
+        mesh.VisibleFaces = 0;
+
+        // air has no faces, and a solid section surrounded by solid sections has no visible faces
+        ESectionState state = snapshot.GetState(section);
+        mesh.MeshedConnectivity = state == ESectionState::Air ? SECTION_ALL_CONNECTED : SectionConnectivity::Compute(snapshot, section);
+        if (state == ESectionState::Air || (state == ESectionState::Opaque && ChunkMesher::IsSectionBuried(snapshot, section)))
+            continue;
+
+        ChunkMesher::MeshSection(snapshot, section, meshingMode, mesh, faceMasks);
+        meshedSections++;
+    }
+
+#ifdef DEBUG
+    LOG("Chunk %d,%d meshed %u of %u sections in %u us", m_coord.X, m_coord.Z, meshedSections, CHUNK_SECTION_COUNT, ticks_to_microsecs(gettime() - startTime));
+#endif
+
+    m_mutex.Lock();
+    m_meshGeneration = generation;
+    m_meshState = EChunkMeshState::Ready;
+    m_mutex.Unlock();
+}
+
+void Chunk::RecordDisplayList(SectionMesh& mesh, BlockRenderer& blockRenderer)
+{
+    if (mesh.Faces == 0)
+    {
+        ReleaseDisplayList(mesh);
+        return;
+    }
+
+    // the arena keeps only the recorded bytes, the previous list is released when the new one is done.
+    // Every face direction is recorded as its own part, which selects the atlas tiles of its faces again
+    DisplayListArena::Begin(MasterRenderer::GetDisplayListSizeForChunkFaces(mesh.Faces)
+                            + (SECTION_FACE_COUNT - 1) * MasterRenderer::GetDisplayListSizeForChunkFaces(0));
+
+    bool bComplete = true;
+    uint32_t partEnd = 0;
+    for (uint8_t face = EBlockFaces::Left; face <= EBlockFaces::Bottom; ++face)
+    {
+        uint32_t quads = 0;
+        uint8_t tiles = 0;
+        for(auto it = mesh.BlockRenderList.begin(); it != mesh.BlockRenderList.end(); ++it)
+        {
+            Block* pBlockToRender = m_pWorldManager->GetBlockManager().GetBlockByType(it->first);
+            blockRenderer.Prepare( &it->second, *pBlockToRender);
+            const uint32_t drawn = blockRenderer.Draw(static_cast<EBlockFaces>(face));
+            quads += drawn;
+            tiles += drawn > 0;
+        }
+
+        for(auto it = mesh.BlockQuadList.begin(); it != mesh.BlockQuadList.end(); ++it)
+        {
+            Block* pBlockToRender = m_pWorldManager->GetBlockManager().GetBlockByType(it->first);
+            blockRenderer.Prepare( &it->second, *pBlockToRender);
+            const uint32_t drawn = blockRenderer.Draw(static_cast<EBlockFaces>(face));
+            quads += drawn;
+            tiles += drawn > 0;
+        }
+
+        mesh.FaceListQuads[face] = quads;
+        mesh.FaceListTiles[face] = tiles;
+        if (face == EBlockFaces::Bottom)
+            break;
+
+        const uint32_t partSize = DisplayListArena::Split();
+        bComplete &= partSize > 0 || quads == 0;
+        partEnd += partSize;
+        mesh.FaceListEnds[face] = partEnd;
+    }
 
     blockRenderer.Finish();
+    if (!DisplayListArena::End(mesh.DisplayList))
+        return;
+
+    mesh.FaceListEnds[EBlockFaces::Bottom] = mesh.DisplayList.Size;
+    if (!bComplete || (mesh.FaceListQuads[EBlockFaces::Bottom] > 0 && mesh.DisplayList.Size == partEnd))
+    {
+        LOG("Chunk %d,%d: a face direction overflowed the display list", m_coord.X, m_coord.Z);
+        ReleaseDisplayList(mesh);
+    }
+}
+
+bool Chunk::UploadMesh()
+{
+    m_mutex.Lock();
+    bool bStale = m_meshGeneration != m_generation;
+    m_meshState = EChunkMeshState::Idle;
+    m_mutex.Unlock();
+
+    // the chunk was moved while it was meshed
+    if (bStale)
+    {
+        for (SectionMesh& mesh : m_sectionMeshes)
+        {
+            ClearBlockRenderList(mesh);
+            mesh.HasRenderList = false;
+        }
+        return false;
+    }
+
+	BlockRenderer blockRenderer;
+    uint32_t displayListSize = 0;
+
+    for (uint32_t section = 0; section < CHUNK_SECTION_COUNT; ++section)
+    {
+        if (!(m_meshSections & (1u << section)))
+            continue;
+
+        SectionMesh& mesh = m_sectionMeshes[section];
+        RecordDisplayList(mesh, blockRenderer);
+        displayListSize += mesh.DisplayList.Size;
+        mesh.Connectivity = mesh.MeshedConnectivity;
+
+        // greedy quads can not be patched block by block
+        mesh.HasRenderList = m_pWorldManager->GetMeshingMode() == EMeshingMode::PerFace;
+        mesh.BlockQuadList.clear();
+    }
+
+#ifdef DEBUG
+    LOG("Chunk %d,%d rebuilt sections 0x%02x: %u quads, %u display list bytes", m_coord.X, m_coord.Z, m_meshSections, (uint32_t) GetAmountOfFaces(), displayListSize);
+#endif
+
+    return true;
+}
+
+EChunkMeshState Chunk::GetMeshState()
+{
+    m_mutex.Lock();
+    EChunkMeshState state = m_meshState;
+    m_mutex.Unlock();
+    return state;
+}
 
-	FinishDisplayList();
-	ClearBlockRenderList();
+void Chunk::SetMeshQueued()
+{
+    m_mutex.Lock();
+    m_meshState = EChunkMeshState::Queued;
+    m_meshSections = m_dirtySections;
+    m_dirtySections = 0;
+    m_mutex.Unlock();
+}
 
-	m_bNeighbourUpdate = false;
+uint32_t Chunk::GetGeneration()
+{
+    m_mutex.Lock();
+    uint32_t generation = m_generation;
+    m_mutex.Unlock();
+    return generation;
 }
 
 void Chunk::RemoveBlockByWorldPosition(const Vector3& blockPosition)
 {
 	Vec3i vec = GetLocalBlockPositionByWorldPosition(blockPosition);
 
-    if ( m_blocks[vec.X][vec.Y][vec.Z] != BlockType::AIR)
+    if ( GetBlock(vec.X, vec.Y, vec.Z) != BlockType::AIR)
     {
-        m_blocks[vec.X][vec.Y][vec.Z] = BlockType::AIR;
-        BlockListUpdated( BlockChangeData { GetFilePath(), BlockType::AIR, vec, m_centerPosition });
+        SetBlock(vec.X, vec.Y, vec.Z, BlockType::AIR);
+        BlockListUpdated( BlockChangeData { BlockType::AIR, vec, m_coord });
     }
 }
 
@@ -470,22 +630,145 @@ void Chunk::AddBlockByWorldPosition(const Vector3& blockPosition, BlockType type
 {
 	Vec3i vec = GetLocalBlockPositionByWorldPosition(blockPosition);
 
-    if ( m_blocks[vec.X][vec.Y][vec.Z] == BlockType::AIR)
+    if ( GetBlock(vec.X, vec.Y, vec.Z) == BlockType::AIR)
 	{
-         m_blocks[vec.X][vec.Y][vec.Z] = type;
-         BlockListUpdated( BlockChangeData { GetFilePath(), type, vec, m_centerPosition } );
+         SetBlock(vec.X, vec.Y, vec.Z, type);
+         BlockListUpdated( BlockChangeData { type, vec, m_coord } );
 	}
 }
 
 void Chunk::BlockListUpdated(const BlockChangeData& data)
 {
-    m_bIsDirty = true;
+    UpdateBlockFaces(data.BlockPosition);
     m_pWorldManager->Serialize(data);
 }
 
+void Chunk::UpdateBlockFaces(const Vec3i& position)
+{
+#ifdef DEBUG
+    const uint64_t startTime = gettime();
+#endif
+
+    // the faces of the block and its six neighbors change, neighbors may be in the next section or chunk
+    struct AffectedSection
+    {
+        Chunk* ChunkObj;
+        uint32_t Section;
+        Vec3i Positions[7];
+        uint32_t Count;
+    };
+
+    AffectedSection affected[7];
+    uint32_t affectedCount = 0;
+
+    static const int32_t offsets[7][3] = { { 0, 0, 0 }, { -1, 0, 0 }, { 1, 0, 0 }, { 0, -1, 0 }, { 0, 1, 0 }, { 0, 0, -1 }, { 0, 0, 1 } };
+    for (const auto& offset : offsets)
+    {
+        int32_t x = position.X + offset[0];
+        int32_t y = position.Y + offset[1];
+        int32_t z = position.Z + offset[2];
+        Chunk* chunk = this;
+
+        if (y < 0 || y >= CHUNK_SIZE_Y)
+            continue;
+
+        if (x < 0)                  { chunk = m_pChunkLeft;  x += CHUNK_SIZE_X; }
+        else if (x >= CHUNK_SIZE_X) { chunk = m_pChunkRight; x -= CHUNK_SIZE_X; }
+        else if (z < 0)             { chunk = m_pChunkBack;  z += CHUNK_SIZE_Z; }
+        else if (z >= CHUNK_SIZE_Z) { chunk = m_pChunkFront; z -= CHUNK_SIZE_Z; }
+
+        if (!chunk || !chunk->IsLoaded())
+            continue;
+
+        const uint32_t section = y / CHUNK_SECTION_SIZE;
+        uint32_t i = 0;
+        while (i < affectedCount && (affected[i].ChunkObj != chunk || affected[i].Section != section))
+            i++;
+
+        if (i == affectedCount)
+        {
+            affected[i].ChunkObj = chunk;
+            affected[i].Section = section;
+            affected[i].Count = 0;
+            affectedCount++;
+        }
+
+        affected[i].Positions[affected[i].Count++] = Vec3i { (uint32_t) x, (uint32_t) y, (uint32_t) z };
+    }
+
+    for (uint32_t i = 0; i < affectedCount; ++i)
+    {
+        // without a kept render list the section is meshed again by a job
+        if (!affected[i].ChunkObj->UpdateSectionFaces(affected[i].Section, affected[i].Positions, affected[i].Count))
+            affected[i].ChunkObj->SetSectionDirty(affected[i].Section);
+    }
+
+#ifdef DEBUG
+    LOG("Block edit %u %u %u updated %u sections in %u us", position.X, position.Y, position.Z, affectedCount, ticks_to_microsecs(gettime() - startTime));
+#endif
+}
+
+bool Chunk::UpdateSectionFaces(uint32_t section, const Vec3i* positions, uint32_t count)
+{
+    SectionMesh& mesh = m_sectionMeshes[section];
+    const LiveBlockAccess blocks = { this, { m_pChunkLeft, m_pChunkRight, m_pChunkFront, m_pChunkBack } };
+
+    // the edit may open or close a path through the section, which the cave culling needs right away
+    mesh.Connectivity = SectionConnectivity::Compute(blocks, section);
+
+    // a mesh job owns the render lists until the mesh is uploaded, a dirty section is meshed again anyway
+    m_mutex.Lock();
+    bool bPatchable = m_meshState == EChunkMeshState::Idle && !(m_dirtySections & (1u << section));
+    m_mutex.Unlock();
+
+    if (!bPatchable || !mesh.HasRenderList || m_pWorldManager->GetMeshingMode() != EMeshingMode::PerFace)
+        return false;
+
+    auto isAffected = [positions, count](const BlockRenderVO& vo)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (vo.X == positions[i].X && vo.Y == positions[i].Y && vo.Z == positions[i].Z)
+                return true;
+        }
+        return false;
+    };
+
+    for (auto& entry : mesh.BlockRenderList)
+    {
+        auto& blocks = entry.second;
+        blocks.erase(std::remove_if(blocks.begin(), blocks.end(), isAffected), blocks.end());
+    }
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        BlockRenderVO renderVO;
+        if (ChunkMesher::IsBlockVisible(blocks, positions[i].X, positions[i].Y, positions[i].Z, renderVO))
+            ChunkMesher::AddBlock(mesh, GetBlock(positions[i].X, positions[i].Y, positions[i].Z), renderVO);
+    }
+
+    mesh.Blocks = 0;
+    mesh.VisibleFaces = 0;
+    for (auto& entry : mesh.BlockRenderList)
+    {
+        mesh.Blocks += entry.second.size();
+        for (auto& renderVO : entry.second)
+            mesh.VisibleFaces += renderVO.Faces;
+    }
+    mesh.Faces = mesh.VisibleFaces;
+
+    BlockRenderer blockRenderer;
+    RecordDisplayList(mesh, blockRenderer);
+    return true;
+}
+
 void Chunk::SetCenterPosition(const Vector3 &centerPosition)
 {
+    m_mutex.Lock();
     m_centerPosition = centerPosition;
+    m_coord = GetChunkCoordByWorldPosition(centerPosition);
+    m_generation++;
+    m_mutex.Unlock();
 }
 
 void Chunk::SetLoaded(bool value)
@@ -524,44 +807,39 @@ Vector3 Chunk::GetBlockPositionByWorldPosition(const Vector3& worldPosition) con
 BlockType Chunk::GetBlockTypeByWorldPosition(const Vector3& worldPosition) const
 {
 	Vec3i vec = GetLocalBlockPositionByWorldPosition(worldPosition);
-    return m_blocks[vec.X][vec.Y][vec.Z];
+    return GetBlock(vec.X, vec.Y, vec.Z);
 }
 
 Vector3 Chunk::GetPhysicalPosition(const Vector3& position) const
 {
     Vector3 pos = GetBlockPositionByWorldPosition(position);
-    double currentPos = CHUNK_BLOCK_SIZE_Y - (BLOCK_SIZE);
-	bool bValidated = false;
-	do
-	{
-		pos.SetY(currentPos);
-        bValidated = (GetBlockTypeByWorldPosition(pos) != BlockType::AIR) || (currentPos == 0);
-        /*  quick physics fix for the tree update
-         *  Player shouldn't jump higher than blocksize
-         */
-        if (bValidated)
-        {
-            double distance = position.GetY() - currentPos;
-            bValidated = distance > (-BLOCK_SIZE);
-        }
-		currentPos -= BLOCK_SIZE;
+    Vec3i local = GetLocalBlockPositionByWorldPosition(pos);
 
-	} while(!bValidated);
+    // the highest block of the column, unless it is more than one block above the position (e.g. a tree top)
+    int32_t y = static_cast<int32_t>(GetColumnHeight(local.X, local.Z)) - 1;
+    while (y > 0 && position.GetY() - (y * BLOCK_SIZE) <= -BLOCK_SIZE)
+    {
+        y--;
+    }
+
+    // below the overhang the next block under the position is searched
+    while (y > 0 && GetBlock(local.X, y, local.Z) == BlockType::AIR)
+    {
+        y--;
+    }
 
+    pos.SetY(y > 0 ? y * BLOCK_SIZE : 0);
     return pos;
 }
 
-std::string Chunk::GetFilePath() const
+uint32_t Chunk::GetColumnHeight(uint32_t x, uint32_t z) const
+{
+    return m_blocks.GetHeight(x, z);
+}
+
+uint32_t Chunk::GetColumnOpaqueHeight(uint32_t x, uint32_t z) const
 {
-    std::ostringstream filename;
-    filename << WORLD_PATH "/";
-    filename << m_centerPosition.GetX();
-    filename << '_';
-    filename << m_centerPosition.GetY();
-    filename << '_';
-    filename << m_centerPosition.GetZ();
-    filename << ".dat";
-    return filename.str();
+    return m_blocks.GetOpaqueHeight(x, z);
 }
 
 Vector3 Chunk::LocalPositionToGlobalPosition(const Vec3i& localPosition) const
@@ -22,12 +22,25 @@
 
 #include <stdint.h>
 #include <string>
+#include <memory>
 #include "ChunkData.h"
+#include "ChunkSections.h"
+#include "ChunkMesher.h"
 #include "../GameWorld.h"
 #include "../../renderer/BlockRenderHelper.h"
+#include "../../renderer/DisplayListArena.h"
+#include "../FrustumCuller.h"
+#include "SectionConnectivity.h"
 #include "../../utils/Vector3.h"
 #include "../../utils/Mutex.h"
 
+// occluder boxes along each side of a chunk, every box stands on the lowest solid column below it
+#define CHUNK_OCCLUDER_CELLS 2
+#define CHUNK_OCCLUDER_COUNT (CHUNK_OCCLUDER_CELLS * CHUNK_OCCLUDER_CELLS)
+
+class BlockRenderer;
+class ChunkSnapshot;
+
 class Chunk {
 public:
 
@@ -35,21 +48,74 @@ public:
     virtual ~Chunk();
 
     void Init();
-    void Build();
-    void Clear();
-	void RebuildDisplayList();
-    void Render();    
 
-    bool IsDirty() const;
+    /**
+     * @brief Build generates the terrain of the chunk into the given storage, runs on a loader thread.
+     * The blocks become visible with SetLoadedBlocks and CommitLoadedBlocks.
+     */
+    void Build(ChunkSections& blocks);
+
+    // hands the loaded blocks to the main thread, ignored if the chunk was moved in the meantime
+    void SetLoadedBlocks(ChunkSections&& blocks, uint32_t generation);
+
+    /**
+     * @brief CommitLoadedBlocks swaps the loaded blocks in and marks the chunk as loaded, has to run on the main thread.
+     * @return true if blocks were committed.
+     */
+    bool CommitLoadedBlocks();
+    void Clear();
+    /**
+     * @brief Render draws the sections which intersect the frustum and adds what was tested and drawn to stats.
+     * Faces of a direction which points away from the camera everywhere in a section are skipped.
+     * @param planeMask planes the chunk intersects, sections are not tested if it is 0.
+     * @param sectionMask one bit per section which may be drawn.
+     */
+    void Render(const FrustumCuller& culler, const Vector3& cameraPosition, uint8_t planeMask, uint8_t sectionMask, ChunkRenderStats& stats);
+
+    // box around the sections with a mesh, false if the chunk has nothing to draw
+    bool GetRenderBounds(CullBox& box) const;
+
+    // solid boxes inside the chunk which hide what is behind them, returns the number of boxes written
+    uint32_t GetOccluders(CullBox occluders[CHUNK_OCCLUDER_COUNT]);
+
+    // faces of the section which see each other, all faces are connected until the section is meshed
+    uint16_t GetSectionConnectivity(uint32_t section) const;
+
+    /**
+     * @brief BuildMesh builds the block render lists of the chunk on a worker thread.
+     * @param snapshot the blocks captured when the mesh was queued, the live blocks are never read.
+     * @param generation the generation of the chunk when the mesh was queued.
+     */
+    void BuildMesh(const ChunkSnapshot& snapshot, uint32_t generation);
+
+    /**
+     * @brief UploadMesh records the built render lists into the display list, has to run on the main thread.
+     * @return false if the chunk was moved since the mesh was queued.
+     */
+    bool UploadMesh();
+    EChunkMeshState GetMeshState();
+    void SetMeshQueued();
+
+    // copies the queued sections and the border of the neighbors for the mesh job, has to run on the main thread
+    std::shared_ptr<const ChunkSnapshot> CreateMeshSnapshot() const;
+
+    // increased every time the chunk is moved to another position
+    uint32_t GetGeneration();
+
+    // a chunk is dirty while one of its sections needs a new mesh
+    bool IsDirty();
 	void SetDirty(bool dirty);
+    void SetSectionDirty(uint32_t section);
 
 	uint32_t GetDisplayListSize() const;
 	uint64_t GetAmountOfBlocks() const;
 	uint64_t GetAmountOfFaces() const;
+	uint64_t GetAmountOfVisibleFaces() const;
 
 	void DeleteDisplayList();
 
 	const Vector3& GetCenterPosition() const;
+	const ChunkCoord& GetChunkCoord() const;
 
     void SetChunkNeighbors();
     bool NeighborsLoaded();
@@ -60,12 +126,18 @@ public:
 	BlockType GetBlockTypeByWorldPosition(const Vector3& worldPosition) const;
     Vector3 GetPhysicalPosition(const Vector3& position) const;
 
-    BlockType*** GetBlocks() const
+    // one above the highest non air block of the local column, 0 for an empty column
+    uint32_t GetColumnHeight(uint32_t x, uint32_t z) const;
+    // one above the highest block of the local column which can not be seen through
+    uint32_t GetColumnOpaqueHeight(uint32_t x, uint32_t z) const;
+
+    inline BlockType GetBlock(uint32_t x, uint32_t y, uint32_t z) const
     {
-        return m_blocks;
+        return m_blocks.Get(GetChunkBlockIndex(x, y, z));
     }
 
-    std::string GetFilePath() const;
+    // bytes used by the block storage of the chunk
+    uint32_t GetBlockMemoryUsage() const;
 
     void SetCenterPosition(const Vector3 &centerPosition);
 
@@ -73,41 +145,59 @@ public:
 
     bool IsLoaded();
 
-    inline bool HasDisplayList() const
-    {
-        return m_pDispList;
-    }
+    bool HasDisplayList() const;
 
 private:
-    void CreateDisplayList(size_t sizeOfDisplayList);
-	void FinishDisplayList();
-    bool AddBlockToRenderList(BlockType type, const BlockRenderVO &blockRenderVO);
-	void RemoveBlock(const Vector3& position);
-	void ClearBlockRenderList();
-	void BuildBlockRenderList();
-    bool IsBlockVisible(uint32_t iX, uint32_t iY, uint32_t iZ, BlockRenderVO & blockRenderVO );
+    struct SectionMesh : SectionRenderList
+    {
+        // one part per face direction in EBlockFaces order, each part ends at its offset in the list
+        DisplayListHandle DisplayList;
+        uint32_t FaceListEnds[SECTION_FACE_COUNT]   = {};
+        uint16_t FaceListQuads[SECTION_FACE_COUNT]  = {};
+        uint8_t FaceListTiles[SECTION_FACE_COUNT]   = {};
+        // plane which culled the section last, it is tested first next frame
+        uint8_t CullPlane           = 0;
+        // read by the cave culling on the main thread, the mesh job builds the next one
+        uint16_t Connectivity       = SECTION_ALL_CONNECTED;
+        uint16_t MeshedConnectivity = SECTION_ALL_CONNECTED;
+        // the per face render list is kept after the upload, so single blocks can be patched
+        bool HasRenderList          = false;
+    };
+
+	void ReleaseDisplayList(SectionMesh& mesh);
+	void ClearBlockRenderList(SectionMesh& mesh);
+    void RecordDisplayList(SectionMesh& mesh, BlockRenderer& blockRenderer);
+    bool UpdateSectionFaces(uint32_t section, const Vec3i* positions, uint32_t count);
 	Vec3i GetLocalBlockPositionByWorldPosition(const Vector3& blockWorldPosition) const;
 	Vector3 LocalPositionToGlobalPosition(const Vec3i& localPosition) const;
 
-    void CreateTrees();
+    void SetBlock(uint32_t x, uint32_t y, uint32_t z, BlockType type);
     void BlockListUpdated(const BlockChangeData& data);
+    void UpdateBlockFaces(const Vec3i& position);
 
 private:
     Mutex m_mutex;
 
     bool m_bLoadingDone         = false;
-    bool m_bIsDirty             = false;
-    bool m_bNeighbourUpdate     = false;
-    uint32_t m_displayListSize  = 0;
-    void* m_pDispList           = nullptr;
-
-    uint32_t m_amountOfBlocks   = 0;
-    uint32_t m_amountOfFaces    = 0;
+    EChunkMeshState m_meshState = EChunkMeshState::Idle;
+    uint32_t m_generation       = 0;
+    uint32_t m_meshGeneration   = 0;
+    // one bit per section which needs a new mesh, and the sections of the queued mesh
+    uint32_t m_dirtySections    = 0;
+    uint32_t m_meshSections     = 0;
 
     Vector3 m_centerPosition;
-
-    BlockType*** m_blocks;
-    std::map<BlockType, std::vector<BlockRenderVO> > m_mBlockRenderList;
+    ChunkCoord m_coord = { 0, 0 };
+
+    // only the main thread reads and writes the blocks, mesh jobs work on a ChunkSnapshot
+    ChunkSections m_blocks;
+    ChunkSections m_loadedBlocks;
+    bool m_bBlocksLoaded        = false;
+    // the occluder heights are found again after the blocks were changed
+    uint8_t m_occluderHeights[CHUNK_OCCLUDER_COUNT];
+    bool m_bOccludersDirty      = true;
+    uint32_t m_loadedGeneration = 0;
+    SectionMesh m_sectionMeshes[CHUNK_SECTION_COUNT];
 	class GameWorld* m_pWorldManager;
 
     Chunk* m_pChunkLeft         = nullptr;
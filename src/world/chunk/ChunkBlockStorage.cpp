@@ -0,0 +1,197 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#include <string.h>
+#include <algorithm>
+#include "ChunkBlockStorage.h"
+
+static_assert((1u << CHUNK_STORAGE_MAX_BITS) > 0xFF, "the palette has to be able to hold every block type");
+
+ChunkBlockStorage::ChunkBlockStorage(uint32_t blockCount) : m_blockCount(blockCount)
+{
+    memset(m_paletteLookup, 0, sizeof(m_paletteLookup));
+    Fill(BlockType::AIR);
+}
+
+void ChunkBlockStorage::Fill(BlockType type)
+{
+    // swapped instead of assigned, so the memory of a larger palette is freed
+    std::vector<BlockType>(1, type).swap(m_palette);
+    std::vector<uint32_t>(1, m_blockCount).swap(m_blockCounts);
+    m_paletteLookup[static_cast<uint8_t>(type)] = 0;
+    Resize(0);
+}
+
+void ChunkBlockStorage::Set(uint32_t index, BlockType type)
+{
+    uint32_t paletteIndex = GetPaletteIndex(type);
+    uint32_t& word = m_data[index >> m_wordShift];
+    uint32_t shift = (index & m_slotMask) * m_bits;
+    uint32_t oldPaletteIndex = (word >> shift) & m_valueMask;
+    if (oldPaletteIndex == paletteIndex)
+        return;
+
+    word = (word & ~(m_valueMask << shift)) | (paletteIndex << shift);
+    m_blockCounts[paletteIndex]++;
+    if (--m_blockCounts[oldPaletteIndex] == 0)
+        Shrink();
+}
+
+void ChunkBlockStorage::Decode(uint32_t first, uint32_t count, BlockType* out) const
+{
+    if (m_bits == 0)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+            out[i] = m_palette[0];
+        return;
+    }
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        out[i] = Get(first + i);
+    }
+}
+
+uint32_t ChunkBlockStorage::GetBitsPerBlock() const
+{
+    return m_bits;
+}
+
+uint32_t ChunkBlockStorage::GetPaletteSize() const
+{
+    return m_palette.size();
+}
+
+uint32_t ChunkBlockStorage::GetMemoryUsage() const
+{
+    return m_palette.capacity() * sizeof(BlockType) + m_blockCounts.capacity() * sizeof(uint32_t) +
+           m_data.capacity() * sizeof(uint32_t) + sizeof(*this);
+}
+
+uint32_t ChunkBlockStorage::GetPaletteIndex(BlockType type)
+{
+    uint8_t paletteIndex = m_paletteLookup[static_cast<uint8_t>(type)];
+    if (paletteIndex < m_palette.size() && m_palette[paletteIndex] == type)
+        return paletteIndex;
+
+    // the entry of a type without blocks is free, only the palette entry changes
+    auto freeEntry = std::find(m_blockCounts.begin(), m_blockCounts.end(), 0);
+    if (freeEntry != m_blockCounts.end())
+    {
+        paletteIndex = freeEntry - m_blockCounts.begin();
+        m_palette[paletteIndex] = type;
+        m_paletteLookup[static_cast<uint8_t>(type)] = paletteIndex;
+        return paletteIndex;
+    }
+
+    if (m_palette.size() == (1u << m_bits))
+    {
+        Resize(std::min<uint32_t>(m_bits == 0 ? 1 : m_bits * 2, CHUNK_STORAGE_MAX_BITS));
+    }
+
+    m_palette.push_back(type);
+    m_blockCounts.push_back(0);
+    m_paletteLookup[static_cast<uint8_t>(type)] = m_palette.size() - 1;
+    return m_palette.size() - 1;
+}
+
+void ChunkBlockStorage::Shrink()
+{
+    uint32_t liveTypes = 0;
+    uint32_t lastLiveIndex = 0;
+    for (uint32_t i = 0; i < m_blockCounts.size(); ++i)
+    {
+        if (m_blockCounts[i] > 0)
+        {
+            liveTypes++;
+            lastLiveIndex = i;
+        }
+    }
+
+    if (liveTypes == 1)
+    {
+        Fill(m_palette[lastLiveIndex]);
+        return;
+    }
+
+    // half of the smaller palette stays free, so a type which comes and goes does not repack every time
+    uint32_t bits = 1;
+    while ((1u << bits) < liveTypes * 2 && bits < CHUNK_STORAGE_MAX_BITS)
+        bits *= 2;
+
+    if (bits >= m_bits)
+        return;
+
+    uint8_t remap[1 << CHUNK_STORAGE_MAX_BITS];
+    std::vector<BlockType> palette;
+    std::vector<uint32_t> blockCounts;
+    for (uint32_t i = 0; i < m_palette.size(); ++i)
+    {
+        if (m_blockCounts[i] == 0)
+            continue;
+
+        remap[i] = palette.size();
+        m_paletteLookup[static_cast<uint8_t>(m_palette[i])] = palette.size();
+        palette.push_back(m_palette[i]);
+        blockCounts.push_back(m_blockCounts[i]);
+    }
+
+    Resize(bits, remap);
+    m_palette.swap(palette);
+    m_blockCounts.swap(blockCounts);
+}
+
+void ChunkBlockStorage::Resize(uint32_t bits, const uint8_t* remap)
+{
+    std::vector<uint32_t> data;
+
+    if (bits == 0)
+    {
+        // one word which always yields palette index 0
+        data.assign(1, 0);
+        m_wordShift = 31;
+        m_slotMask = 0;
+        m_valueMask = 0;
+    }
+    else
+    {
+        const uint32_t blocksPerWord = 32 / bits;
+        data.assign((m_blockCount + blocksPerWord - 1) / blocksPerWord, 0);
+
+        uint32_t wordShift = 0;
+        while ((1u << wordShift) < blocksPerWord)
+            wordShift++;
+
+        // repack the indices with the new width
+        for (uint32_t i = 0; m_bits > 0 && i < m_blockCount; ++i)
+        {
+            uint32_t paletteIndex = (m_data[i >> m_wordShift] >> ((i & m_slotMask) * m_bits)) & m_valueMask;
+            if (remap)
+                paletteIndex = remap[paletteIndex];
+            data[i >> wordShift] |= paletteIndex << ((i & (blocksPerWord - 1)) * bits);
+        }
+
+        m_wordShift = wordShift;
+        m_slotMask = blocksPerWord - 1;
+        m_valueMask = (1u << bits) - 1;
+    }
+
+    m_bits = bits;
+    m_data.swap(data);
+}
@@ -0,0 +1,85 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#ifndef CHUNKBLOCKSTORAGE_H
+#define CHUNKBLOCKSTORAGE_H
+
+#include <stdint.h>
+#include <vector>
+#include "../blocks/BlockType.h"
+
+// every block type fits into a palette of this width, so the palette never grows beyond it
+#define CHUNK_STORAGE_MAX_BITS 8
+
+/**
+ * @brief ChunkBlockStorage
+ * Stores the block types of a chunk as indices into a palette of the types which occur in the chunk.
+ * The indices are packed with 0, 1, 2, 4 or 8 bits into 32 bit words, a power of two never lets an index
+ * cross a word. A chunk made of one type needs no index words at all, the bit width grows when a new
+ * type does not fit into the palette any more.
+ * The palette counts the blocks of every type. A new type takes the entry of a type which is gone, the
+ * indices are repacked with fewer bits once the remaining types fit into half of a smaller palette.
+ */
+class ChunkBlockStorage
+{
+public:
+    explicit ChunkBlockStorage(uint32_t blockCount);
+
+    // drops the palette, all blocks are of the given type afterwards
+    void Fill(BlockType type);
+
+    inline BlockType Get(uint32_t index) const
+    {
+        return m_palette[(m_data[index >> m_wordShift] >> ((index & m_slotMask) * m_bits)) & m_valueMask];
+    }
+
+    void Set(uint32_t index, BlockType type);
+
+    // unpacks count blocks starting at first, used for whole columns by the mesher
+    void Decode(uint32_t first, uint32_t count, BlockType* out) const;
+
+    uint32_t GetBitsPerBlock() const;
+    uint32_t GetPaletteSize() const;
+
+    // bytes of the palette and the packed indices
+    uint32_t GetMemoryUsage() const;
+
+private:
+    uint32_t GetPaletteIndex(BlockType type);
+    void Shrink();
+    // repacks the indices with the new width, remap maps the old palette indices to the new ones if it is set
+    void Resize(uint32_t bits, const uint8_t* remap = nullptr);
+
+private:
+    uint32_t m_blockCount;
+    std::vector<BlockType> m_palette;
+    // blocks per palette entry, entries without blocks are reused for new types
+    std::vector<uint32_t> m_blockCounts;
+    std::vector<uint32_t> m_data;
+
+    // palette index of every block type, only valid if the palette holds the type at this index
+    uint8_t m_paletteLookup[256];
+
+    uint32_t m_bits       = 0;
+    uint32_t m_wordShift  = 0;
+    uint32_t m_slotMask   = 0;
+    uint32_t m_valueMask  = 0;
+};
+
+#endif // CHUNKBLOCKSTORAGE_H
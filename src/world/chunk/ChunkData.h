@@ -20,18 +20,31 @@
 #ifndef CHUNKCHANGEDATA_H
 #define CHUNKCHANGEDATA_H
 
-#include "../blocks/BlockManager.h"
+#include <math.h>
+#include <vector>
+#include <memory>
+#include "ChunkFile.h"
+#include "../blocks/BlockType.h"
 #include "../../utils/Vector3.h"
 
-#define CHUNK_MAP_CASH_X 5
-#define CHUNK_MAP_CASH_Y 5
-
 #define CHUNK_SIZE_X 16
 #define CHUNK_SIZE_Y 128
 #define CHUNK_SIZE_Z 16
 
 #define CHUNK_MIN_GROUND 20
 
+#define CHUNK_BLOCK_COUNT (CHUNK_SIZE_X * CHUNK_SIZE_Y * CHUNK_SIZE_Z)
+
+// chunks are split into vertical sections of 16x16x16 blocks, every section is a contiguous part of the block buffer
+#define CHUNK_SECTION_SIZE 16
+#define CHUNK_SECTION_SHIFT 12
+#define CHUNK_SECTION_COUNT (CHUNK_SIZE_Y / CHUNK_SECTION_SIZE)
+#define CHUNK_SECTION_BLOCK_COUNT (1 << CHUNK_SECTION_SHIFT)
+
+static_assert(CHUNK_SIZE_X == CHUNK_SECTION_SIZE && CHUNK_SIZE_Z == CHUNK_SECTION_SIZE && CHUNK_SIZE_Y % CHUNK_SECTION_SIZE == 0,
+              "chunk dimensions have to be made of whole sections");
+static_assert(CHUNK_SECTION_BLOCK_COUNT == CHUNK_SECTION_SIZE * CHUNK_SECTION_SIZE * CHUNK_SECTION_SIZE, "section shift does not match the section size");
+
 #define CHUNK_BLOCK_SIZE_X (BLOCK_SIZE * CHUNK_SIZE_X)
 #define CHUNK_BLOCK_SIZE_Y (BLOCK_SIZE * CHUNK_SIZE_Y)
 #define CHUNK_BLOCK_SIZE_Z (BLOCK_SIZE * CHUNK_SIZE_Z)
@@ -39,6 +52,26 @@
 #define STONE_LEVEL 20
 #define TREE_HIGHT 6
 
+enum class EMeshingMode : unsigned char
+{
+    PerFace,    // one quad for every visible block face
+    Greedy      // coplanar faces of the same block type are merged into bigger quads
+};
+
+enum class ESectionState : unsigned char
+{
+    Air,        // the section holds no blocks
+    Opaque,     // every block of the section is solid
+    Mixed
+};
+
+enum class EChunkMeshState : unsigned char
+{
+    Idle,       // no mesh is built
+    Queued,     // a mesh job builds the render lists
+    Ready       // the render lists wait for the upload into the display list
+};
+
 struct Vec3i
 {
     uint32_t X;
@@ -46,19 +79,124 @@ struct Vec3i
     uint32_t Z;
 };
 
+/**
+ * @brief GetChunkBlockIndex
+ * @return Index of the local block position inside the flat chunk block buffer.
+ * The section of the block (y / CHUNK_SECTION_SIZE) is stored above CHUNK_SECTION_SHIFT, so the low bits are the index inside the section.
+ * By default a section is y-major so that every column of the section is one contiguous run of CHUNK_SECTION_SIZE blocks,
+ * define CHUNK_LAYOUT_MORTON to store the blocks of a section in z-order (morton) instead.
+ */
+inline uint32_t GetChunkBlockIndex(uint32_t x, uint32_t y, uint32_t z)
+{
+#ifdef CHUNK_LAYOUT_MORTON
+    // interleave the 4 low bits of x, y and z
+    uint32_t index = 0;
+    for (uint32_t bit = 0; bit < 4; ++bit)
+    {
+        index |= ((y >> bit) & 1) << (bit * 3);
+        index |= ((z >> bit) & 1) << (bit * 3 + 1);
+        index |= ((x >> bit) & 1) << (bit * 3 + 2);
+    }
+    return index | ((y >> 4) << CHUNK_SECTION_SHIFT);
+#else
+    return ((y >> 4) << CHUNK_SECTION_SHIFT) | ((x * CHUNK_SIZE_Z + z) * CHUNK_SECTION_SIZE + (y & (CHUNK_SECTION_SIZE - 1)));
+#endif
+}
+
+/**
+ * @brief ChunkCoord
+ * Integer position of a chunk in the chunk grid, chunk (0,0) spans the world positions [0, CHUNK_BLOCK_SIZE) on x and z.
+ */
+struct ChunkCoord
+{
+    int32_t X;
+    int32_t Z;
+
+    bool operator==(const ChunkCoord& other) const
+    {
+        return X == other.X && Z == other.Z;
+    }
+
+    bool operator!=(const ChunkCoord& other) const
+    {
+        return !(*this == other);
+    }
+};
+
+// hash of the chunk coordinates for ChunkHashMap and the standard containers
+struct ChunkCoordHash
+{
+    inline uint32_t operator()(const ChunkCoord& coord) const
+    {
+        return ((uint32_t) coord.X * 73856093u) ^ ((uint32_t) coord.Z * 19349663u);
+    }
+};
+
+inline ChunkCoord GetChunkCoordByWorldPosition(const Vector3& worldPosition)
+{
+    return ChunkCoord { (int32_t) floor(worldPosition.GetX() / CHUNK_BLOCK_SIZE_X), (int32_t) floor(worldPosition.GetZ() / CHUNK_BLOCK_SIZE_Z) };
+}
+
+inline int32_t GetChunkDistanceSquared(const ChunkCoord& a, const ChunkCoord& b)
+{
+    return (a.X - b.X) * (a.X - b.X) + (a.Z - b.Z) * (a.Z - b.Z);
+}
+
+inline Vector3 GetChunkCenterPosition(const ChunkCoord& coord)
+{
+    return Vector3((coord.X + 0.5) * CHUNK_BLOCK_SIZE_X, CHUNK_BLOCK_SIZE_Y / 2, (coord.Z + 0.5) * CHUNK_BLOCK_SIZE_Z);
+}
+
 struct BlockChangeData
 {
-    std::string Filepath;
     BlockType   Type;
     Vec3i       BlockPosition;
-    Vector3     ChunkPosition;
+    ChunkCoord  Coord;
+};
+
+struct ChunkEditBatch
+{
+    ChunkCoord                  Coord;
+    std::vector<ChunkFileEdit>  Edits;
+    class RegionStorage*        Storage;
 };
 
 struct ChunkLoadingData
 {
-    std::string     Filepath;
-    class Chunk*    ChunkObj;
+    ChunkCoord                  Coord;
+    class Chunk*                ChunkObj;
+    uint32_t                    Generation;
+    class RegionStorage*        Storage;
 };
 
 
+struct ChunkMeshingData
+{
+    class Chunk*                                ChunkObj;
+    uint32_t                                    Generation;
+    std::shared_ptr<const class ChunkSnapshot>  Snapshot;
+};
+
+// what was tested, culled and drawn by Chunk::Render in one frame
+struct ChunkRenderStats
+{
+    uint32_t TestedChunks       = 0;
+    uint32_t CulledChunks       = 0;
+    uint32_t TestedSections     = 0;
+    uint32_t CulledSections     = 0;
+    uint32_t BoxTests           = 0;
+    uint32_t CaveCulledChunks   = 0;
+    uint32_t CaveCulledSections = 0;
+    uint32_t OccludedChunks     = 0;
+    uint32_t Occluders          = 0;
+    uint32_t VisibleFaces       = 0;
+    uint32_t Quads              = 0;
+    // quads of the face directions which can be seen from the camera
+    uint32_t SubmittedQuads     = 0;
+    uint32_t DisplayListBytes   = 0;
+    // atlas loads and the tile selects of the drawn display lists
+    uint32_t TextureLoads       = 0;
+    uint32_t TileSelects        = 0;
+};
+
 #endif // CHUNKCHANGEDATA_H
@@ -0,0 +1,97 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#include "ChunkEditJournal.h"
+
+void ChunkEditJournal::Add(const BlockChangeData& data)
+{
+    const uint32_t index = ChunkFile::GetIndex(data.BlockPosition.X, data.BlockPosition.Y, data.BlockPosition.Z);
+
+    for (auto& chunk : m_chunks)
+    {
+        if (chunk.Coord == data.Coord)
+        {
+            chunk.Blocks[index] = static_cast<uint8_t>(data.Type);
+            return;
+        }
+    }
+
+    m_chunks.emplace_back(ChunkEdits { data.Coord, std::map<uint32_t, uint8_t>() });
+    m_chunks.back().Blocks[index] = static_cast<uint8_t>(data.Type);
+}
+
+bool ChunkEditJournal::IsEmpty() const
+{
+    return m_chunks.empty();
+}
+
+bool ChunkEditJournal::HasEdits(const ChunkCoord& coord) const
+{
+    for (auto& chunk : m_chunks)
+    {
+        if (chunk.Coord == coord)
+            return true;
+    }
+
+    return false;
+}
+
+bool ChunkEditJournal::Take(const ChunkCoord& coord, ChunkEditBatch& batch)
+{
+    for (auto it = m_chunks.begin(); it != m_chunks.end(); ++it)
+    {
+        if (it->Coord == coord)
+        {
+            MoveToBatch(*it, batch);
+            m_chunks.erase(it);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ChunkEditJournal::TakeAll(std::vector<ChunkEditBatch>& batches)
+{
+    for (auto& chunk : m_chunks)
+    {
+        batches.emplace_back();
+        MoveToBatch(chunk, batches.back());
+    }
+
+    m_chunks.clear();
+}
+
+void ChunkEditJournal::MoveToBatch(ChunkEdits& edits, ChunkEditBatch& batch) const
+{
+    batch.Coord = edits.Coord;
+    batch.Edits.clear();
+    batch.Edits.reserve(edits.Blocks.size());
+
+    for (auto& block : edits.Blocks)
+    {
+        // invert ChunkFile::GetIndex
+        const uint32_t y = block.first % CHUNK_FILE_SIZE_Y;
+        const uint32_t z = (block.first / CHUNK_FILE_SIZE_Y) % CHUNK_FILE_SIZE_Z;
+        const uint32_t x = block.first / (CHUNK_FILE_SIZE_Y * CHUNK_FILE_SIZE_Z);
+        batch.Edits.push_back(ChunkFileEdit { (uint8_t) x, (uint8_t) y, (uint8_t) z, block.second });
+    }
+
+    edits.Blocks.clear();
+}
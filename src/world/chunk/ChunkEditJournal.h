@@ -0,0 +1,59 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#ifndef CHUNKEDITJOURNAL_H
+#define CHUNKEDITJOURNAL_H
+
+#include <map>
+#include <vector>
+#include "ChunkData.h"
+
+/**
+ * @brief ChunkEditJournal
+ * Collects the block edits of the main thread per chunk until they are flushed in one batch per chunk.
+ * Repeated edits of the same block are coalesced, only the last block type is written.
+ */
+class ChunkEditJournal
+{
+public:
+    void Add(const BlockChangeData& data);
+
+    bool IsEmpty() const;
+    bool HasEdits(const ChunkCoord& coord) const;
+
+    /**
+     * @brief Take moves the edits of one chunk into the batch and removes them from the journal.
+     * @return false if there are no edits for the chunk.
+     */
+    bool Take(const ChunkCoord& coord, ChunkEditBatch& batch);
+    void TakeAll(std::vector<ChunkEditBatch>& batches);
+
+private:
+    struct ChunkEdits
+    {
+        ChunkCoord Coord;
+        std::map<uint32_t, uint8_t> Blocks; // block type by ChunkFile::GetIndex
+    };
+
+    void MoveToBatch(ChunkEdits& edits, ChunkEditBatch& batch) const;
+
+    std::vector<ChunkEdits> m_chunks;
+};
+
+#endif // CHUNKEDITJOURNAL_H
@@ -0,0 +1,242 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#include <stdio.h>
+#include "ChunkFile.h"
+
+static inline void WriteU16(uint8_t* buffer, uint16_t value)
+{
+    buffer[0] = (uint8_t) (value >> 8);
+    buffer[1] = (uint8_t) value;
+}
+
+static inline void WriteU32(uint8_t* buffer, uint32_t value)
+{
+    buffer[0] = (uint8_t) (value >> 24);
+    buffer[1] = (uint8_t) (value >> 16);
+    buffer[2] = (uint8_t) (value >> 8);
+    buffer[3] = (uint8_t) value;
+}
+
+static inline uint16_t ReadU16(const uint8_t* buffer)
+{
+    return (uint16_t) ((buffer[0] << 8) | buffer[1]);
+}
+
+static inline uint32_t ReadU32(const uint8_t* buffer)
+{
+    return ((uint32_t) buffer[0] << 24) | ((uint32_t) buffer[1] << 16) | ((uint32_t) buffer[2] << 8) | (uint32_t) buffer[3];
+}
+
+bool ChunkFile::Decode(const uint8_t* buffer, size_t size, ChunkFileData& data)
+{
+    uint32_t bodySize = 0;
+    if (!ReadHeader(buffer, size, data.X, data.Z, bodySize) || bodySize > size - CHUNK_FILE_HEADER_SIZE)
+        return false;
+
+    const uint8_t* body = buffer + CHUNK_FILE_HEADER_SIZE;
+    data.Blocks.assign(CHUNK_FILE_BLOCK_COUNT, CHUNK_FILE_UNCHANGED);
+    if (bodySize > 0 && !ReadBody(body, bodySize, data.Blocks))
+        return false;
+
+    const uint8_t* edits = body + bodySize;
+    data.EditCount = (size - CHUNK_FILE_HEADER_SIZE - bodySize) / CHUNK_FILE_EDIT_SIZE;
+    for (uint32_t i = 0; i < data.EditCount; ++i, edits += CHUNK_FILE_EDIT_SIZE)
+    {
+        if (edits[0] < CHUNK_FILE_SIZE_X && edits[1] < CHUNK_FILE_SIZE_Y && edits[2] < CHUNK_FILE_SIZE_Z)
+        {
+            data.Blocks[GetIndex(edits[0], edits[1], edits[2])] = edits[3];
+        }
+    }
+
+    return true;
+}
+
+bool ChunkFile::Encode(const ChunkFileData& data, std::vector<uint8_t>& buffer)
+{
+    if (data.Blocks.size() != CHUNK_FILE_BLOCK_COUNT)
+        return false;
+
+    // the palette maps block types to indices, CHUNK_FILE_UNCHANGED stays unchanged
+    uint8_t paletteIndex[256];
+    std::vector<uint8_t> palette;
+    for (uint32_t i = 0; i < 256; ++i)
+        paletteIndex[i] = CHUNK_FILE_UNCHANGED;
+
+    for (uint8_t type : data.Blocks)
+    {
+        if (type != CHUNK_FILE_UNCHANGED && paletteIndex[type] == CHUNK_FILE_UNCHANGED)
+        {
+            paletteIndex[type] = (uint8_t) palette.size();
+            palette.push_back(type);
+        }
+    }
+
+    buffer.assign(CHUNK_FILE_HEADER_SIZE, 0);
+    buffer.push_back((uint8_t) palette.size());
+    buffer.insert(buffer.end(), palette.begin(), palette.end());
+
+    for (uint32_t x = 0; x < CHUNK_FILE_SIZE_X; ++x)
+    {
+        for (uint32_t z = 0; z < CHUNK_FILE_SIZE_Z; ++z)
+        {
+            const uint8_t* column = &data.Blocks[GetIndex(x, 0, z)];
+            uint32_t y = 0;
+            while (y < CHUNK_FILE_SIZE_Y)
+            {
+                uint8_t type = column[y];
+                uint32_t length = 1;
+                while (y + length < CHUNK_FILE_SIZE_Y && column[y + length] == type)
+                    length++;
+
+                buffer.push_back((uint8_t) length);
+                buffer.push_back(paletteIndex[type]);
+                y += length;
+            }
+        }
+    }
+
+    WriteHeader(buffer.data(), data.X, data.Z, buffer.size() - CHUNK_FILE_HEADER_SIZE);
+    return true;
+}
+
+void ChunkFile::EncodeEmpty(int32_t x, int32_t z, std::vector<uint8_t>& buffer)
+{
+    buffer.assign(CHUNK_FILE_HEADER_SIZE, 0);
+    WriteHeader(buffer.data(), x, z, 0);
+}
+
+void ChunkFile::EncodeEdit(const ChunkFileEdit& edit, uint8_t* buffer)
+{
+    buffer[0] = edit.X;
+    buffer[1] = edit.Y;
+    buffer[2] = edit.Z;
+    buffer[3] = edit.Type;
+}
+
+uint32_t ChunkFile::GetEditCount(const uint8_t* buffer, size_t size)
+{
+    int32_t x, z;
+    uint32_t bodySize = 0;
+    if (!ReadHeader(buffer, size, x, z, bodySize) || bodySize > size - CHUNK_FILE_HEADER_SIZE)
+        return 0;
+
+    return (size - CHUNK_FILE_HEADER_SIZE - bodySize) / CHUNK_FILE_EDIT_SIZE;
+}
+
+bool ChunkFile::Read(const std::string& filePath, ChunkFileData& data)
+{
+    FILE* file = fopen(filePath.c_str(), "rb");
+    if (!file)
+        return false;
+
+    fseek(file, 0, SEEK_END);
+    long fileSize = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    std::vector<uint8_t> buffer(fileSize > 0 ? fileSize : 0);
+    bool bRead = fread(buffer.data(), 1, buffer.size(), file) == buffer.size();
+    fclose(file);
+
+    return bRead && Decode(buffer.data(), buffer.size(), data);
+}
+
+bool ChunkFile::Write(const std::string& filePath, const ChunkFileData& data)
+{
+    std::vector<uint8_t> buffer;
+    if (!Encode(data, buffer))
+        return false;
+
+    FILE* file = fopen(filePath.c_str(), "wb");
+    if (!file)
+        return false;
+
+    bool bWritten = fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+    fclose(file);
+    return bWritten;
+}
+
+void ChunkFile::WriteHeader(uint8_t* buffer, int32_t x, int32_t z, uint32_t bodySize)
+{
+    WriteU32(buffer, CHUNK_FILE_MAGIC);
+    WriteU16(buffer + 4, CHUNK_FILE_VERSION);
+    WriteU16(buffer + 6, CHUNK_FILE_HEADER_SIZE);
+    WriteU32(buffer + 8, (uint32_t) x);
+    WriteU32(buffer + 12, (uint32_t) z);
+    WriteU32(buffer + 16, bodySize);
+    buffer[20] = CHUNK_FILE_SIZE_X;
+    buffer[21] = CHUNK_FILE_SIZE_Y - 1;
+    buffer[22] = CHUNK_FILE_SIZE_Z;
+    buffer[23] = 0;
+}
+
+bool ChunkFile::ReadHeader(const uint8_t* buffer, size_t size, int32_t& x, int32_t& z, uint32_t& bodySize)
+{
+    if (size < CHUNK_FILE_HEADER_SIZE || ReadU32(buffer) != CHUNK_FILE_MAGIC)
+        return false;
+
+    if (ReadU16(buffer + 4) != CHUNK_FILE_VERSION || ReadU16(buffer + 6) != CHUNK_FILE_HEADER_SIZE)
+        return false;
+
+    if (buffer[20] != CHUNK_FILE_SIZE_X || buffer[21] != CHUNK_FILE_SIZE_Y - 1 || buffer[22] != CHUNK_FILE_SIZE_Z)
+        return false;
+
+    x = (int32_t) ReadU32(buffer + 8);
+    z = (int32_t) ReadU32(buffer + 12);
+    bodySize = ReadU32(buffer + 16);
+    return true;
+}
+
+bool ChunkFile::ReadBody(const uint8_t* buffer, size_t size, std::vector<uint8_t>& blocks)
+{
+    const uint8_t* end = buffer + size;
+    uint32_t paletteSize = *buffer++;
+    if (1 + paletteSize > size)
+        return false;
+
+    const uint8_t* palette = buffer;
+    buffer += paletteSize;
+
+    for (uint32_t x = 0; x < CHUNK_FILE_SIZE_X; ++x)
+    {
+        for (uint32_t z = 0; z < CHUNK_FILE_SIZE_Z; ++z)
+        {
+            uint8_t* column = &blocks[GetIndex(x, 0, z)];
+            uint32_t y = 0;
+            while (y < CHUNK_FILE_SIZE_Y)
+            {
+                if (buffer + 2 > end)
+                    return false;
+
+                uint32_t length = buffer[0];
+                uint8_t index = buffer[1];
+                buffer += 2;
+
+                if (length == 0 || y + length > CHUNK_FILE_SIZE_Y || (index != CHUNK_FILE_UNCHANGED && index >= paletteSize))
+                    return false;
+
+                uint8_t type = index == CHUNK_FILE_UNCHANGED ? CHUNK_FILE_UNCHANGED : palette[index];
+                for (uint32_t i = 0; i < length; ++i)
+                    column[y++] = type;
+            }
+        }
+    }
+
+    return true;
+}
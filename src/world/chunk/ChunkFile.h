@@ -0,0 +1,118 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#ifndef CHUNKFILE_H
+#define CHUNKFILE_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// this header only depends on the standard library so offline tools can read and write chunk files too
+
+#define CHUNK_FILE_MAGIC        0x5743484B // "WCHK"
+#define CHUNK_FILE_VERSION      1
+#define CHUNK_FILE_HEADER_SIZE  24
+#define CHUNK_FILE_EDIT_SIZE    4
+#define CHUNK_FILE_EXTENSION    ".chk"  // loose chunk files written before region files
+
+#define CHUNK_FILE_SIZE_X       16
+#define CHUNK_FILE_SIZE_Y       128
+#define CHUNK_FILE_SIZE_Z       16
+#define CHUNK_FILE_BLOCK_COUNT  (CHUNK_FILE_SIZE_X * CHUNK_FILE_SIZE_Y * CHUNK_FILE_SIZE_Z)
+
+// block value of blocks which are not stored, the generated terrain is kept for them
+#define CHUNK_FILE_UNCHANGED    0xFF
+
+// appended edits are merged into the column data once there are more of them
+#define CHUNK_FILE_MAX_EDITS    512
+
+/**
+ * Chunk file layout, all values are big endian:
+ *
+ * header   magic (4), version (2), header size (2), chunk x (4), chunk z (4), body size (4),
+ *          size x, size y - 1, size z, reserved (1 byte each)
+ * body     palette size (1), palette block types (1 each),
+ *          per column (x major, then z) runs of length (1) and palette index (1) from y = 0 upwards,
+ *          the index CHUNK_FILE_UNCHANGED marks blocks which are not stored
+ * edits    x, y, z, block type (1 byte each), appended in O(1) until the file is compacted
+ *
+ * Chunk files are stored as records inside of region files, see RegionFile.
+ */
+struct ChunkFileData
+{
+    int32_t X = 0;
+    int32_t Z = 0;
+    uint32_t EditCount = 0;
+    std::vector<uint8_t> Blocks; // CHUNK_FILE_BLOCK_COUNT block types indexed by ChunkFile::GetIndex
+};
+
+struct ChunkFileEdit
+{
+    uint8_t X;
+    uint8_t Y;
+    uint8_t Z;
+    uint8_t Type;
+};
+
+class ChunkFile
+{
+public:
+    static inline uint32_t GetIndex(uint32_t x, uint32_t y, uint32_t z)
+    {
+        return (x * CHUNK_FILE_SIZE_Z + z) * CHUNK_FILE_SIZE_Y + y;
+    }
+
+    /**
+     * @brief Decode decodes a chunk file buffer and applies the appended edits to the column data.
+     * @return false if the buffer is not a valid chunk file.
+     */
+    static bool Decode(const uint8_t* buffer, size_t size, ChunkFileData& data);
+
+    /**
+     * @brief Encode encodes the blocks as palette and rle columns, the buffer contains no edits afterwards.
+     */
+    static bool Encode(const ChunkFileData& data, std::vector<uint8_t>& buffer);
+
+    /**
+     * @brief EncodeEmpty encodes a chunk file without column data, edits can be appended to it.
+     */
+    static void EncodeEmpty(int32_t x, int32_t z, std::vector<uint8_t>& buffer);
+
+    static void EncodeEdit(const ChunkFileEdit& edit, uint8_t* buffer);
+
+    /**
+     * @param size the size of the whole chunk file, the buffer only has to hold the header.
+     * @return the amount of edits appended to the chunk file.
+     */
+    static uint32_t GetEditCount(const uint8_t* buffer, size_t size);
+
+    /**
+     * @brief Read reads a loose chunk file with one read call.
+     */
+    static bool Read(const std::string& filePath, ChunkFileData& data);
+    static bool Write(const std::string& filePath, const ChunkFileData& data);
+
+private:
+    static void WriteHeader(uint8_t* buffer, int32_t x, int32_t z, uint32_t bodySize);
+    static bool ReadHeader(const uint8_t* buffer, size_t size, int32_t& x, int32_t& z, uint32_t& bodySize);
+    static bool ReadBody(const uint8_t* buffer, size_t size, std::vector<uint8_t>& blocks);
+};
+
+#endif // CHUNKFILE_H
@@ -0,0 +1,121 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fstream>
+#include "ChunkFileMigrator.h"
+#include "RegionStorage.h"
+#include "../../utils/Debug.h"
+
+#define TEXT_CHUNK_FILE_EXTENSION ".dat"
+
+static bool HasExtension(const std::string& fileName, const char* extension)
+{
+    const size_t extensionLength = strlen(extension);
+    return fileName.size() > extensionLength && fileName.compare(fileName.size() - extensionLength, extensionLength, extension) == 0;
+}
+
+uint32_t ChunkFileMigrator::MigrateChunkFiles(const std::string& directoryPath, RegionStorage& storage)
+{
+    DIR* directory = opendir(directoryPath.c_str());
+    if (!directory)
+        return 0;
+
+    std::vector<std::string> fileNames;
+    struct dirent* entry;
+    while ((entry = readdir(directory)) != nullptr)
+    {
+        std::string fileName = entry->d_name;
+        if (HasExtension(fileName, TEXT_CHUNK_FILE_EXTENSION) || HasExtension(fileName, CHUNK_FILE_EXTENSION))
+        {
+            fileNames.push_back(fileName);
+        }
+    }
+    closedir(directory);
+
+    uint32_t migratedFiles = 0;
+    for (auto& fileName : fileNames)
+    {
+        const std::string& filePath = directoryPath + "/" + fileName;
+        ChunkFileData data;
+
+        bool bRead = HasExtension(fileName, TEXT_CHUNK_FILE_EXTENSION) ? ReadTextFile(filePath, data) : ChunkFile::Read(filePath, data);
+        if (bRead && storage.SaveChunk(ChunkCoord { data.X, data.Z }, data) && remove(filePath.c_str()) == 0)
+        {
+            migratedFiles++;
+        }
+        else
+        {
+            LOG("ChunkFileMigrator: Could not migrate %s", fileName.c_str());
+        }
+    }
+
+    if (migratedFiles > 0)
+        LOG("ChunkFileMigrator: Migrated %u chunk files", migratedFiles);
+
+    return migratedFiles;
+}
+
+bool ChunkFileMigrator::ReadTextFile(const std::string& filePath, ChunkFileData& data)
+{
+    std::ifstream fstream;
+    fstream.open(filePath);
+    if (!fstream.is_open())
+        return false;
+
+    std::string line;
+    Vector3 chunkCenterPos;
+    std::getline(fstream, line, ';');
+    chunkCenterPos.SetX(std::atof(line.c_str()));
+    std::getline(fstream, line, ';');
+    chunkCenterPos.SetY(std::atof(line.c_str()));
+    std::getline(fstream, line);
+    chunkCenterPos.SetZ(std::atof(line.c_str()));
+
+    ChunkCoord coord = GetChunkCoordByWorldPosition(chunkCenterPos);
+    data.X = coord.X;
+    data.Z = coord.Z;
+    data.Blocks.assign(CHUNK_FILE_BLOCK_COUNT, CHUNK_FILE_UNCHANGED);
+
+    size_t posX, posY, posZ, posValue;
+    while (std::getline(fstream, line))
+    {
+        posX        = line.find("X");
+        posY        = line.find("Y");
+        posZ        = line.find("Z");
+        posValue    = line.find(":");
+
+        if (posX == std::string::npos || posY == std::string::npos || posZ == std::string::npos || posValue == std::string::npos)
+            continue;
+
+        uint32_t x      = std::atoi(line.substr(posX+1, posY - posX).c_str());
+        uint32_t y      = std::atoi(line.substr(posY+1, posZ - posY).c_str());
+        uint32_t z      = std::atoi(line.substr(posZ+1, posValue - posZ).c_str());
+        uint8_t value   = std::atoi(line.substr(posValue+1).c_str());
+
+        if (x < CHUNK_FILE_SIZE_X && y < CHUNK_FILE_SIZE_Y && z < CHUNK_FILE_SIZE_Z)
+            data.Blocks[ChunkFile::GetIndex(x, y, z)] = value;
+    }
+    fstream.close();
+
+    return true;
+}
@@ -0,0 +1,40 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#ifndef CHUNKFILEMIGRATOR_H
+#define CHUNKFILEMIGRATOR_H
+
+#include <stdint.h>
+#include <string>
+
+/**
+ * @brief ChunkFileMigrator
+ * Moves loose chunk files into the region files and deletes them, so it only does work once per world.
+ * Handles the old text format ("cx;cy;cz" header and "X..Y..Z..:type" lines) and loose binary chunk files.
+ */
+class ChunkFileMigrator
+{
+public:
+    static uint32_t MigrateChunkFiles(const std::string& directoryPath, class RegionStorage& storage);
+
+private:
+    static bool ReadTextFile(const std::string& filePath, struct ChunkFileData& data);
+};
+
+#endif // CHUNKFILEMIGRATOR_H
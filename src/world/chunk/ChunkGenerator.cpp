@@ -0,0 +1,103 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#include <algorithm>
+#include "ChunkGenerator.h"
+
+void ChunkGenerator::Generate(const PerlinNoise& noise, const ChunkCoord& coord, ChunkSections& blocks)
+{
+    blocks.Fill(BlockType::AIR);
+
+    for ( uint32_t x = 0; x < CHUNK_SIZE_X; x++)
+    {
+        for ( uint32_t z = 0; z < CHUNK_SIZE_Z; z++)
+        {
+            double xWorld, zWorld;
+            xWorld = (coord.X * CHUNK_BLOCK_SIZE_X + (x * BLOCK_SIZE));
+            zWorld = (coord.Z * CHUNK_BLOCK_SIZE_Z + (z * BLOCK_SIZE));
+
+            uint32_t height = GetTerrainHeight(noise, xWorld, zWorld);
+
+            for (uint32_t y = 0; y < height; y++)
+            {
+                if ( y == height - 1 )
+                {
+                    blocks.Set(x, y, z, BlockType::GRASS);
+                }
+                else if (y <= STONE_LEVEL )
+                {
+                    blocks.Set(x, y, z, BlockType::STONE);
+                }
+                else
+                {
+                    blocks.Set(x, y, z, BlockType::DIRT);
+                }
+            }
+        }
+    }
+
+    CreateTrees(blocks);
+}
+
+uint32_t ChunkGenerator::GetTerrainHeight(const PerlinNoise& noise, double xWorld, double zWorld)
+{
+    return (uint32_t) std::max<double>(CHUNK_MIN_GROUND, std::min<double>((CHUNK_SIZE_Y * noise.GetHeight(xWorld, zWorld)) + CHUNK_MIN_GROUND, CHUNK_SIZE_Y));
+}
+
+void ChunkGenerator::CreateTrees(ChunkSections& blocks)
+{
+    //srand (time(NULL));
+    uint32_t x = 6;//2 + (rand() % (CHUNK_SIZE_X - 4)); // value range 2 - 14
+    //srand (time(NULL));
+    uint32_t z = 8;// + (rand() % (CHUNK_SIZE_Z - 4));
+
+    // the terrain is generated already, the tree grows on top of the column
+    uint32_t y = blocks.GetHeight(x, z);
+
+    if ( y < CHUNK_SIZE_Y - TREE_HIGHT)
+    {
+        if ( blocks.Get(GetChunkBlockIndex(x, y-1, z)) == BlockType::GRASS)
+        {
+
+            for (int8_t i = -2; i <= 2; i++)
+            {
+                for (int8_t j = -2; j <= 2; j++)
+                {
+                    blocks.Set(x+i, y+3, z+j, BlockType::LEAF);
+                    blocks.Set(x+i, y+4, z+j, BlockType::LEAF);
+                }
+            }
+
+            for (int8_t i = -1; i <= 1; i++)
+            {
+                for (int8_t j = -1; j <= 1; j++)
+                {
+                    blocks.Set(x+i, y+5, z+j, BlockType::LEAF);
+                    blocks.Set(x+i, y+6, z+j, ((i % 2) == 0) || ((j % 2) == 0) ? (BlockType::LEAF) : (BlockType::AIR));
+                }
+            }
+
+
+            for (uint32_t i = 0; i < 3; i++)
+            {
+                blocks.Set(x, y+i, z, BlockType::WOOD);
+            }
+        }
+    }
+}
@@ -0,0 +1,45 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#ifndef CHUNKGENERATOR_H
+#define CHUNKGENERATOR_H
+
+#include <stdint.h>
+#include "ChunkData.h"
+#include "ChunkSections.h"
+#include "../PerlinNoise.h"
+
+/**
+ * @brief ChunkGenerator
+ * Generates the terrain and the trees of a chunk from the noise of the world. It only writes the given blocks,
+ * so loader jobs and the host benchmarks can run it without a chunk.
+ */
+class ChunkGenerator
+{
+public:
+    static void Generate(const PerlinNoise& noise, const ChunkCoord& coord, ChunkSections& blocks);
+
+    // height of the generated terrain column at the world position, the trees are not included
+    static uint32_t GetTerrainHeight(const PerlinNoise& noise, double xWorld, double zWorld);
+
+private:
+    static void CreateTrees(ChunkSections& blocks);
+};
+
+#endif // CHUNKGENERATOR_H
@@ -0,0 +1,110 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#include "ChunkHashMap.h"
+
+void ChunkHashMap::Init(uint32_t maxChunks)
+{
+    uint32_t capacity = 8;
+    while (capacity < maxChunks * 2)
+    {
+        capacity <<= 1;
+    }
+
+    m_slots.assign(capacity, Slot());
+    m_mask = capacity - 1;
+    m_size = 0;
+}
+
+void ChunkHashMap::Clear()
+{
+    m_slots.assign(m_slots.size(), Slot());
+    m_size = 0;
+}
+
+void ChunkHashMap::Insert(const ChunkCoord& coord, Chunk* chunk)
+{
+    uint32_t index = GetHomeSlot(coord);
+    while (m_slots[index].ChunkObj)
+    {
+        if (m_slots[index].Coord == coord)
+        {
+            m_slots[index].ChunkObj = chunk;
+            return;
+        }
+        index = (index + 1) & m_mask;
+    }
+
+    m_slots[index].Coord = coord;
+    m_slots[index].ChunkObj = chunk;
+    m_size++;
+}
+
+void ChunkHashMap::Remove(const ChunkCoord& coord, const Chunk* chunk)
+{
+    uint32_t index = GetHomeSlot(coord);
+    while (m_slots[index].ChunkObj)
+    {
+        if (m_slots[index].Coord == coord)
+        {
+            // the coordinate may already belong to another chunk
+            if (m_slots[index].ChunkObj != chunk)
+                return;
+
+            // backward shift deletion, move following entries of the probe sequence into the hole
+            uint32_t hole = index;
+            uint32_t next = (index + 1) & m_mask;
+            while (m_slots[next].ChunkObj)
+            {
+                uint32_t home = GetHomeSlot(m_slots[next].Coord);
+                if (((next - home) & m_mask) >= ((next - hole) & m_mask))
+                {
+                    m_slots[hole] = m_slots[next];
+                    hole = next;
+                }
+                next = (next + 1) & m_mask;
+            }
+
+            m_slots[hole] = Slot();
+            m_size--;
+            return;
+        }
+        index = (index + 1) & m_mask;
+    }
+}
+
+Chunk* ChunkHashMap::Find(const ChunkCoord& coord) const
+{
+    uint32_t index = GetHomeSlot(coord);
+    while (m_slots[index].ChunkObj)
+    {
+        if (m_slots[index].Coord == coord)
+        {
+            return m_slots[index].ChunkObj;
+        }
+        index = (index + 1) & m_mask;
+    }
+
+    return nullptr;
+}
+
+uint32_t ChunkHashMap::GetSize() const
+{
+    return m_size;
+}
@@ -0,0 +1,62 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#ifndef CHUNKHASHMAP_H
+#define CHUNKHASHMAP_H
+
+#include <stdint.h>
+#include <vector>
+#include "ChunkData.h"
+
+/**
+ * @brief ChunkHashMap
+ * Open addressing (linear probing) hash table from chunk coordinates to the cached chunks.
+ * The capacity is fixed at Init to a power of two of at least twice the amount of cached chunks,
+ * so a lookup touches only a few slots and never compares floating point positions.
+ */
+class ChunkHashMap
+{
+public:
+    void Init(uint32_t maxChunks);
+    void Clear();
+
+    void Insert(const ChunkCoord& coord, class Chunk* chunk);
+    void Remove(const ChunkCoord& coord, const class Chunk* chunk);
+    class Chunk* Find(const ChunkCoord& coord) const;
+
+    uint32_t GetSize() const;
+
+private:
+    struct Slot
+    {
+        ChunkCoord  Coord;
+        class Chunk* ChunkObj = nullptr;
+    };
+
+    inline uint32_t GetHomeSlot(const ChunkCoord& coord) const
+    {
+        return ChunkCoordHash()(coord) & m_mask;
+    }
+
+    std::vector<Slot> m_slots;
+    uint32_t m_mask = 0;
+    uint32_t m_size = 0;
+};
+
+#endif // CHUNKHASHMAP_H
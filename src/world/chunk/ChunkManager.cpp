@@ -21,40 +21,51 @@
 #include <algorithm>
 #include "ChunkManager.h"
 #include "ChunkData.h"
-#include "chunkdata.h"
-#include "../../utils/Job.h"
+#include "../../utils/JobSystem.h"
 #include "Chunk.h"
+#include "ChunkFileMigrator.h"
 #include "jobs/ChunkLoaderJob.h"
+#include "jobs/ChunkMeshingJob.h"
 #include "jobs/SerializationJob.h"
 #include "../GameWorld.h"
 #include "../../utils/Filesystem.h"
 #include "../../utils/Debug.h"
+#include "../../utils/MathHelper.h"
 
 ChunkManager::~ChunkManager()
 {
-    m_loaderJob.Stop();
-    m_serializationJob.Stop();
+    // all queued batches are written before the storage is closed
+    FlushEdits();
+    for (auto& job : m_chunkJobs)
+        JobSystem::Wait(job);
+    JobSystem::Wait(m_serializationJob);
+    m_lodTerrain.Destroy();
+    m_regionStorage.Close();
     DestroyChunkCash();
 }
 
 void ChunkManager::Init(const Vector3 &position, GameWorld *world)
 {
     m_world = world;
-    m_serializationJob.Start(QueueJob);
-    m_loaderJob.Start(LoadChunkJob);
+    m_regionStorage.Init(WORLD_PATH);
+    ChunkFileMigrator::MigrateChunkFiles(WORLD_PATH, m_regionStorage);
+    m_lodTerrain.Init(world, &m_regionStorage);
 
-    Vector3 currentChunkPos = GetChunkPositionByWorldPosition(position);
-    const auto& chunkMap = GetChunkMapAround(currentChunkPos);
+    ChunkCoord currentChunkCoord = GetChunkCoordByWorldPosition(position);
+    const auto& chunkMap = GetChunkMapAround(currentChunkCoord);
+    m_chunkMap.Init(chunkMap.size());
+    m_chunkJobs.resize(chunkMap.size());
 
-    for (auto& pos : chunkMap)
+    for (auto& coord : chunkMap)
     {
         Chunk* chunk = new Chunk(*m_world);
         chunk->Init();
-        chunk->SetCenterPosition(pos);
+        chunk->SetCenterPosition(GetChunkCenterPosition(coord));
         m_chunkCash.push_back(chunk);
+        m_chunkMap.Insert(coord, chunk);
     }
 
-    LoadChunks(currentChunkPos);
+    LoadChunks(currentChunkCoord);
 }
 
 const std::vector<Chunk*> ChunkManager::GetLoadedChunks() const
@@ -71,11 +82,14 @@ const std::vector<Chunk*> ChunkManager::GetLoadedChunks() const
     return loadedChunks;
 }
 
-void ChunkManager::UpdateChunksBy(const Vector3 &position)
+void ChunkManager::UpdateChunksBy(const Vector3 &position, const Vector3& rotation)
 {
+    SetViewDirection(rotation);
+
     for (auto it = m_chunkLoadingStage.begin(); it != m_chunkLoadingStage.end(); )
     {
         Chunk* c = (*it);
+        c->CommitLoadedBlocks();
         if(c->IsLoaded() && c->NeighborsLoaded())
         {
             c->SetDirty(true);
@@ -87,51 +101,134 @@ void ChunkManager::UpdateChunksBy(const Vector3 &position)
         }
     }
 
-    Vector3 currentChunkPos = GetChunkPositionByWorldPosition(position);
+    ChunkCoord currentChunkCoord = GetChunkCoordByWorldPosition(position);
 
-    if ( currentChunkPos != m_lastUpdateChunkPos )
+    // chunks which were still busy when the player moved get their new position now
+    if ( currentChunkCoord != m_lastUpdateChunkCoord || m_bChunksPending )
     {        
-        LoadChunks(currentChunkPos);               
+        LoadChunks(currentChunkCoord);               
+    }
+
+    uint32_t currentTime = ticks_to_millisecs(gettime());
+    if ( currentTime - m_lastEditFlush > CHUNK_EDIT_FLUSH_INTERVAL )
+    {
+        FlushEdits();
+        m_lastEditFlush = currentTime;
+    }
+}
+
+void ChunkManager::UpdateMeshes(const Vector3& position, const Vector3& rotation)
+{
+    SetViewDirection(rotation);
+    const ChunkCoord playerCoord = GetChunkCoordByWorldPosition(position);
+    std::vector<uint32_t> chunksToMesh;
+
+    for (uint32_t i = 0; i < m_chunkCash.size(); ++i)
+    {
+        Chunk* chunk = m_chunkCash[i];
+        if (chunk->GetMeshState() == EChunkMeshState::Idle && chunk->IsDirty() && chunk->IsLoaded())
+        {
+            chunksToMesh.push_back(i);
+        }
     }
+
+    auto closerToPlayer = [this, &playerCoord](Chunk* a, Chunk* b)
+    {
+        return GetChunkPriority(playerCoord, a->GetChunkCoord()) < GetChunkPriority(playerCoord, b->GetChunkCoord());
+    };
+
+    std::sort(chunksToMesh.begin(), chunksToMesh.end(), [this, &closerToPlayer](uint32_t a, uint32_t b)
+    {
+        return closerToPlayer(m_chunkCash[a], m_chunkCash[b]);
+    });
+
+    // workers run their newest job first, so the most important chunk is scheduled last
+    for (auto it = chunksToMesh.rbegin(); it != chunksToMesh.rend(); ++it)
+    {
+        const uint32_t index = *it;
+        Chunk* chunk = m_chunkCash[index];
+        chunk->SetMeshQueued();
+        ChunkMeshingData meshingData { chunk, chunk->GetGeneration(), chunk->CreateMeshSnapshot() };
+        MpscRingBuffer<Chunk*, CHUNK_MESHED_QUEUE_SIZE>* meshedChunks = &m_meshedChunks;
+        m_chunkJobs[index] = JobSystem::Schedule([meshingData, meshedChunks]()
+        {
+            MeshChunkJob(meshingData);
+            Chunk* chunk = meshingData.ChunkObj;
+            // a chunk is queued at most once until it is uploaded, so the queue never runs full
+            meshedChunks->TryPush(std::move(chunk));
+        }, m_chunkJobs[index]);
+    }
+
+    m_meshedChunks.Drain(m_chunksToUpload);
+
+    // bound the display list recording per frame to avoid hitches
+    std::sort(m_chunksToUpload.begin(), m_chunksToUpload.end(), closerToPlayer);
+    uint32_t uploads = 0;
+    for (; uploads < m_chunksToUpload.size() && uploads < CHUNK_UPLOADS_PER_FRAME; ++uploads)
+    {
+        m_chunksToUpload[uploads]->UploadMesh();
+    }
+    m_chunksToUpload.erase(m_chunksToUpload.begin(), m_chunksToUpload.begin() + uploads);
+
+    m_lodTerrain.Upload();
+}
+
+uint32_t ChunkManager::GetBlockMemoryUsage() const
+{
+    uint32_t bytes = 0;
+    for (Chunk* chunk : m_chunkCash)
+    {
+        bytes += chunk->GetBlockMemoryUsage();
+    }
+
+    return bytes;
+}
+
+LodTerrain& ChunkManager::GetLodTerrain()
+{
+    return m_lodTerrain;
 }
 
 Chunk* ChunkManager::GetCashedChunkByWorldPosition(const Vector3& worldPosition)
 {
-    return GetChunkFromCash(GetChunkPositionByWorldPosition(worldPosition));
+    return GetChunkFromCash(GetChunkCoordByWorldPosition(worldPosition));
 }
 
 void ChunkManager::Serialize(const BlockChangeData& data)
 {
-    m_serializationJob.Add(data);
+    m_editJournal.Add(data);
 }
 
-std::vector<Chunk *>::iterator ChunkManager::GetCashedChunkIterator(const Vector3 &chunkPosition)
+void ChunkManager::FlushEdits()
 {
-    return std::find_if(m_chunkCash.begin(), m_chunkCash.end(), [&chunkPosition]( const Chunk* chunk){
-        return chunk->GetCenterPosition() == chunkPosition;
-    });
+    if (m_editJournal.IsEmpty())
+        return;
+
+    std::vector<ChunkEditBatch> batches;
+    m_editJournal.TakeAll(batches);
+    for (auto& batch : batches)
+    {
+        batch.Storage = &m_regionStorage;
+        m_serializationJob = JobSystem::Schedule([batch]() { SerializationJob(batch); }, m_serializationJob);
+    }
 }
 
-void ChunkManager::SetChunkNeighbors()
+void ChunkManager::FlushEdits(const ChunkCoord& coord)
 {
-    for (auto cc : m_chunkCash)
+    ChunkEditBatch batch;
+    if (m_editJournal.Take(coord, batch))
     {
-        cc->SetChunkNeighbors();
+        batch.Storage = &m_regionStorage;
+        m_serializationJob = JobSystem::Schedule([batch]() { SerializationJob(batch); }, m_serializationJob);
     }
 }
 
-Vector3 ChunkManager::GetChunkPositionByWorldPosition(const Vector3 &worldPosition)
+void ChunkManager::SetChunkNeighbors()
 {
-    int32_t x = ((int32_t) worldPosition.GetX() / (CHUNK_BLOCK_SIZE_X));
-    int32_t z = ((int32_t) worldPosition.GetZ() / (CHUNK_BLOCK_SIZE_Z));
-
-    double cX, cY, cZ;
-    uint32_t chunkRadius = (CHUNK_BLOCK_SIZE_X / 2);
-    cX = worldPosition.GetX() < 0 ? (x * CHUNK_BLOCK_SIZE_X) - chunkRadius : (x * CHUNK_BLOCK_SIZE_X) + chunkRadius;
-    cY = CHUNK_BLOCK_SIZE_Y / 2;
-    cZ = worldPosition.GetZ() < 0 ? (z * CHUNK_BLOCK_SIZE_X) - chunkRadius : (z * CHUNK_BLOCK_SIZE_X) + chunkRadius;
-
-    return Vector3(cX, cY, cZ);
+    for (auto cc : m_chunkCash)
+    {
+        cc->SetChunkNeighbors();
+    }
 }
 
 void ChunkManager::DestroyChunkCash()
@@ -142,18 +239,21 @@ void ChunkManager::DestroyChunkCash()
     }
 
     m_chunkCash.clear();
+    m_chunkMap.Clear();
 }
 
-void ChunkManager::LoadChunks(const Vector3 &chunkPosition)
+void ChunkManager::LoadChunks(const ChunkCoord& chunkCoord)
 {    
-    auto chunkMap = GetChunkMapAround(chunkPosition);
+    auto chunkMap = GetChunkMapAround(chunkCoord);
     std::vector<Chunk*> chunkPreCashed;
+    std::vector<uint32_t> chunksToLoad;
 
     for(auto it = chunkMap.begin(); it != chunkMap.end();)
     {
-        Vector3 pos = (*it);
-        Chunk* chunk = GetChunkFromCash(pos);
-        if (chunk && chunk->IsLoaded() && IsCloseToChunk(chunkPosition, pos))
+        // a chunk which is still loading for a coordinate of the circle keeps it
+        Chunk* chunk = GetChunkFromCash(*it);
+        if (chunk && IsCloseToChunk(chunkCoord, *it) && (chunk->IsLoaded() ||
+            std::find(m_chunkLoadingStage.begin(), m_chunkLoadingStage.end(), chunk) != m_chunkLoadingStage.end()))
         {
             chunkPreCashed.push_back(chunk);
             it = chunkMap.erase(it);
@@ -164,64 +264,189 @@ void ChunkManager::LoadChunks(const Vector3 &chunkPosition)
         }
     }
 
-    for(uint32_t i = 0; i < m_chunkCash.size(); ++i)
-    {        
-        Chunk* chunk = m_chunkCash[i];
+    // closest chunks in view direction first, the spiral order keeps equal priorities stable
+    std::stable_sort(chunkMap.begin(), chunkMap.end(), [this, &chunkCoord](const ChunkCoord& a, const ChunkCoord& b)
+    {
+        return GetChunkPriority(chunkCoord, a) < GetChunkPriority(chunkCoord, b);
+    });
 
-        auto it = std::find_if(chunkPreCashed.begin(), chunkPreCashed.end(), [&chunk]( const Chunk* cashedChunk){
-                return cashedChunk->GetCenterPosition() == chunk->GetCenterPosition();
-        });
+    // release the coordinates of all reused chunks before handing out the new ones
+    for (uint32_t i = 0; i < m_chunkCash.size(); ++i)
+    {
+        Chunk* chunk = m_chunkCash[i];
+        if (std::find(chunkPreCashed.begin(), chunkPreCashed.end(), chunk) != chunkPreCashed.end())
+            continue;
 
-        if (it != chunkPreCashed.end())
+        // a chunk is only moved once its last load or mesh job is done, otherwise the work of the job is wasted.
+        // It keeps its old coordinate and is moved by one of the next updates
+        if (!JobSystem::IsDone(m_chunkJobs[i]))
             continue;
 
-        const Vector3& cPos = chunkMap.back();
-        chunk->SetCenterPosition(cPos);
+        // the chunk gets evicted, write its pending edits first. New chunks have no coordinate yet
+        if (GetChunkFromCash(chunk->GetChunkCoord()) == chunk)
+        {
+            FlushEdits(chunk->GetChunkCoord());
+            m_chunkMap.Remove(chunk->GetChunkCoord(), chunk);
+        }
+        chunksToLoad.push_back(i);
+    }
+
+    // the most important coordinates are handed out first, the rest waits for the busy chunks
+    m_bChunksPending = chunksToLoad.size() < chunkMap.size();
+
+    // workers run their newest job first, so the most important chunk is scheduled last
+    for (uint32_t i = chunksToLoad.size(); i-- > 0; )
+    {
+        const uint32_t index = chunksToLoad[i];
+        Chunk* chunk = m_chunkCash[index];
+        const ChunkCoord cCoord = chunkMap[i];
+        chunk->SetCenterPosition(GetChunkCenterPosition(cCoord));
+        chunk->DeleteDisplayList();
+        m_chunkMap.Insert(cCoord, chunk);
         chunk->SetLoaded(false);
         m_chunkLoadingStage.push_back(chunk);
-        chunk->Build();
-        chunkMap.pop_back();
-        m_loaderJob.Add(ChunkLoadingData { chunk->GetFilePath(), chunk});
+
+        // the last job of the chunk is done. The load waits for the queued edit batches instead, edits of
+        // the coordinate which were flushed by any earlier update are in the region file before it is read
+        ChunkLoadingData loadingData { cCoord, chunk, chunk->GetGeneration(), &m_regionStorage };
+        m_chunkJobs[index] = JobSystem::Schedule([loadingData]() { LoadChunkJob(loadingData); }, m_serializationJob);
+    }
+
+    m_lastUpdateChunkCoord = chunkCoord;
+    SetChunkNeighbors();
+
+    // the tiles wait for the edits of the evicted chunks to be written
+    m_lodTerrain.Update(chunkCoord, m_viewDistance, m_serializationJob);
+}
+
+void ChunkManager::SetViewDistance(uint32_t viewDistance)
+{
+    viewDistance = std::min<uint32_t>(std::max<uint32_t>(viewDistance, CHUNK_VIEW_DISTANCE_MIN), CHUNK_VIEW_DISTANCE_MAX);
+    if (viewDistance == m_viewDistance)
+        return;
+
+    m_viewDistance = viewDistance;
+    const ChunkCoord center = m_lastUpdateChunkCoord;
+    const uint32_t chunkCount = GetChunkMapAround(center).size();
+
+    // chunks outside of the smaller circle are deleted, the chunks inside are kept as they are
+    for (uint32_t i = m_chunkCash.size(); i-- > 0 && m_chunkCash.size() > chunkCount; )
+    {
+        if (!IsCloseToChunk(center, m_chunkCash[i]->GetChunkCoord()) || GetChunkFromCash(m_chunkCash[i]->GetChunkCoord()) != m_chunkCash[i])
+            DeleteChunk(i);
+    }
+
+    while (m_chunkCash.size() < chunkCount)
+    {
+        Chunk* chunk = new Chunk(*m_world);
+        chunk->Init();
+        m_chunkCash.push_back(chunk);
+        m_chunkJobs.push_back(JobHandle());
+    }
+
+    // the capacity of the map depends on the amount of chunks, chunks outside of the circle stay mapped until
+    // LoadChunks moves them, so their pending edits are still flushed
+    std::vector<Chunk*> mappedChunks;
+    for (Chunk* chunk : m_chunkCash)
+    {
+        if (GetChunkFromCash(chunk->GetChunkCoord()) == chunk)
+            mappedChunks.push_back(chunk);
+    }
+
+    m_chunkMap.Init(chunkCount);
+    for (Chunk* chunk : mappedChunks)
+    {
+        m_chunkMap.Insert(chunk->GetChunkCoord(), chunk);
+    }
+
+    LOG("View distance %u: %u cashed chunks", m_viewDistance, chunkCount);
+    LoadChunks(center);
+}
+
+uint32_t ChunkManager::GetViewDistance() const
+{
+    return m_viewDistance;
+}
+
+void ChunkManager::DeleteChunk(uint32_t index)
+{
+    Chunk* chunk = m_chunkCash[index];
+
+    // the jobs of the chunk have to finish, a finished mesh job may have queued the chunk for the upload
+    JobSystem::Wait(m_chunkJobs[index]);
+    m_meshedChunks.Drain(m_chunksToUpload);
+
+    if (GetChunkFromCash(chunk->GetChunkCoord()) == chunk)
+    {
+        FlushEdits(chunk->GetChunkCoord());
+        m_chunkMap.Remove(chunk->GetChunkCoord(), chunk);
     }
 
-    chunkPreCashed.clear();
-    m_lastUpdateChunkPos = chunkPosition;
+    m_chunkLoadingStage.erase(std::remove(m_chunkLoadingStage.begin(), m_chunkLoadingStage.end(), chunk), m_chunkLoadingStage.end());
+    m_chunksToUpload.erase(std::remove(m_chunksToUpload.begin(), m_chunksToUpload.end(), chunk), m_chunksToUpload.end());
+    m_chunkCash.erase(m_chunkCash.begin() + index);
+    m_chunkJobs.erase(m_chunkJobs.begin() + index);
+
+    // the neighbors must not point to the deleted chunk
+    delete chunk;
     SetChunkNeighbors();
 }
 
-std::vector<Vector3> ChunkManager::GetChunkMapAround(const Vector3 &chunkPosition) const
+void ChunkManager::SetViewDirection(const Vector3& rotation)
 {
-    double x = chunkPosition.GetX() - ((CHUNK_MAP_CASH_X/2)*CHUNK_BLOCK_SIZE_X);
-    double z = chunkPosition.GetZ() + ((CHUNK_MAP_CASH_Y/2)*CHUNK_BLOCK_SIZE_Z);
+    // same convention as the player movement, a yaw of 0 looks along +z
+    const float yaw = rotation.GetY() * DEGREE_TO_RADIANS;
+    m_viewX = sin(yaw);
+    m_viewZ = cos(yaw);
+}
 
-    std::vector<Vector3> chunkMap;
+std::vector<ChunkCoord> ChunkManager::GetChunkMapAround(const ChunkCoord& chunkCoord) const
+{
+    // square rings around the center, walked as a spiral, only the chunks inside the view circle are kept
+    static const int32_t sideSteps[4][2] = { { 0, 1 }, { -1, 0 }, { 0, -1 }, { 1, 0 } };
+    const int32_t radius = m_viewDistance;
+
+    std::vector<ChunkCoord> chunkMap;
+    chunkMap.push_back(chunkCoord);
 
-    for ( uint32_t i = 0; i < CHUNK_MAP_CASH_X; i++)
+    for (int32_t ring = 1; ring <= radius; ++ring)
     {
-        for ( uint32_t j = 0; j < CHUNK_MAP_CASH_Y; j++)
+        ChunkCoord coord { chunkCoord.X + ring, chunkCoord.Z - ring };
+        for (const auto& step : sideSteps)
         {
-            chunkMap.emplace_back(Vector3(x+(i*CHUNK_BLOCK_SIZE_X), CHUNK_BLOCK_SIZE_Y / 2, z-(j*CHUNK_BLOCK_SIZE_Z)));
+            for (int32_t i = 0; i < 2 * ring; ++i)
+            {
+                coord.X += step[0];
+                coord.Z += step[1];
+                if (IsCloseToChunk(chunkCoord, coord))
+                    chunkMap.push_back(coord);
+            }
         }
     }
 
     return chunkMap;
 }
 
-bool ChunkManager::IsCloseToChunk(const Vector3& chunkPosition, const Vector3& position) const
+bool ChunkManager::IsCloseToChunk(const ChunkCoord& chunkCoord, const ChunkCoord& coord) const
 {
-    return ( chunkPosition.GetX() - (CHUNK_BLOCK_SIZE_X) >= position.GetX() ||
-             chunkPosition.GetX() + (CHUNK_BLOCK_SIZE_X) <= position.GetX() ||
-             chunkPosition.GetZ() - (CHUNK_BLOCK_SIZE_Z) >= position.GetZ() ||
-             chunkPosition.GetZ() + (CHUNK_BLOCK_SIZE_Z) <= position.GetZ());
+    // r * (r + 1) rounds the circle outwards, so its border has no single chunks sticking out
+    return GetChunkDistanceSquared(chunkCoord, coord) <= (int32_t) (m_viewDistance * (m_viewDistance + 1));
 }
 
-Chunk* ChunkManager::GetChunkFromCash(const Vector3 &chunkPosition)
+float ChunkManager::GetChunkPriority(const ChunkCoord& chunkCoord, const ChunkCoord& coord) const
 {
-    auto it = GetCashedChunkIterator(chunkPosition);
-    if (it != m_chunkCash.end())
-    {
-        return (*it);
-    }
+    // the distance in chunks, chunks behind the viewer count up to twice as far as chunks in front
+    const float x = coord.X - chunkCoord.X;
+    const float z = coord.Z - chunkCoord.Z;
+    const float distance = sqrt(x * x + z * z);
+    if (distance == 0.0f)
+        return 0.0f;
+
+    const float facing = (x * m_viewX + z * m_viewZ) / distance;
+    return distance * (1.5f - 0.5f * facing);
+}
 
-    return nullptr;
+Chunk* ChunkManager::GetChunkFromCash(const ChunkCoord& coord) const
+{
+    return m_chunkMap.Find(coord);
 }
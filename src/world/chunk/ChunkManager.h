@@ -21,41 +21,103 @@
 #define CHUNKMANAGER_H
 
 #include <vector>
-#include "chunkdata.h"
-#include "../../utils/Job.h"
+#include "ChunkData.h"
+#include "ChunkHashMap.h"
+#include "RegionStorage.h"
+#include "ChunkEditJournal.h"
+#include "LodTerrain.h"
+#include "../../utils/JobSystem.h"
+#include "../../utils/RingBuffer.h"
 #include "../../utils/Vector3.h"
 
+// block edits are written at most once per chunk in this interval (milliseconds)
+#define CHUNK_EDIT_FLUSH_INTERVAL 5000
+
+// meshed chunks recorded into display lists per frame
+#define CHUNK_UPLOADS_PER_FRAME 2
+
+// radius of the cashed chunk circle around the player in chunks
+#define CHUNK_VIEW_DISTANCE_MIN 2
+#define CHUNK_VIEW_DISTANCE_MAX 16
+#define CHUNK_VIEW_DISTANCE_DEFAULT 2
+
+// meshed chunks handed from the workers to the main thread, holds every cashed chunk
+#define CHUNK_MESHED_QUEUE_SIZE 2048
+static_assert(CHUNK_MESHED_QUEUE_SIZE >= (2 * CHUNK_VIEW_DISTANCE_MAX + 1) * (2 * CHUNK_VIEW_DISTANCE_MAX + 1), "every cashed chunk has to fit into the meshed queue");
+
 class ChunkManager
 {
 public:   
     ~ChunkManager();
     void Init(const Vector3 &position, class GameWorld* world);
     const std::vector<Chunk *> GetLoadedChunks() const;
-    void UpdateChunksBy(const Vector3& position);
-    class Chunk* GetChunkFromCash( const Vector3& chunkPosition);    
+
+    /**
+     * @param rotation rotation of the viewer in degrees, chunks in front of it are loaded first.
+     */
+    void UpdateChunksBy(const Vector3& position, const Vector3& rotation);
+
+    /**
+     * @brief UpdateMeshes queues dirty chunks for meshing and uploads meshed chunks, closest to the position
+     * and in view direction first. Has to be called on the main thread with the chunk graphics mode set.
+     */
+    void UpdateMeshes(const Vector3& position, const Vector3& rotation);
+
+    /**
+     * @brief SetViewDistance changes the radius of the cashed chunks, only chunks which enter or leave the circle
+     * are created or deleted, all other chunks keep their blocks and meshes.
+     */
+    void SetViewDistance(uint32_t viewDistance);
+    uint32_t GetViewDistance() const;
+
+    class Chunk* GetChunkFromCash( const ChunkCoord& coord) const;
     class Chunk* GetCashedChunkByWorldPosition(const Vector3& worldPosition);    
 
     void Serialize(const BlockChangeData& data);    
 
+    // bytes used by the block storage of all cashed chunks
+    uint32_t GetBlockMemoryUsage() const;
+
+    // simplified terrain beyond the view distance
+    LodTerrain& GetLodTerrain();
+
 private:
 
-    std::vector<Chunk*>::iterator GetCashedChunkIterator(const Vector3& chunkPosition);
-    Vector3 GetChunkPositionByWorldPosition(const Vector3& worldPosition);
+    void FlushEdits();
+    void FlushEdits(const ChunkCoord& coord);
     void SetChunkNeighbors();   
     void DestroyChunkCash();
-    void LoadChunks(const Vector3& chunkPosition);
-    std::vector<Vector3> GetChunkMapAround(const Vector3& chunkPosition) const;
-    bool IsCloseToChunk(const Vector3 & chunkPosition, const Vector3 &position) const;
+    void LoadChunks(const ChunkCoord& chunkCoord);
+    void DeleteChunk(uint32_t index);
+    void SetViewDirection(const Vector3& rotation);
+    std::vector<ChunkCoord> GetChunkMapAround(const ChunkCoord& chunkCoord) const;
+    bool IsCloseToChunk(const ChunkCoord& chunkCoord, const ChunkCoord& coord) const;
+    float GetChunkPriority(const ChunkCoord& chunkCoord, const ChunkCoord& coord) const;
 
 private:
     std::vector<class Chunk*> m_chunkCash;
     std::vector<class Chunk*> m_chunkLoadingStage;
+    ChunkHashMap m_chunkMap;
+    RegionStorage m_regionStorage;
+    ChunkEditJournal m_editJournal;
+    uint32_t m_lastEditFlush = 0;
 
-    Vector3 m_lastUpdateChunkPos;
+    ChunkCoord m_lastUpdateChunkCoord = { 0, 0 };
+    // some coordinates of the circle have no chunk yet, their chunks were busy with a job
+    bool m_bChunksPending = false;
+    uint32_t m_viewDistance = CHUNK_VIEW_DISTANCE_DEFAULT;
+    // horizontal view direction of the player
+    float m_viewX = 0.0f;
+    float m_viewZ = 1.0f;
     class GameWorld* m_world;
 
-    Job<BlockChangeData> m_serializationJob;
-    Job<ChunkLoadingData> m_loaderJob;
+    // edit batches are written one after another, the last one is the dependency of the next
+    JobHandle m_serializationJob;
+    // last job of each cashed chunk, loading and meshing of one chunk never run at the same time
+    std::vector<JobHandle> m_chunkJobs;
+    MpscRingBuffer<class Chunk*, CHUNK_MESHED_QUEUE_SIZE> m_meshedChunks;
+    std::vector<class Chunk*> m_chunksToUpload;
+    LodTerrain m_lodTerrain;
 };
 
 #endif // CHUNKMANAGER_H
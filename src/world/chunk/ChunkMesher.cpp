@@ -0,0 +1,223 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#include <algorithm>
+#include "ChunkMesher.h"
+
+// greedy quads never leave their section
+static_assert(CHUNK_SECTION_SIZE <= BLOCK_QUAD_MAX_SIZE, "a merged quad of a section has to fit into the chunk texture coordinates");
+
+void ChunkMesher::MeshSection(const ChunkSnapshot& snapshot, uint32_t section, EMeshingMode mode,
+                              SectionRenderList& renderList, std::vector<uint8_t>& faceMasks)
+{
+    renderList.BlockRenderList.clear();
+    renderList.BlockQuadList.clear();
+
+    if (mode == EMeshingMode::Greedy)
+    {
+        // the face masks of a section are a contiguous range of the chunk buffer
+        faceMasks.resize(CHUNK_BLOCK_COUNT);
+        std::fill(faceMasks.begin() + (section << CHUNK_SECTION_SHIFT), faceMasks.begin() + ((section + 1) << CHUNK_SECTION_SHIFT), 0);
+        BuildBlockRenderList(snapshot, section, renderList, faceMasks.data());
+        BuildGreedyRenderList(snapshot, section, renderList, faceMasks.data());
+    }
+    else
+    {
+        BuildBlockRenderList(snapshot, section, renderList, nullptr);
+    }
+}
+
+bool ChunkMesher::IsSectionBuried(const ChunkSnapshot& snapshot, uint32_t section)
+{
+    // the top of the chunk is always drawn, the bottom never, missing neighbor chunks hide the border faces
+    if (section + 1 >= CHUNK_SECTION_COUNT || snapshot.GetState(section + 1) != ESectionState::Opaque)
+        return false;
+    if (section > 0 && snapshot.GetState(section - 1) != ESectionState::Opaque)
+        return false;
+
+    for (uint8_t neighbor = EBlockFaces::Left; neighbor <= EBlockFaces::Back; ++neighbor)
+    {
+        if (snapshot.GetNeighborState(static_cast<EBlockFaces>(neighbor), section) != ESectionState::Opaque)
+            return false;
+    }
+
+    return true;
+}
+
+void ChunkMesher::AddBlock(SectionRenderList& renderList, BlockType type, const BlockRenderVO& blockRenderVO)
+{
+	auto blockRenderListIt = renderList.BlockRenderList.find(type);
+	if (blockRenderListIt != renderList.BlockRenderList.end())
+	{
+        blockRenderListIt->second.emplace_back(blockRenderVO);
+	}
+	else
+	{
+        std::vector<BlockRenderVO> blockList;
+        blockList.emplace_back(blockRenderVO);
+        renderList.BlockRenderList.insert(std::pair<BlockType, std::vector<BlockRenderVO> >(type, blockList ));
+	}
+}
+
+void ChunkMesher::BuildBlockRenderList(const ChunkSnapshot& snapshot, uint32_t section, SectionRenderList& renderList, uint8_t* faceMasks)
+{
+    renderList.Blocks = 0;
+    renderList.Faces = 0;
+    renderList.VisibleFaces = 0;
+
+    const uint32_t minY = section * CHUNK_SECTION_SIZE;
+
+    // y innermost to walk the block buffer linearly
+	for ( uint32_t x = 0; x < CHUNK_SIZE_X; x++)
+	{
+		for ( uint32_t z = 0; z < CHUNK_SIZE_Z; z++ )
+		{
+            // nothing above the highest block of the column can be visible
+            const uint32_t maxY = std::min<uint32_t>(minY + CHUNK_SECTION_SIZE, snapshot.GetHeight(x, z));
+			for ( uint32_t y = minY; y < maxY; y++)
+			{                
+                BlockRenderVO renderVO;
+                if ( IsBlockVisible(snapshot, x, y, z, renderVO))
+				{
+                    if (faceMasks)
+                    {
+                        faceMasks[GetChunkBlockIndex(x, y, z)] = renderVO.FaceMask;
+                    }
+                    else
+                    {
+                        AddBlock(renderList, snapshot.Get(x, y, z), renderVO);
+                    }
+
+                    renderList.Blocks++;
+                    renderList.VisibleFaces += renderVO.Faces;
+                }
+			}
+		}
+	}
+
+    renderList.Faces = renderList.VisibleFaces;
+}
+
+void ChunkMesher::BuildGreedyRenderList(const ChunkSnapshot& snapshot, uint32_t section, SectionRenderList& renderList, const uint8_t* faceMasks)
+{
+    renderList.Faces = 0;
+
+    // slice, column and row sizes (normal, width, height axis) per face in EBlockFaces order, y only spans the section
+    static const uint32_t faceAxisSizes[6][3] =
+    {
+        { CHUNK_SIZE_X, CHUNK_SIZE_Z, CHUNK_SECTION_SIZE }, // left
+        { CHUNK_SIZE_X, CHUNK_SIZE_Z, CHUNK_SECTION_SIZE }, // right
+        { CHUNK_SIZE_Z, CHUNK_SIZE_X, CHUNK_SECTION_SIZE }, // front
+        { CHUNK_SIZE_Z, CHUNK_SIZE_X, CHUNK_SECTION_SIZE }, // back
+        { CHUNK_SECTION_SIZE, CHUNK_SIZE_X, CHUNK_SIZE_Z }, // top
+        { CHUNK_SECTION_SIZE, CHUNK_SIZE_X, CHUNK_SIZE_Z }  // bottom
+    };
+
+    const uint32_t minY = section * CHUNK_SECTION_SIZE;
+    BlockType mask[CHUNK_SECTION_SIZE * CHUNK_SIZE_X];
+
+    for (uint8_t face = EBlockFaces::Left; face <= EBlockFaces::Bottom; ++face)
+    {
+        const uint8_t faceBit = 1 << face;
+        const uint32_t slices = faceAxisSizes[face][0];
+        const uint32_t width  = faceAxisSizes[face][1];
+        const uint32_t height = faceAxisSizes[face][2];
+
+        auto toLocal = [face, minY](uint32_t n, uint32_t u, uint32_t v) -> Vec3i
+        {
+            if (face <= EBlockFaces::Right)
+                return Vec3i { n, minY + v, u };
+            if (face <= EBlockFaces::Back)
+                return Vec3i { u, minY + v, n };
+            return Vec3i { u, minY + n, v };
+        };
+
+        for (uint32_t n = 0; n < slices; ++n)
+        {
+            for (uint32_t v = 0; v < height; ++v)
+            {
+                for (uint32_t u = 0; u < width; ++u)
+                {
+                    Vec3i local = toLocal(n, u, v);
+                    uint32_t index = GetChunkBlockIndex(local.X, local.Y, local.Z);
+                    mask[v * width + u] = (faceMasks[index] & faceBit) ? snapshot.Get(local.X, local.Y, local.Z) : BlockType::AIR;
+                }
+            }
+
+            for (uint32_t v = 0; v < height; ++v)
+            {
+                for (uint32_t u = 0; u < width; )
+                {
+                    BlockType type = mask[v * width + u];
+                    if (type == BlockType::AIR)
+                    {
+                        u++;
+                        continue;
+                    }
+
+                    uint32_t quadWidth = 1;
+                    while (u + quadWidth < width && mask[v * width + u + quadWidth] == type)
+                    {
+                        quadWidth++;
+                    }
+
+                    uint32_t quadHeight = 1;
+                    bool bRowMatches = true;
+                    while (v + quadHeight < height && bRowMatches)
+                    {
+                        for (uint32_t i = 0; i < quadWidth; ++i)
+                        {
+                            if (mask[(v + quadHeight) * width + u + i] != type)
+                            {
+                                bRowMatches = false;
+                                break;
+                            }
+                        }
+
+                        if (bRowMatches)
+                        {
+                            quadHeight++;
+                        }
+                    }
+
+                    for (uint32_t j = 0; j < quadHeight; ++j)
+                    {
+                        for (uint32_t i = 0; i < quadWidth; ++i)
+                        {
+                            mask[(v + j) * width + u + i] = BlockType::AIR;
+                        }
+                    }
+
+                    BlockQuadVO quadVO;
+                    quadVO.Face = face;
+                    quadVO.Width = quadWidth;
+                    quadVO.Height = quadHeight;
+                    Vec3i local = toLocal(n, u, v);
+                    quadVO.X = local.X;
+                    quadVO.Y = local.Y;
+                    quadVO.Z = local.Z;
+                    renderList.BlockQuadList[type].emplace_back(quadVO);
+                    renderList.Faces++;
+
+                    u += quadWidth;
+                }
+            }
+        }
+    }
+}
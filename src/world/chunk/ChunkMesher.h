@@ -0,0 +1,110 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#ifndef CHUNKMESHER_H
+#define CHUNKMESHER_H
+
+#include <stdint.h>
+#include <map>
+#include <vector>
+#include "ChunkData.h"
+#include "ChunkSnapshot.h"
+#include "../blocks/Block.h"
+#include "../../renderer/BlockRenderHelper.h"
+
+// the faces of one section, built by a mesh job and recorded into a display list on the main thread
+struct SectionRenderList
+{
+    std::map<BlockType, std::vector<BlockRenderVO> > BlockRenderList;
+    std::map<BlockType, std::vector<BlockQuadVO> > BlockQuadList;
+    uint32_t Blocks             = 0;
+    uint32_t Faces              = 0;
+    uint32_t VisibleFaces       = 0;
+};
+
+/**
+ * @brief ChunkMesher
+ * Builds the render lists of the sections of a chunk from a ChunkSnapshot. It does not touch the chunk or the GPU,
+ * so the mesh jobs and the host benchmarks run the same code.
+ */
+class ChunkMesher
+{
+public:
+    /**
+     * @brief MeshSection replaces the render list with the visible faces of the section.
+     * @param faceMasks scratch buffer of the greedy mesher, kept by the caller for all sections of a chunk.
+     */
+    static void MeshSection(const ChunkSnapshot& snapshot, uint32_t section, EMeshingMode mode,
+                            SectionRenderList& renderList, std::vector<uint8_t>& faceMasks);
+
+    // a solid section surrounded by solid sections has no visible faces
+    static bool IsSectionBuried(const ChunkSnapshot& snapshot, uint32_t section);
+
+    static void AddBlock(SectionRenderList& renderList, BlockType type, const BlockRenderVO& blockRenderVO);
+
+    /**
+     * Collects the faces of a block which touch air. Faces on the chunk border look into the neighbor chunks,
+     * the top of the chunk is always visible, the bottom never.
+     * TBlocks is a ChunkSnapshot for mesh jobs or the live blocks of a chunk for edits on the main thread.
+     */
+    template<typename TBlocks>
+    static bool IsBlockVisible(const TBlocks& blocks, int32_t iX, int32_t iY, int32_t iZ, BlockRenderVO& blockRenderVO)
+    {
+        // neighbor block offsets in EBlockFaces order
+        static const int32_t FACE_OFFSETS[6][3] = { { -1, 0, 0 }, { 1, 0, 0 }, { 0, 0, 1 }, { 0, 0, -1 }, { 0, 1, 0 }, { 0, -1, 0 } };
+
+        if (blocks.Get(iX, iY, iZ) == BlockType::AIR)
+            return false;
+
+        for (uint8_t face = EBlockFaces::Left; face <= EBlockFaces::Bottom; ++face)
+        {
+            const int32_t y = iY + FACE_OFFSETS[face][1];
+            bool bVisible;
+
+            if (y >= CHUNK_SIZE_Y)
+                bVisible = true;
+            else if (y < 0)
+                bVisible = false;
+            else
+                bVisible = blocks.Get(iX + FACE_OFFSETS[face][0], y, iZ + FACE_OFFSETS[face][2]) == BlockType::AIR;
+
+            if (bVisible)
+            {
+                blockRenderVO.FaceMask |= 1 << face;
+                blockRenderVO.Faces++;
+            }
+        }
+
+        if (blockRenderVO.Faces > 0)
+        {
+            blockRenderVO.X = iX;
+            blockRenderVO.Y = iY;
+            blockRenderVO.Z = iZ;
+            return true;
+        }
+
+        return false;
+    }
+
+private:
+    static void BuildBlockRenderList(const ChunkSnapshot& snapshot, uint32_t section, SectionRenderList& renderList, uint8_t* faceMasks);
+    static void BuildGreedyRenderList(const ChunkSnapshot& snapshot, uint32_t section, SectionRenderList& renderList, const uint8_t* faceMasks);
+};
+
+#endif // CHUNKMESHER_H
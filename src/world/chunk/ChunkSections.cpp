@@ -0,0 +1,130 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#include "ChunkSections.h"
+
+void ChunkSections::Fill(BlockType type)
+{
+    for (Section& section : m_sections)
+    {
+        section.Blocks.Fill(type);
+        section.SolidBlocks = type == BlockType::AIR ? 0 : CHUNK_SECTION_BLOCK_COUNT;
+    }
+
+    memset(m_heights, type == BlockType::AIR ? 0 : CHUNK_SIZE_Y, sizeof(m_heights));
+    memset(m_opaqueHeights, IsOpaque(type) ? CHUNK_SIZE_Y : 0, sizeof(m_opaqueHeights));
+    memset(m_solidHeights, IsOpaque(type) ? CHUNK_SIZE_Y : 0, sizeof(m_solidHeights));
+}
+
+void ChunkSections::Set(uint32_t x, uint32_t y, uint32_t z, BlockType type)
+{
+    const uint32_t index = GetChunkBlockIndex(x, y, z);
+    Section& section = m_sections[index >> CHUNK_SECTION_SHIFT];
+    const uint32_t sectionIndex = index & (CHUNK_SECTION_BLOCK_COUNT - 1);
+    const bool bWasAir = section.Blocks.Get(sectionIndex) == BlockType::AIR;
+    const bool bIsAir = type == BlockType::AIR;
+
+    if (bWasAir && !bIsAir)
+        section.SolidBlocks++;
+    else if (!bWasAir && bIsAir)
+        section.SolidBlocks--;
+
+    section.Blocks.Set(sectionIndex, type);
+
+    // raise the column on top, search the next lower block if the top block was removed
+    uint8_t& height = m_heights[x * CHUNK_SIZE_Z + z];
+    if (!bIsAir && y >= height)
+        height = y + 1;
+    else if (bIsAir && y + 1 == height)
+        height = FindHeight(x, z, y, false);
+
+    uint8_t& opaqueHeight = m_opaqueHeights[x * CHUNK_SIZE_Z + z];
+    if (IsOpaque(type) && y >= opaqueHeight)
+        opaqueHeight = y + 1;
+    else if (!IsOpaque(type) && y + 1 == opaqueHeight)
+        opaqueHeight = FindHeight(x, z, y, true);
+
+    // a gap cuts the solid part of the column, filling the block on top of it grows it up to the next gap
+    uint8_t& solidHeight = m_solidHeights[x * CHUNK_SIZE_Z + z];
+    if (!IsOpaque(type) && y < solidHeight)
+        solidHeight = y;
+    else if (IsOpaque(type) && y == solidHeight)
+        solidHeight = FindSolidHeight(x, z, y + 1);
+}
+
+ESectionState ChunkSections::GetState(uint32_t section) const
+{
+    const uint32_t solidBlocks = m_sections[section].SolidBlocks;
+    if (solidBlocks == 0)
+        return ESectionState::Air;
+    if (solidBlocks == CHUNK_SECTION_BLOCK_COUNT)
+        return ESectionState::Opaque;
+    return ESectionState::Mixed;
+}
+
+void ChunkSections::DecodeColumn(uint32_t x, uint32_t z, uint32_t section, BlockType* out) const
+{
+#ifdef CHUNK_LAYOUT_MORTON
+    for (uint32_t y = 0; y < CHUNK_SECTION_SIZE; ++y)
+    {
+        out[y] = Get(GetChunkBlockIndex(x, section * CHUNK_SECTION_SIZE + y, z));
+    }
+#else
+    // a column of a y-major section is one contiguous run
+    const uint32_t first = GetChunkBlockIndex(x, section * CHUNK_SECTION_SIZE, z) & (CHUNK_SECTION_BLOCK_COUNT - 1);
+    m_sections[section].Blocks.Decode(first, CHUNK_SECTION_SIZE, out);
+#endif
+}
+
+uint32_t ChunkSections::GetMemoryUsage() const
+{
+    uint32_t bytes = 0;
+    for (const Section& section : m_sections)
+    {
+        bytes += section.Blocks.GetMemoryUsage();
+    }
+
+    return bytes;
+}
+
+bool ChunkSections::IsOpaque(BlockType type)
+{
+    return type != BlockType::AIR && type != BlockType::LEAF;
+}
+
+uint32_t ChunkSections::FindSolidHeight(uint32_t x, uint32_t z, uint32_t from) const
+{
+    uint32_t y = from;
+    while (y < CHUNK_SIZE_Y && IsOpaque(Get(GetChunkBlockIndex(x, y, z))))
+        y++;
+
+    return y;
+}
+
+uint32_t ChunkSections::FindHeight(uint32_t x, uint32_t z, uint32_t below, bool bOpaque) const
+{
+    for (uint32_t y = below; y > 0; --y)
+    {
+        BlockType type = Get(GetChunkBlockIndex(x, y - 1, z));
+        if (bOpaque ? IsOpaque(type) : type != BlockType::AIR)
+            return y;
+    }
+
+    return 0;
+}
@@ -0,0 +1,94 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#ifndef CHUNKSECTIONS_H
+#define CHUNKSECTIONS_H
+
+#include <stdint.h>
+#include <string.h>
+#include "ChunkData.h"
+#include "ChunkBlockStorage.h"
+
+/**
+ * @brief ChunkSections
+ * Blocks of a chunk, stored as vertical sections with their own palette.
+ * Every section counts its solid blocks, so it is known without a scan whether it is all air, all solid or mixed.
+ * A heightmap keeps the highest solid and the highest opaque block of every column up to date on every change.
+ * Indices are the flat block indices of GetChunkBlockIndex.
+ */
+class ChunkSections
+{
+public:
+    // all blocks are of the given type afterwards
+    void Fill(BlockType type);
+
+    inline BlockType Get(uint32_t index) const
+    {
+        return m_sections[index >> CHUNK_SECTION_SHIFT].Blocks.Get(index & (CHUNK_SECTION_BLOCK_COUNT - 1));
+    }
+
+    void Set(uint32_t x, uint32_t y, uint32_t z, BlockType type);
+
+    ESectionState GetState(uint32_t section) const;
+
+    // unpacks the CHUNK_SECTION_SIZE blocks of a column inside a section, bottom to top
+    void DecodeColumn(uint32_t x, uint32_t z, uint32_t section, BlockType* out) const;
+
+    // one above the highest non air block of the column, 0 for an empty column
+    inline uint32_t GetHeight(uint32_t x, uint32_t z) const
+    {
+        return m_heights[x * CHUNK_SIZE_Z + z];
+    }
+
+    // one above the highest block of the column which can not be seen through (not air and no leaves)
+    inline uint32_t GetOpaqueHeight(uint32_t x, uint32_t z) const
+    {
+        return m_opaqueHeights[x * CHUNK_SIZE_Z + z];
+    }
+
+    // number of opaque blocks from the bottom of the column up to the first gap, they hide everything behind them
+    inline uint32_t GetSolidHeight(uint32_t x, uint32_t z) const
+    {
+        return m_solidHeights[x * CHUNK_SIZE_Z + z];
+    }
+
+    // bytes of all section palettes and indices
+    uint32_t GetMemoryUsage() const;
+
+    static bool IsOpaque(BlockType type);
+
+private:
+    uint32_t FindHeight(uint32_t x, uint32_t z, uint32_t below, bool bOpaque) const;
+    uint32_t FindSolidHeight(uint32_t x, uint32_t z, uint32_t from) const;
+
+    struct Section
+    {
+        Section() : Blocks(CHUNK_SECTION_BLOCK_COUNT) {}
+
+        ChunkBlockStorage Blocks;
+        uint32_t SolidBlocks = 0;
+    };
+
+    Section m_sections[CHUNK_SECTION_COUNT];
+    uint8_t m_heights[CHUNK_SIZE_X * CHUNK_SIZE_Z];
+    uint8_t m_opaqueHeights[CHUNK_SIZE_X * CHUNK_SIZE_Z];
+    uint8_t m_solidHeights[CHUNK_SIZE_X * CHUNK_SIZE_Z];
+};
+
+#endif // CHUNKSECTIONS_H
@@ -0,0 +1,91 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#include <algorithm>
+#include "ChunkSnapshot.h"
+
+ChunkSnapshot::ChunkSnapshot(const ChunkSections& blocks, const ChunkSections* const neighbors[CHUNK_NEIGHBOR_COUNT], uint32_t sections)
+{
+    m_minSection = CHUNK_SECTION_COUNT;
+    m_maxSection = 0;
+    for (uint32_t section = 0; section < CHUNK_SECTION_COUNT; ++section)
+    {
+        if (sections & (1u << section))
+        {
+            m_minSection = std::min(m_minSection, section);
+            m_maxSection = section;
+        }
+    }
+
+    // faces on the top and bottom of a section look into the sections above and below
+    if (m_minSection > m_maxSection)
+        m_minSection = m_maxSection;
+    if (m_minSection > 0)
+        m_minSection--;
+    if (m_maxSection + 1 < CHUNK_SECTION_COUNT)
+        m_maxSection++;
+
+    m_minY = m_minSection * CHUNK_SECTION_SIZE;
+    m_sizeY = (m_maxSection + 1 - m_minSection) * CHUNK_SECTION_SIZE;
+    m_blocks.resize(CHUNK_SNAPSHOT_SIZE_X * CHUNK_SNAPSHOT_SIZE_Z * m_sizeY, BlockType::AIR);
+
+    for (uint32_t x = 0; x < CHUNK_SIZE_X; ++x)
+    {
+        for (uint32_t z = 0; z < CHUNK_SIZE_Z; ++z)
+        {
+            CaptureColumn(&blocks, x, z, x, z);
+            m_heights[x * CHUNK_SIZE_Z + z] = blocks.GetHeight(x, z);
+        }
+    }
+
+    for (uint32_t i = 0; i < CHUNK_SIZE_X; ++i)
+    {
+        CaptureColumn(neighbors[EBlockFaces::Left], CHUNK_SIZE_X - 1, i, -1, i);
+        CaptureColumn(neighbors[EBlockFaces::Right], 0, i, CHUNK_SIZE_X, i);
+        CaptureColumn(neighbors[EBlockFaces::Front], i, 0, i, CHUNK_SIZE_Z);
+        CaptureColumn(neighbors[EBlockFaces::Back], i, CHUNK_SIZE_Z - 1, i, -1);
+    }
+
+    for (uint32_t section = 0; section < CHUNK_SECTION_COUNT; ++section)
+    {
+        m_states[section] = blocks.GetState(section);
+        for (uint32_t neighbor = 0; neighbor < CHUNK_NEIGHBOR_COUNT; ++neighbor)
+        {
+            m_neighborStates[neighbor][section] = neighbors[neighbor] ? neighbors[neighbor]->GetState(section) : ESectionState::Opaque;
+        }
+    }
+}
+
+void ChunkSnapshot::CaptureColumn(const ChunkSections* blocks, uint32_t x, uint32_t z, int32_t snapshotX, int32_t snapshotZ)
+{
+    BlockType* column = &m_blocks[((snapshotX + 1) * CHUNK_SNAPSHOT_SIZE_Z + (snapshotZ + 1)) * m_sizeY];
+
+    for (uint32_t section = m_minSection; section <= m_maxSection; ++section)
+    {
+        BlockType* out = column + (section - m_minSection) * CHUNK_SECTION_SIZE;
+        if (blocks)
+        {
+            blocks->DecodeColumn(x, z, section, out);
+        }
+        else
+        {
+            std::fill(out, out + CHUNK_SECTION_SIZE, CHUNK_SNAPSHOT_MISSING_BLOCK);
+        }
+    }
+}
@@ -0,0 +1,90 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#ifndef CHUNKSNAPSHOT_H
+#define CHUNKSNAPSHOT_H
+
+#include <stdint.h>
+#include <vector>
+#include "ChunkData.h"
+#include "ChunkSections.h"
+#include "../blocks/Block.h"
+
+#define CHUNK_SNAPSHOT_SIZE_X (CHUNK_SIZE_X + 2)
+#define CHUNK_SNAPSHOT_SIZE_Z (CHUNK_SIZE_Z + 2)
+
+// the horizontal neighbors of a chunk, indexed by EBlockFaces::Left to EBlockFaces::Back
+#define CHUNK_NEIGHBOR_COUNT 4
+
+// stands in for the blocks of a missing neighbor, any solid type hides the border faces
+#define CHUNK_SNAPSHOT_MISSING_BLOCK BlockType::STONE
+
+/**
+ * @brief ChunkSnapshot
+ * Immutable copy of the blocks a mesh job needs: the sections to mesh and the sections above and below them,
+ * padded with the border column of every neighbor chunk. It is captured on the main thread when the mesh is queued,
+ * so the mesh job never touches the blocks of a chunk while they are changed.
+ * A missing neighbor is captured as solid blocks, so no faces are built towards it.
+ */
+class ChunkSnapshot
+{
+public:
+    /**
+     * @param neighbors ChunkSections of the neighbors in EBlockFaces order (left, right, front, back), nullptr for missing neighbors.
+     * @param sections bit mask of the sections which are meshed.
+     */
+    ChunkSnapshot(const ChunkSections& blocks, const ChunkSections* const neighbors[CHUNK_NEIGHBOR_COUNT], uint32_t sections);
+
+    // x and z may be -1 and CHUNK_SIZE to read the border of the neighbors, y has to be inside the captured sections
+    inline BlockType Get(int32_t x, int32_t y, int32_t z) const
+    {
+        return m_blocks[((x + 1) * CHUNK_SNAPSHOT_SIZE_Z + (z + 1)) * m_sizeY + (y - m_minY)];
+    }
+
+    inline uint32_t GetHeight(uint32_t x, uint32_t z) const
+    {
+        return m_heights[x * CHUNK_SIZE_Z + z];
+    }
+
+    inline ESectionState GetState(uint32_t section) const
+    {
+        return m_states[section];
+    }
+
+    // missing neighbors are reported as opaque
+    inline ESectionState GetNeighborState(EBlockFaces neighbor, uint32_t section) const
+    {
+        return m_neighborStates[neighbor][section];
+    }
+
+private:
+    void CaptureColumn(const ChunkSections* blocks, uint32_t x, uint32_t z, int32_t snapshotX, int32_t snapshotZ);
+
+private:
+    int32_t m_minY;
+    int32_t m_sizeY;
+    uint32_t m_minSection;
+    uint32_t m_maxSection;
+    std::vector<BlockType> m_blocks;
+    uint8_t m_heights[CHUNK_SIZE_X * CHUNK_SIZE_Z];
+    ESectionState m_states[CHUNK_SECTION_COUNT];
+    ESectionState m_neighborStates[CHUNK_NEIGHBOR_COUNT][CHUNK_SECTION_COUNT];
+};
+
+#endif // CHUNKSNAPSHOT_H
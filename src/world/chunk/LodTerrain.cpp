@@ -0,0 +1,243 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#include <algorithm>
+#include <unordered_map>
+#include "LodTerrain.h"
+#include "jobs/LodTileJob.h"
+#include "../GameWorld.h"
+#include "../FrustumCuller.h"
+#include "../../renderer/BlockRenderer.h"
+#include "../../renderer/MasterRenderer.h"
+#include "../../utils/Debug.h"
+
+void LodTerrain::Init(GameWorld* world, RegionStorage* storage)
+{
+    m_world = world;
+    m_storage = storage;
+}
+
+void LodTerrain::Destroy()
+{
+    for (Tile* tile : m_tiles)
+    {
+        // the job reads the region storage, it has to finish before the storage is closed
+        JobSystem::Wait(tile->Job);
+        DeleteTile(tile);
+    }
+
+    m_tiles.clear();
+    m_viewDistance = 0;
+}
+
+int32_t LodTerrain::GetLevel(int32_t distanceSquared, uint32_t viewDistance)
+{
+    // same rounded circles as the cashed chunks
+    for (int32_t level = 0; level <= LOD_LEVELS; ++level)
+    {
+        const int32_t radius = (level + 1) * viewDistance;
+        if (distanceSquared <= radius * (radius + 1))
+            return level;
+    }
+
+    return -1;
+}
+
+void LodTerrain::Update(const ChunkCoord& center, uint32_t viewDistance, const JobHandle& dependency)
+{
+    if (center == m_center && viewDistance == m_viewDistance)
+        return;
+
+    m_center = center;
+    m_viewDistance = viewDistance;
+
+    // the rings hold thousands of tiles at large view distances, so the old tiles are looked up by their coordinates
+    std::unordered_map<ChunkCoord, Tile*, ChunkCoordHash> oldTiles;
+    oldTiles.reserve(m_tiles.size());
+    for (Tile* tile : m_tiles)
+    {
+        oldTiles.emplace(tile->Coord, tile);
+    }
+    m_tiles.clear();
+
+    std::vector<Tile*> newTiles;
+    const int32_t radius = (LOD_LEVELS + 1) * viewDistance;
+    for (int32_t x = -radius; x <= radius; ++x)
+    {
+        for (int32_t z = -radius; z <= radius; ++z)
+        {
+            const int32_t level = GetLevel(x * x + z * z, viewDistance);
+            if (level <= 0)
+                continue;
+
+            const ChunkCoord coord { center.X + x, center.Z + z };
+            auto it = oldTiles.find(coord);
+            if (it != oldTiles.end() && it->second->Level == (uint32_t) level)
+            {
+                m_tiles.push_back(it->second);
+                oldTiles.erase(it);
+                continue;
+            }
+
+            Tile* tile = new Tile();
+            tile->Coord = coord;
+            tile->Level = level;
+            tile->Mesh = std::make_shared<LodMesh>();
+
+            // the tile at the old level stays visible until the new one is uploaded
+            if (it != oldTiles.end())
+            {
+                Tile* replaced = it->second;
+                oldTiles.erase(it);
+                if (replaced->DisplayList.Data)
+                {
+                    if (replaced->Replaced)
+                        DeleteTile(replaced->Replaced);
+                    replaced->Replaced = nullptr;
+                    tile->Replaced = replaced;
+                }
+                else
+                {
+                    // nothing uploaded yet, the new tile draws what the replaced one was drawing
+                    tile->Replaced = replaced->Replaced;
+                    replaced->Replaced = nullptr;
+                    DeleteTile(replaced);
+                }
+            }
+
+            m_tiles.push_back(tile);
+            newTiles.push_back(tile);
+        }
+    }
+
+    for (auto& oldTile : oldTiles)
+    {
+        DeleteTile(oldTile.second);
+    }
+
+    // closest tiles are uploaded first, workers run their newest job first so they are scheduled last
+    auto closerToCenter = [&center](const Tile* a, const Tile* b)
+    {
+        return GetChunkDistanceSquared(a->Coord, center) < GetChunkDistanceSquared(b->Coord, center);
+    };
+    std::sort(m_tiles.begin(), m_tiles.end(), closerToCenter);
+    std::sort(newTiles.begin(), newTiles.end(), closerToCenter);
+
+    for (auto it = newTiles.rbegin(); it != newTiles.rend(); ++it)
+    {
+        Tile* tile = *it;
+        LodTileData tileData { tile->Coord, tile->Level, m_world->GetNoise(), m_storage, tile->Mesh };
+        tile->Job = JobSystem::Schedule([tileData]() { LodTileJob(tileData); }, dependency);
+    }
+
+    LOG("LOD rings around %d,%d: %u tiles, %u new", center.X, center.Z, (uint32_t) m_tiles.size(), (uint32_t) newTiles.size());
+}
+
+void LodTerrain::Upload()
+{
+    uint32_t uploads = 0;
+    for (Tile* tile : m_tiles)
+    {
+        if (uploads >= LOD_UPLOADS_PER_FRAME)
+            break;
+
+        if (!tile->Mesh || !JobSystem::IsDone(tile->Job))
+            continue;
+
+        BlockRenderer blockRenderer;
+        if (tile->Mesh->Faces > 0)
+        {
+            DisplayListArena::Begin(MasterRenderer::GetDisplayListSizeForChunkFaces(tile->Mesh->Faces));
+            for (auto it = tile->Mesh->Quads.begin(); it != tile->Mesh->Quads.end(); ++it)
+            {
+                Block* pBlockToRender = m_world->GetBlockManager().GetBlockByType(it->first);
+                blockRenderer.Prepare(&it->second, *pBlockToRender);
+                blockRenderer.Draw();
+            }
+            blockRenderer.Finish();
+            DisplayListArena::End(tile->DisplayList);
+        }
+
+        tile->Faces = tile->Mesh->Faces;
+        tile->Mesh.reset();
+        tile->Job.reset();
+        uploads++;
+
+        if (tile->Replaced)
+        {
+            DeleteTile(tile->Replaced);
+            tile->Replaced = nullptr;
+        }
+    }
+}
+
+void LodTerrain::Render(const FrustumCuller& culler)
+{
+    CullBox box;
+    box.Bounds[1] = LOD_SKIRT_BOTTOM * BLOCK_SIZE - BLOCK_SIZE_HALF;
+    box.Bounds[4] = CHUNK_BLOCK_SIZE_Y - BLOCK_SIZE_HALF;
+
+    // the chunks may not have drawn anything this frame
+    m_world->GetBlockManager().GetAtlas().Bind();
+
+    for (Tile* tile : m_tiles)
+    {
+        Tile* drawn = tile->DisplayList.Data ? tile : tile->Replaced;
+        if (!drawn || !drawn->DisplayList.Data)
+            continue;
+
+        // same block grid as the chunks, see Chunk::Render
+        const float minX = drawn->Coord.X * CHUNK_BLOCK_SIZE_X - BLOCK_SIZE_HALF;
+        const float minZ = drawn->Coord.Z * CHUNK_BLOCK_SIZE_Z - BLOCK_SIZE_HALF;
+        box.Bounds[0] = minX;
+        box.Bounds[2] = minZ;
+        box.Bounds[3] = minX + CHUNK_BLOCK_SIZE_X;
+        box.Bounds[5] = minZ + CHUNK_BLOCK_SIZE_Z;
+        uint8_t planeMask = FRUSTUM_ALL_PLANES;
+        uint8_t cachedPlane = 0;
+        if (culler.TestBox(box, planeMask, cachedPlane) == ECullResult::Outside)
+            continue;
+
+        MasterRenderer::LoadChunkMatrix(minX, -BLOCK_SIZE_HALF, minZ, BLOCK_SIZE);
+        GX_CallDispList(drawn->DisplayList.Data, drawn->DisplayList.Size);
+    }
+}
+
+uint32_t LodTerrain::GetTileCount() const
+{
+    return m_tiles.size();
+}
+
+uint32_t LodTerrain::GetAmountOfFaces() const
+{
+    uint32_t faces = 0;
+    for (const Tile* tile : m_tiles)
+        faces += tile->Faces;
+    return faces;
+}
+
+void LodTerrain::DeleteTile(Tile* tile)
+{
+    // a running job only writes into its own mesh, which it keeps alive
+    if (tile->Replaced)
+        DeleteTile(tile->Replaced);
+
+    DisplayListArena::Release(tile->DisplayList);
+    delete tile;
+}
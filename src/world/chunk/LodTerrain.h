@@ -0,0 +1,113 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#ifndef LODTERRAIN_H
+#define LODTERRAIN_H
+
+#include <stdint.h>
+#include <map>
+#include <memory>
+#include <vector>
+#include "ChunkData.h"
+#include "../PerlinNoise.h"
+#include "../../renderer/BlockRenderHelper.h"
+#include "../../renderer/DisplayListArena.h"
+#include "../../utils/JobSystem.h"
+
+// rings of simplified terrain beyond the view distance, ring n reaches (n + 1) view distances and merges 2^n x 2^n block columns
+#define LOD_LEVELS 3
+
+// tiles recorded into display lists per frame
+#define LOD_UPLOADS_PER_FRAME 4
+
+/**
+ * Quads of a tile, built by a LOD job.
+ */
+struct LodMesh
+{
+    std::map<BlockType, std::vector<BlockQuadVO> > Quads;
+    uint32_t Faces = 0;
+};
+
+struct LodTileData
+{
+    ChunkCoord                  Coord;
+    uint32_t                    Level;
+    PerlinNoise                 Noise;
+    class RegionStorage*        Storage;
+    std::shared_ptr<LodMesh>    Mesh;
+};
+
+/**
+ * @brief LodTerrain
+ * Height field tiles for the chunks outside of the view distance. A tile covers one chunk column and is built
+ * straight from the terrain noise and the saved edits, it keeps no blocks. Every cell of a tile is a column of
+ * merged blocks with the height of its center block (or of the highest edited block), borders of the tiles
+ * get skirts down to the lowest terrain, so no cracks show between tiles of different levels or loaded chunks.
+ */
+class LodTerrain
+{
+public:
+    void Init(class GameWorld* world, class RegionStorage* storage);
+
+    // releases all tiles, waits for the running jobs
+    void Destroy();
+
+    /**
+     * @brief Update moves the rings to the center, only tiles which enter the rings or change their level are built.
+     * @param dependency tile jobs run after this job, so edits which are written by it are included.
+     */
+    void Update(const ChunkCoord& center, uint32_t viewDistance, const JobHandle& dependency);
+
+    /**
+     * @brief Upload records built tiles into display lists, has to run on the main thread with the chunk graphics mode set.
+     */
+    void Upload();
+    void Render(const class FrustumCuller& culler);
+
+    uint32_t GetTileCount() const;
+    uint32_t GetAmountOfFaces() const;
+
+    // level of the chunk at the squared distance to the center, 0 for loaded chunks and -1 outside of the rings
+    static int32_t GetLevel(int32_t distanceSquared, uint32_t viewDistance);
+
+private:
+    struct Tile
+    {
+        ChunkCoord Coord;
+        uint32_t Level;
+        JobHandle Job;
+        std::shared_ptr<LodMesh> Mesh;
+        DisplayListHandle DisplayList;
+        uint32_t Faces = 0;
+        // the tile of the coordinate at the previous level, drawn until this tile is uploaded
+        Tile* Replaced = nullptr;
+    };
+
+    void DeleteTile(Tile* tile);
+
+private:
+    class GameWorld* m_world = nullptr;
+    class RegionStorage* m_storage = nullptr;
+    std::vector<Tile*> m_tiles;
+    ChunkCoord m_center = { 0, 0 };
+    uint32_t m_viewDistance = 0;
+};
+
+#endif // LODTERRAIN_H
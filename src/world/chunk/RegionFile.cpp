@@ -0,0 +1,295 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#include <string.h>
+#include "RegionFile.h"
+
+#define REGION_RECORD_LENGTH_SIZE 4
+
+static inline uint32_t GetFirstSector(uint32_t entry)
+{
+    return entry >> 8;
+}
+
+static inline uint32_t GetSectorCount(uint32_t entry)
+{
+    return entry & 0xFF;
+}
+
+static inline uint32_t GetSectorsForSize(uint32_t size)
+{
+    return (size + REGION_RECORD_LENGTH_SIZE + REGION_SECTOR_SIZE - 1) / REGION_SECTOR_SIZE;
+}
+
+static inline void WriteU32(uint8_t* buffer, uint32_t value)
+{
+    buffer[0] = (uint8_t) (value >> 24);
+    buffer[1] = (uint8_t) (value >> 16);
+    buffer[2] = (uint8_t) (value >> 8);
+    buffer[3] = (uint8_t) value;
+}
+
+static inline uint32_t ReadU32(const uint8_t* buffer)
+{
+    return ((uint32_t) buffer[0] << 24) | ((uint32_t) buffer[1] << 16) | ((uint32_t) buffer[2] << 8) | (uint32_t) buffer[3];
+}
+
+RegionFile::~RegionFile()
+{
+    Close();
+}
+
+bool RegionFile::Open(const std::string& filePath, bool bCreate)
+{
+    Close();
+
+    uint8_t header[REGION_CHUNK_COUNT * 4];
+    m_file = fopen(filePath.c_str(), "r+b");
+    if (m_file)
+    {
+        if (fread(header, 1, sizeof(header), m_file) != sizeof(header))
+        {
+            Close();
+            return false;
+        }
+    }
+    else
+    {
+        if (!bCreate)
+            return false;
+
+        m_file = fopen(filePath.c_str(), "w+b");
+        if (!m_file)
+            return false;
+
+        memset(header, 0, sizeof(header));
+        if (fwrite(header, 1, sizeof(header), m_file) != sizeof(header))
+        {
+            Close();
+            return false;
+        }
+    }
+
+    fseek(m_file, 0, SEEK_END);
+    uint32_t sectors = (ftell(m_file) + REGION_SECTOR_SIZE - 1) / REGION_SECTOR_SIZE;
+    m_usedSectors.assign(sectors, false);
+    SetSectorsUsed(0, REGION_HEADER_SECTORS, true);
+
+    for (uint32_t i = 0; i < REGION_CHUNK_COUNT; ++i)
+    {
+        m_table[i] = ReadU32(&header[i * 4]);
+        uint32_t first = GetFirstSector(m_table[i]);
+        uint32_t count = GetSectorCount(m_table[i]);
+
+        // drop entries which point outside of the file or into the header
+        if (count == 0 || first < REGION_HEADER_SECTORS || first + count > sectors)
+        {
+            m_table[i] = 0;
+            continue;
+        }
+
+        SetSectorsUsed(first, count, true);
+    }
+
+    return true;
+}
+
+void RegionFile::Close()
+{
+    if (m_file)
+    {
+        fclose(m_file);
+        m_file = nullptr;
+    }
+    m_usedSectors.clear();
+}
+
+bool RegionFile::IsOpen() const
+{
+    return m_file != nullptr;
+}
+
+bool RegionFile::HasRecord(uint32_t index) const
+{
+    return index < REGION_CHUNK_COUNT && m_table[index] != 0;
+}
+
+bool RegionFile::Read(uint32_t index, std::vector<uint8_t>& record)
+{
+    if (!m_file || !HasRecord(index))
+        return false;
+
+    // read all sectors of the record at once, the length is at the start of the first one
+    const uint32_t entry = m_table[index];
+    std::vector<uint8_t> sectors(GetSectorCount(entry) * REGION_SECTOR_SIZE);
+    fseek(m_file, GetFirstSector(entry) * REGION_SECTOR_SIZE, SEEK_SET);
+    if (fread(sectors.data(), 1, sectors.size(), m_file) != sectors.size())
+        return false;
+
+    uint32_t size = ReadU32(sectors.data());
+    if (size > sectors.size() - REGION_RECORD_LENGTH_SIZE)
+        return false;
+
+    record.assign(sectors.begin() + REGION_RECORD_LENGTH_SIZE, sectors.begin() + REGION_RECORD_LENGTH_SIZE + size);
+    return true;
+}
+
+bool RegionFile::ReadHead(uint32_t index, uint8_t* buffer, uint32_t& size)
+{
+    uint32_t recordSize = 0;
+    if (!ReadRecordSize(index, recordSize))
+        return false;
+
+    uint32_t bytesToRead = size < recordSize ? size : recordSize;
+    if (fread(buffer, 1, bytesToRead, m_file) != bytesToRead)
+        return false;
+
+    size = recordSize;
+    return true;
+}
+
+bool RegionFile::Write(uint32_t index, const uint8_t* data, uint32_t size)
+{
+    if (!m_file || index >= REGION_CHUNK_COUNT)
+        return false;
+
+    const uint32_t sectorCount = GetSectorsForSize(size);
+    if (sectorCount > REGION_MAX_SECTORS)
+        return false;
+
+    // the record goes to free sectors and the old one stays valid until the table points to the new one,
+    // so a write which is interrupted loses the change but never the chunk
+    const uint32_t oldEntry = m_table[index];
+    const uint32_t first = AllocateSectors(sectorCount);
+
+    std::vector<uint8_t> sectors(sectorCount * REGION_SECTOR_SIZE, 0);
+    WriteU32(sectors.data(), size);
+    memcpy(sectors.data() + REGION_RECORD_LENGTH_SIZE, data, size);
+
+    fseek(m_file, first * REGION_SECTOR_SIZE, SEEK_SET);
+    if (fwrite(sectors.data(), 1, sectors.size(), m_file) != sectors.size() || fflush(m_file) != 0)
+    {
+        SetSectorsUsed(first, sectorCount, false);
+        return false;
+    }
+
+    m_table[index] = (first << 8) | sectorCount;
+    if (!WriteTableEntry(index))
+    {
+        m_table[index] = oldEntry;
+        SetSectorsUsed(first, sectorCount, false);
+        return false;
+    }
+
+    if (oldEntry != 0)
+        SetSectorsUsed(GetFirstSector(oldEntry), GetSectorCount(oldEntry), false);
+    return true;
+}
+
+bool RegionFile::Append(uint32_t index, const uint8_t* data, uint32_t size, uint32_t& recordSize)
+{
+    uint32_t currentSize = 0;
+    if (!ReadRecordSize(index, currentSize))
+        return false;
+
+    recordSize = currentSize + size;
+    const uint32_t entry = m_table[index];
+
+    if (GetSectorsForSize(recordSize) <= GetSectorCount(entry))
+    {
+        // the data fits behind the record, only the data and the new length are written
+        uint8_t length[REGION_RECORD_LENGTH_SIZE];
+        WriteU32(length, recordSize);
+
+        const long offset = GetFirstSector(entry) * REGION_SECTOR_SIZE;
+        fseek(m_file, offset + REGION_RECORD_LENGTH_SIZE + currentSize, SEEK_SET);
+        if (fwrite(data, 1, size, m_file) != size)
+            return false;
+
+        fseek(m_file, offset, SEEK_SET);
+        return fwrite(length, 1, REGION_RECORD_LENGTH_SIZE, m_file) == REGION_RECORD_LENGTH_SIZE;
+    }
+
+    std::vector<uint8_t> record;
+    if (!Read(index, record))
+        return false;
+
+    record.insert(record.end(), data, data + size);
+    return Write(index, record.data(), record.size());
+}
+
+bool RegionFile::ReadRecordSize(uint32_t index, uint32_t& size)
+{
+    if (!m_file || !HasRecord(index))
+        return false;
+
+    uint8_t length[REGION_RECORD_LENGTH_SIZE];
+    fseek(m_file, GetFirstSector(m_table[index]) * REGION_SECTOR_SIZE, SEEK_SET);
+    if (fread(length, 1, REGION_RECORD_LENGTH_SIZE, m_file) != REGION_RECORD_LENGTH_SIZE)
+        return false;
+
+    size = ReadU32(length);
+    return size <= GetSectorCount(m_table[index]) * REGION_SECTOR_SIZE - REGION_RECORD_LENGTH_SIZE;
+}
+
+bool RegionFile::WriteTableEntry(uint32_t index)
+{
+    uint8_t entry[4];
+    WriteU32(entry, m_table[index]);
+    fseek(m_file, index * 4, SEEK_SET);
+    bool bWritten = fwrite(entry, 1, sizeof(entry), m_file) == sizeof(entry);
+    return fflush(m_file) == 0 && bWritten;
+}
+
+uint32_t RegionFile::AllocateSectors(uint32_t count)
+{
+    // first fit, grow the file if no free run is large enough
+    uint32_t runStart = 0;
+    uint32_t runLength = 0;
+    for (uint32_t i = REGION_HEADER_SECTORS; i < m_usedSectors.size(); ++i)
+    {
+        if (m_usedSectors[i])
+        {
+            runLength = 0;
+            continue;
+        }
+
+        if (runLength == 0)
+            runStart = i;
+
+        if (++runLength == count)
+        {
+            SetSectorsUsed(runStart, count, true);
+            return runStart;
+        }
+    }
+
+    uint32_t first = runLength > 0 ? runStart : m_usedSectors.size();
+    SetSectorsUsed(first, count, true);
+    return first;
+}
+
+void RegionFile::SetSectorsUsed(uint32_t first, uint32_t count, bool bUsed)
+{
+    if (first + count > m_usedSectors.size())
+        m_usedSectors.resize(first + count, false);
+
+    for (uint32_t i = first; i < first + count; ++i)
+        m_usedSectors[i] = bUsed;
+}
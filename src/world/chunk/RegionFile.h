@@ -0,0 +1,88 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#ifndef REGIONFILE_H
+#define REGIONFILE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// like ChunkFile this only depends on the standard library
+
+#define REGION_SIZE             32 // chunks per region along x and z
+#define REGION_CHUNK_COUNT      (REGION_SIZE * REGION_SIZE)
+#define REGION_SECTOR_SIZE      512
+#define REGION_HEADER_SECTORS   ((REGION_CHUNK_COUNT * 4) / REGION_SECTOR_SIZE)
+#define REGION_MAX_SECTORS      255 // per record
+#define REGION_FILE_EXTENSION   ".wcr"
+
+/**
+ * @brief RegionFile
+ * Packs the records of REGION_SIZE x REGION_SIZE chunks into one file, so the sd card only has to open one file for many chunks.
+ * The file starts with a table of one big endian entry per chunk (first sector << 8 | sector count), records start at a sector
+ * boundary with their big endian length followed by the data. A rewritten record moves to the first free sectors which are
+ * large enough, its old sectors are only freed after the table entry points to the new ones.
+ */
+class RegionFile
+{
+public:
+    ~RegionFile();
+
+    static inline uint32_t GetIndex(int32_t chunkX, int32_t chunkZ)
+    {
+        return (uint32_t) (chunkX & (REGION_SIZE - 1)) + (uint32_t) (chunkZ & (REGION_SIZE - 1)) * REGION_SIZE;
+    }
+
+    /**
+     * @param bCreate creates an empty region file if it does not exist.
+     */
+    bool Open(const std::string& filePath, bool bCreate);
+    void Close();
+    bool IsOpen() const;
+
+    bool HasRecord(uint32_t index) const;
+    bool Read(uint32_t index, std::vector<uint8_t>& record);
+
+    /**
+     * @brief ReadHead reads the first bytes of a record.
+     * @param size the amount of bytes to read, set to the size of the whole record.
+     */
+    bool ReadHead(uint32_t index, uint8_t* buffer, uint32_t& size);
+    bool Write(uint32_t index, const uint8_t* data, uint32_t size);
+
+    /**
+     * @brief Append appends data to an existing record, in place if its last sector has room left.
+     * @param recordSize the size of the record after the append.
+     */
+    bool Append(uint32_t index, const uint8_t* data, uint32_t size, uint32_t& recordSize);
+
+private:
+    bool ReadRecordSize(uint32_t index, uint32_t& size);
+    bool WriteTableEntry(uint32_t index);
+    uint32_t AllocateSectors(uint32_t count);
+    void SetSectorsUsed(uint32_t first, uint32_t count, bool bUsed);
+
+    FILE* m_file = nullptr;
+    uint32_t m_table[REGION_CHUNK_COUNT];
+    std::vector<bool> m_usedSectors;
+};
+
+#endif // REGIONFILE_H
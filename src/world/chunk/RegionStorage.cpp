@@ -0,0 +1,153 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#include <sstream>
+#include "RegionStorage.h"
+#include "../../utils/Debug.h"
+
+static inline int32_t GetRegionCoord(int32_t chunkCoord)
+{
+    return chunkCoord >= 0 ? chunkCoord / REGION_SIZE : ((chunkCoord + 1) / REGION_SIZE) - 1;
+}
+
+RegionStorage::~RegionStorage()
+{
+    Close();
+}
+
+void RegionStorage::Init(const std::string& directoryPath)
+{
+    m_directoryPath = directoryPath;
+}
+
+void RegionStorage::Close()
+{
+    m_mutex.Lock();
+    for (auto& region : m_openRegions)
+    {
+        delete region.File;
+    }
+    m_openRegions.clear();
+    m_mutex.Unlock();
+}
+
+bool RegionStorage::LoadChunk(const ChunkCoord& coord, ChunkFileData& data)
+{
+    std::vector<uint8_t> record;
+
+    m_mutex.Lock();
+    RegionFile* pRegion = GetRegionFile(coord, false);
+    bool bRead = pRegion && pRegion->Read(RegionFile::GetIndex(coord.X, coord.Z), record);
+    m_mutex.Unlock();
+
+    return bRead && ChunkFile::Decode(record.data(), record.size(), data);
+}
+
+bool RegionStorage::SaveChunk(const ChunkCoord& coord, const ChunkFileData& data)
+{
+    std::vector<uint8_t> record;
+    if (!ChunkFile::Encode(data, record))
+        return false;
+
+    m_mutex.Lock();
+    RegionFile* pRegion = GetRegionFile(coord, true);
+    bool bWritten = pRegion && pRegion->Write(RegionFile::GetIndex(coord.X, coord.Z), record.data(), record.size());
+    m_mutex.Unlock();
+
+    return bWritten;
+}
+
+bool RegionStorage::AppendEdits(const ChunkCoord& coord, const std::vector<ChunkFileEdit>& edits, uint32_t& editCount)
+{
+    const uint32_t index = RegionFile::GetIndex(coord.X, coord.Z);
+    std::vector<uint8_t> editData(edits.size() * CHUNK_FILE_EDIT_SIZE);
+    for (uint32_t i = 0; i < edits.size(); ++i)
+    {
+        ChunkFile::EncodeEdit(edits[i], &editData[i * CHUNK_FILE_EDIT_SIZE]);
+    }
+
+    bool bWritten = false;
+    m_mutex.Lock();
+    RegionFile* pRegion = GetRegionFile(coord, true);
+    if (pRegion)
+    {
+        if (pRegion->HasRecord(index))
+        {
+            uint8_t header[CHUNK_FILE_HEADER_SIZE];
+            uint32_t recordSize = CHUNK_FILE_HEADER_SIZE;
+            bWritten = pRegion->ReadHead(index, header, recordSize) &&
+                       pRegion->Append(index, editData.data(), editData.size(), recordSize);
+            editCount = bWritten ? ChunkFile::GetEditCount(header, recordSize) : 0;
+        }
+        else
+        {
+            std::vector<uint8_t> record;
+            ChunkFile::EncodeEmpty(coord.X, coord.Z, record);
+            record.insert(record.end(), editData.begin(), editData.end());
+            bWritten = pRegion->Write(index, record.data(), record.size());
+            editCount = edits.size();
+        }
+    }
+    m_mutex.Unlock();
+
+    return bWritten;
+}
+
+std::string RegionStorage::GetRegionFileName(const ChunkCoord& coord)
+{
+    std::ostringstream filename;
+    filename << "r." << GetRegionCoord(coord.X) << '.' << GetRegionCoord(coord.Z) << REGION_FILE_EXTENSION;
+    return filename.str();
+}
+
+RegionFile* RegionStorage::GetRegionFile(const ChunkCoord& coord, bool bCreate)
+{
+    const int32_t regionX = GetRegionCoord(coord.X);
+    const int32_t regionZ = GetRegionCoord(coord.Z);
+
+    for (auto it = m_openRegions.begin(); it != m_openRegions.end(); ++it)
+    {
+        if (it->X == regionX && it->Z == regionZ)
+        {
+            OpenRegion region = *it;
+            m_openRegions.erase(it);
+            m_openRegions.push_back(region);
+            return region.File;
+        }
+    }
+
+    RegionFile* pRegion = new RegionFile();
+    if (!pRegion->Open(m_directoryPath + "/" + GetRegionFileName(coord), bCreate))
+    {
+        // a missing region is fine as long as nothing has to be written into it
+        if (bCreate)
+            LOG("RegionStorage: Could not open region %d %d", regionX, regionZ);
+        delete pRegion;
+        return nullptr;
+    }
+
+    if (m_openRegions.size() >= REGION_STORAGE_MAX_OPEN_FILES)
+    {
+        delete m_openRegions.front().File;
+        m_openRegions.erase(m_openRegions.begin());
+    }
+
+    m_openRegions.push_back(OpenRegion { regionX, regionZ, pRegion });
+    return pRegion;
+}
@@ -0,0 +1,71 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#ifndef REGIONSTORAGE_H
+#define REGIONSTORAGE_H
+
+#include <string>
+#include <vector>
+#include "ChunkData.h"
+#include "ChunkFile.h"
+#include "RegionFile.h"
+#include "../../utils/Mutex.h"
+
+#define REGION_STORAGE_MAX_OPEN_FILES 4
+
+/**
+ * @brief RegionStorage
+ * Loads and saves chunk files as records of the region files in one directory.
+ * It is shared by the loader and the serialization job, every call locks the storage.
+ */
+class RegionStorage
+{
+public:
+    ~RegionStorage();
+
+    void Init(const std::string& directoryPath);
+    void Close();
+
+    bool LoadChunk(const ChunkCoord& coord, ChunkFileData& data);
+    bool SaveChunk(const ChunkCoord& coord, const ChunkFileData& data);
+
+    /**
+     * @brief AppendEdits appends block changes to the chunk record with one write, the record is created if it does not exist yet.
+     * @param editCount the amount of edits in the record after the append.
+     */
+    bool AppendEdits(const ChunkCoord& coord, const std::vector<ChunkFileEdit>& edits, uint32_t& editCount);
+
+    static std::string GetRegionFileName(const ChunkCoord& coord);
+
+private:
+    RegionFile* GetRegionFile(const ChunkCoord& coord, bool bCreate);
+
+    struct OpenRegion
+    {
+        int32_t X;
+        int32_t Z;
+        RegionFile* File;
+    };
+
+    std::string m_directoryPath;
+    std::vector<OpenRegion> m_openRegions; // most recently used at the back
+    Mutex m_mutex;
+};
+
+#endif // REGIONSTORAGE_H
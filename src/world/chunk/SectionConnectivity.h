@@ -0,0 +1,141 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#ifndef SECTIONCONNECTIVITY_H
+#define SECTIONCONNECTIVITY_H
+
+#include <stdint.h>
+#include "ChunkData.h"
+#include "ChunkSections.h"
+#include "../blocks/Block.h"
+
+#define SECTION_FACE_COUNT 6
+// one bit for every pair of different faces
+#define SECTION_ALL_CONNECTED 0x7FFF
+
+/**
+ * @brief SectionConnectivity
+ * Which faces of a section can see each other through the cells which are not opaque. A section without such a
+ * path between two faces hides everything behind one face from a camera looking through the other one.
+ */
+class SectionConnectivity
+{
+public:
+    // bit of the pair of faces in the connectivity mask, the order of the faces does not matter
+    static uint16_t GetFacePairBit(uint8_t faceA, uint8_t faceB)
+    {
+        static const int8_t PAIR_INDICES[SECTION_FACE_COUNT][SECTION_FACE_COUNT] =
+        {
+            { -1,  0,  1,  2,  3,  4 },
+            {  0, -1,  5,  6,  7,  8 },
+            {  1,  5, -1,  9, 10, 11 },
+            {  2,  6,  9, -1, 12, 13 },
+            {  3,  7, 10, 12, -1, 14 },
+            {  4,  8, 11, 13, 14, -1 },
+        };
+
+        const int8_t index = PAIR_INDICES[faceA][faceB];
+        return index < 0 ? 0 : 1 << index;
+    }
+
+    static bool IsConnected(uint16_t connectivity, uint8_t faceA, uint8_t faceB)
+    {
+        return connectivity & GetFacePairBit(faceA, faceB);
+    }
+
+    static uint8_t GetOppositeFace(uint8_t face)
+    {
+        // the faces come in pairs: left and right, front and back, top and bottom
+        return face ^ 1;
+    }
+
+    /**
+     * @brief Compute floods the cells of the section which can be seen through and connects every pair of faces
+     * which are reached by the same flood.
+     * @param blocks anything with Get(x, y, z) for the blocks of the chunk.
+     */
+    template<typename TBlocks>
+    static uint16_t Compute(const TBlocks& blocks, uint32_t section)
+    {
+        static_assert(CHUNK_SIZE_X == CHUNK_SECTION_SIZE && CHUNK_SIZE_Z == CHUNK_SECTION_SIZE, "the flood expects cubic sections");
+
+        // cells are indexed (x * size + z) * size + y inside the section
+        const uint32_t size = CHUNK_SECTION_SIZE;
+        const uint32_t minY = section * CHUNK_SECTION_SIZE;
+        uint8_t visited[CHUNK_SECTION_BLOCK_COUNT / 8] = {};
+        uint16_t stack[CHUNK_SECTION_BLOCK_COUNT];
+        uint16_t connectivity = 0;
+
+        auto visit = [&](uint32_t cell) -> bool
+        {
+            if (visited[cell >> 3] & (1 << (cell & 7)))
+                return false;
+
+            visited[cell >> 3] |= 1 << (cell & 7);
+            const uint32_t y = cell % size;
+            const uint32_t z = (cell / size) % size;
+            const uint32_t x = cell / (size * size);
+            return !ChunkSections::IsOpaque(blocks.Get(x, minY + y, z));
+        };
+
+        for (uint32_t start = 0; start < CHUNK_SECTION_BLOCK_COUNT && connectivity != SECTION_ALL_CONNECTED; ++start)
+        {
+            if (!visit(start))
+                continue;
+
+            uint8_t faces = 0;
+            uint32_t stackSize = 0;
+            stack[stackSize++] = start;
+            while (stackSize > 0)
+            {
+                const uint32_t cell = stack[--stackSize];
+                const uint32_t y = cell % size;
+                const uint32_t z = (cell / size) % size;
+                const uint32_t x = cell / (size * size);
+
+                if (x == 0)         faces |= 1 << EBlockFaces::Left;
+                if (x == size - 1)  faces |= 1 << EBlockFaces::Right;
+                if (z == size - 1)  faces |= 1 << EBlockFaces::Front;
+                if (z == 0)         faces |= 1 << EBlockFaces::Back;
+                if (y == size - 1)  faces |= 1 << EBlockFaces::Top;
+                if (y == 0)         faces |= 1 << EBlockFaces::Bottom;
+
+                if (x > 0 && visit(cell - size * size))         stack[stackSize++] = cell - size * size;
+                if (x < size - 1 && visit(cell + size * size))  stack[stackSize++] = cell + size * size;
+                if (z > 0 && visit(cell - size))                stack[stackSize++] = cell - size;
+                if (z < size - 1 && visit(cell + size))         stack[stackSize++] = cell + size;
+                if (y > 0 && visit(cell - 1))                   stack[stackSize++] = cell - 1;
+                if (y < size - 1 && visit(cell + 1))            stack[stackSize++] = cell + 1;
+            }
+
+            for (uint8_t faceA = 0; faceA < SECTION_FACE_COUNT; ++faceA)
+            {
+                for (uint8_t faceB = faceA + 1; faceB < SECTION_FACE_COUNT; ++faceB)
+                {
+                    if ((faces & (1 << faceA)) && (faces & (1 << faceB)))
+                        connectivity |= GetFacePairBit(faceA, faceB);
+                }
+            }
+        }
+
+        return connectivity;
+    }
+};
+
+#endif // SECTIONCONNECTIVITY_H
@@ -20,78 +20,45 @@
 #ifndef CHUNKLOADERJOB_H
 #define CHUNKLOADERJOB_H
 
-#include <iostream>
 #include <stdlib.h>
-#include "../chunkdata.h"
-#include "../../../utils/Thread.h"
-#include "../../../utils/SafeQueue.h"
+#include "../ChunkData.h"
+#include "../RegionStorage.h"
 
-void* LoadChunkJob(void* data)
-{
-    Thread* thread = static_cast<Thread*>(data);
-    SafeQueue<ChunkLoadingData>* queue = static_cast<SafeQueue<ChunkLoadingData>*>(thread->Data());
-
-    while(true)
-    {
-       if (queue->IsEmpty())
-       {
-           if(thread->Stop())
-           {
-               break;
-           }
-           else
-           {
-                LWP_SuspendThread(LWP_GetSelf());
-           }
-       }
-       else
-       {
-           const ChunkLoadingData& chunkData = queue->Pop();
-           Chunk* chunk = chunkData.ChunkObj;
-           const std::string& filepath = chunkData.Filepath;
-
-           //chunk->Build();
+static_assert(CHUNK_FILE_SIZE_X == CHUNK_SIZE_X && CHUNK_FILE_SIZE_Y == CHUNK_SIZE_Y && CHUNK_FILE_SIZE_Z == CHUNK_SIZE_Z,
+              "chunk file dimensions have to match the chunk dimensions");
 
-           Vector3 chunkCenterPos;
-           std::ifstream fstream;
-           fstream.open(filepath);
-           if (fstream.is_open())
-           {
-               std::string line;
-               if (fstream.good())
-               {
-                   std::getline(fstream, line, ';');
-                   chunkCenterPos.SetX(std::atof(line.c_str()));
-                   std::getline(fstream, line, ';');
-                   chunkCenterPos.SetY(std::atof(line.c_str()));
-                   std::getline(fstream, line);
-                   chunkCenterPos.SetZ(std::atof(line.c_str()));
-               }
-
-               auto blocks = chunk->GetBlocks();
-               size_t posX, posY, posZ, posValue;
-               while (std::getline(fstream, line))
-               {
-                   posX        = line.find("X");
-                   posY        = line.find("Y");
-                   posZ        = line.find("Z");
-                   posValue    = line.find(":");
+void LoadChunkJob(const ChunkLoadingData& chunkData)
+{
+    Chunk* chunk = chunkData.ChunkObj;
 
-                   uint32_t x      = std::atoi(line.substr(posX+1, posY - posX).c_str());
-                   uint32_t y      = std::atoi(line.substr(posY+1, posZ - posY).c_str());
-                   uint32_t z      = std::atoi(line.substr(posZ+1, posValue - posZ).c_str());
-                   uint8_t value   = std::atoi(line.substr(posValue+1).c_str());
+    // skip chunks which were moved again before they were loaded
+    if (chunk->GetGeneration() != chunkData.Generation)
+        return;
 
-                   blocks[x][y][z] = BlockType(value);
-               }
-           }
+    ChunkSections blocks;
+    chunk->Build(blocks);
 
-           chunk->SetLoaded(true);
-           fstream.close();
-       }
+    ChunkFileData fileData;
+    if (chunkData.Storage->LoadChunk(chunkData.Coord, fileData))
+    {
+        for (uint32_t x = 0; x < CHUNK_SIZE_X; ++x)
+        {
+            for (uint32_t z = 0; z < CHUNK_SIZE_Z; ++z)
+            {
+                const uint8_t* column = &fileData.Blocks[ChunkFile::GetIndex(x, 0, z)];
+                for (uint32_t y = 0; y < CHUNK_SIZE_Y; ++y)
+                {
+                    if (column[y] != CHUNK_FILE_UNCHANGED)
+                    {
+                        blocks.Set(x, y, z, BlockType(column[y]));
+                    }
+                }
+            }
+        }
     }
 
-    return nullptr;
+    // the main thread swaps the blocks in, nobody else can read them while they are replaced
+    chunk->SetLoadedBlocks(std::move(blocks), chunkData.Generation);
 }
 
 #endif // CHUNKLOADERJOB_H
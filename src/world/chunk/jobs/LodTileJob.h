@@ -0,0 +1,150 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#ifndef LODTILEJOB_H
+#define LODTILEJOB_H
+
+#include <algorithm>
+#include "../Chunk.h"
+#include "../ChunkGenerator.h"
+#include "../LodTerrain.h"
+#include "../RegionStorage.h"
+
+// blocks below the skirts of the tiles are never visible, the terrain does not go deeper
+#define LOD_SKIRT_BOTTOM (CHUNK_MIN_GROUND - 1)
+
+static void AddLodWall(LodMesh& mesh, uint8_t face, uint32_t x, uint32_t z, uint32_t width, uint32_t bottom, uint32_t top)
+{
+    if (top <= bottom)
+        return;
+
+    // grass on the top block of the wall, dirt below
+    BlockQuadVO quadVO;
+    quadVO.Face = face;
+    quadVO.Width = width;
+    quadVO.X = x;
+    quadVO.Z = z;
+
+    quadVO.Y = top - 1;
+    quadVO.Height = 1;
+    mesh.Quads[BlockType::GRASS].emplace_back(quadVO);
+    mesh.Faces++;
+
+    // tall walls are split, so the texture coordinates of a quad stay inside of BLOCK_QUAD_MAX_SIZE
+    for (uint32_t y = bottom; y < top - 1; y += BLOCK_QUAD_MAX_SIZE)
+    {
+        quadVO.Y = y;
+        quadVO.Height = std::min<uint32_t>(top - 1 - y, BLOCK_QUAD_MAX_SIZE);
+        mesh.Quads[BlockType::DIRT].emplace_back(quadVO);
+        mesh.Faces++;
+    }
+}
+
+void LodTileJob(const LodTileData& tileData)
+{
+    const uint32_t cellSize = 1 << tileData.Level;
+    const uint32_t cells = CHUNK_SIZE_X / cellSize;
+    const double originX = tileData.Coord.X * CHUNK_BLOCK_SIZE_X;
+    const double originZ = tileData.Coord.Z * CHUNK_BLOCK_SIZE_Z;
+
+    // columns with saved edits get their exact height, the tile takes the highest of them
+    int32_t editedHeights[CHUNK_SIZE_X * CHUNK_SIZE_Z];
+    std::fill(editedHeights, editedHeights + CHUNK_SIZE_X * CHUNK_SIZE_Z, -1);
+
+    ChunkFileData fileData;
+    if (tileData.Storage->LoadChunk(tileData.Coord, fileData))
+    {
+        for (uint32_t x = 0; x < CHUNK_SIZE_X; ++x)
+        {
+            for (uint32_t z = 0; z < CHUNK_SIZE_Z; ++z)
+            {
+                const uint8_t* column = &fileData.Blocks[ChunkFile::GetIndex(x, 0, z)];
+                if (std::all_of(column, column + CHUNK_SIZE_Y, [](uint8_t type) { return type == CHUNK_FILE_UNCHANGED; }))
+                    continue;
+
+                const uint32_t generated = ChunkGenerator::GetTerrainHeight(tileData.Noise, originX + x * BLOCK_SIZE, originZ + z * BLOCK_SIZE);
+                int32_t y = CHUNK_SIZE_Y - 1;
+                for (; y >= 0; --y)
+                {
+                    const bool bSolid = column[y] != CHUNK_FILE_UNCHANGED ? column[y] != (uint8_t) BlockType::AIR : (uint32_t) y < generated;
+                    if (bSolid)
+                        break;
+                }
+                editedHeights[x * CHUNK_SIZE_Z + z] = y + 1;
+            }
+        }
+    }
+
+    uint8_t heights[CHUNK_SIZE_X * CHUNK_SIZE_Z];
+    for (uint32_t cx = 0; cx < cells; ++cx)
+    {
+        for (uint32_t cz = 0; cz < cells; ++cz)
+        {
+            const uint32_t sampleX = cx * cellSize + cellSize / 2;
+            const uint32_t sampleZ = cz * cellSize + cellSize / 2;
+            int32_t height = editedHeights[sampleX * CHUNK_SIZE_Z + sampleZ];
+            if (height < 0)
+                height = ChunkGenerator::GetTerrainHeight(tileData.Noise, originX + sampleX * BLOCK_SIZE, originZ + sampleZ * BLOCK_SIZE);
+
+            for (uint32_t x = cx * cellSize; x < (cx + 1) * cellSize; ++x)
+            {
+                for (uint32_t z = cz * cellSize; z < (cz + 1) * cellSize; ++z)
+                    height = std::max(height, editedHeights[x * CHUNK_SIZE_Z + z]);
+            }
+
+            heights[cx * cells + cz] = height;
+        }
+    }
+
+    LodMesh& mesh = *tileData.Mesh;
+    for (uint32_t cx = 0; cx < cells; ++cx)
+    {
+        for (uint32_t cz = 0; cz < cells; ++cz)
+        {
+            const uint32_t height = heights[cx * cells + cz];
+            const uint32_t x = cx * cellSize;
+            const uint32_t z = cz * cellSize;
+            if (height == 0)
+                continue;
+
+            BlockQuadVO topVO;
+            topVO.Face = EBlockFaces::Top;
+            topVO.Width = cellSize;
+            topVO.Height = cellSize;
+            topVO.X = x;
+            topVO.Y = height - 1;
+            topVO.Z = z;
+            mesh.Quads[BlockType::GRASS].emplace_back(topVO);
+            mesh.Faces++;
+
+            // walls down to the lower neighbor cell, skirts on the tile border
+            const uint32_t left  = cx > 0         ? heights[(cx - 1) * cells + cz] : LOD_SKIRT_BOTTOM;
+            const uint32_t right = cx + 1 < cells ? heights[(cx + 1) * cells + cz] : LOD_SKIRT_BOTTOM;
+            const uint32_t back  = cz > 0         ? heights[cx * cells + cz - 1]   : LOD_SKIRT_BOTTOM;
+            const uint32_t front = cz + 1 < cells ? heights[cx * cells + cz + 1]   : LOD_SKIRT_BOTTOM;
+
+            AddLodWall(mesh, EBlockFaces::Left,  x,                z,                cellSize, left,  height);
+            AddLodWall(mesh, EBlockFaces::Right, x + cellSize - 1, z,                cellSize, right, height);
+            AddLodWall(mesh, EBlockFaces::Back,  x,                z,                cellSize, back,  height);
+            AddLodWall(mesh, EBlockFaces::Front, x,                z + cellSize - 1, cellSize, front, height);
+        }
+    }
+}
+
+#endif // LODTILEJOB_H
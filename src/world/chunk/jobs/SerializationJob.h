@@ -21,103 +21,29 @@
 #define SERIALIZATIONJOB_H
 
 
-#include <fstream>
-#include <sstream>
-#include <iostream>
 #include <stdlib.h>
-#include "../chunkdata.h"
-#include "../../../utils/Thread.h"
-#include "../../../utils/SafeQueue.h"
+#include "../ChunkData.h"
+#include "../RegionStorage.h"
+#include "../../../utils/Debug.h"
 
-void* QueueJob(void* data)
+void SerializationJob(const ChunkEditBatch& batch)
 {
-    Thread* thread = static_cast<Thread*>(data);
-    SafeQueue<BlockChangeData>* queue = static_cast<SafeQueue<BlockChangeData>*>(thread->Data());
+    RegionStorage* storage = batch.Storage;
 
-    while(true)
+    uint32_t editCount = 0;
+    if (!storage->AppendEdits(batch.Coord, batch.Edits, editCount))
     {
-
-        if (queue->IsEmpty())
+        LOG("SerializationJob: Could not write chunk %d %d", batch.Coord.X, batch.Coord.Z);
+    }
+    else if (editCount > CHUNK_FILE_MAX_EDITS)
+    {
+        // merge the appended edits into the rle columns
+        ChunkFileData fileData;
+        if (storage->LoadChunk(batch.Coord, fileData))
         {
-            if(thread->Stop())
-            {
-                break;
-            }
-            else
-            {
-                LWP_SuspendThread(LWP_GetSelf());
-            }
-       }
-       else
-       {
-          const BlockChangeData& blockData = queue->Pop();
-
-          const std::string& filename = blockData.Filepath;
-
-          std::ifstream file;
-          file.open(filename);
-          bool bReplaced = false;
-
-          if (file.is_open())
-          {
-              std::vector<std::string> fileContent;
-              std::ostringstream search;
-              search << "X";
-              search << blockData.BlockPosition.X;
-              search << "Y";
-              search << blockData.BlockPosition.Y;
-              search << "Z";
-              search << blockData.BlockPosition.Z;
-              search << ":";
-
-              size_t pos;
-              std::string line;
-              while(std::getline(file,line))
-              {
-                  pos=line.find(search.str());
-                  if(pos!=std::string::npos)
-                  {
-                      search << static_cast<unsigned short>(blockData.Type);
-                      line.replace(pos, search.str().length(), search.str());
-                      //LOG("Replace File %s -> Line: %s : SearchLine %s", filename.c_str(), line.c_str(), search.str().c_str());
-                      bReplaced = true;
-                  }
-                  fileContent.push_back(line);
-              }
-
-              file.close();
-
-              if(bReplaced)
-              {
-                  std::ofstream stream(filename, std::ofstream::out | std::ofstream::trunc);
-                  for (auto& s : fileContent)
-                      stream << s << '\n';
-                  stream.flush();
-                  stream.close();
-              }
-              else
-              {
-                  std::ofstream stream(filename, std::ios_base::app | std::ios_base::out);
-                  stream << "X" << blockData.BlockPosition.X << "Y" << blockData.BlockPosition.Y << "Z" << blockData.BlockPosition.Z << ":" << static_cast<unsigned short>(blockData.Type) << '\n';
-                  stream.flush();
-                  stream.close();
-                  //LOG("Add Line into file %s", filename.c_str());
-              }
-              fileContent.clear();
-          }
-          else
-          {
-              std::ofstream stream(filename);
-              stream << blockData.ChunkPosition.GetX() << ';' << blockData.ChunkPosition.GetY() << ';' << blockData.ChunkPosition.GetZ() << '\n';
-              stream << "X" << blockData.BlockPosition.X << "Y" << blockData.BlockPosition.Y << "Z" << blockData.BlockPosition.Z << ":" << static_cast<unsigned short>(blockData.Type) << '\n';
-              stream.flush();
-              stream.close();
-              //LOG("Create File %s", filename.c_str());
-          }
+            storage->SaveChunk(batch.Coord, fileData);
         }
     }
-
-    return nullptr;
 }
 
 #endif // SERIALIZATIONJOB_H
@@ -0,0 +1,145 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#include <random>
+#include <vector>
+#include "Test.h"
+#include "../src/world/chunk/ChunkBlockStorage.h"
+
+#define TEST_BLOCK_COUNT 4096
+#define TEST_RANDOM_SETS 200000
+
+static bool IsEqual(const ChunkBlockStorage& storage, const std::vector<BlockType>& expected)
+{
+    for (uint32_t i = 0; i < expected.size(); ++i)
+    {
+        if (storage.Get(i) != expected[i])
+            return false;
+    }
+    return true;
+}
+
+static void TestGrowAndShrink()
+{
+    ChunkBlockStorage storage(TEST_BLOCK_COUNT);
+    const uint32_t emptyMemory = storage.GetMemoryUsage();
+    TEST_CHECK(storage.GetBitsPerBlock() == 0 && storage.GetPaletteSize() == 1);
+
+    storage.Set(10, BlockType::STONE);
+    TEST_CHECK(storage.GetBitsPerBlock() == 1);
+    storage.Set(11, BlockType::DIRT);
+    storage.Set(12, BlockType::GRASS);
+    TEST_CHECK(storage.GetBitsPerBlock() == 2 && storage.GetPaletteSize() == 4);
+    TEST_CHECK(storage.Get(10) == BlockType::STONE && storage.Get(11) == BlockType::DIRT && storage.Get(12) == BlockType::GRASS);
+
+    // the last blocks of the other types are removed, one type needs no indices
+    storage.Set(10, BlockType::AIR);
+    storage.Set(11, BlockType::AIR);
+    storage.Set(12, BlockType::AIR);
+    TEST_CHECK(storage.GetBitsPerBlock() == 0 && storage.GetPaletteSize() == 1);
+    TEST_CHECK(storage.Get(10) == BlockType::AIR && storage.Get(TEST_BLOCK_COUNT - 1) == BlockType::AIR);
+    TEST_CHECK(storage.GetMemoryUsage() == emptyMemory);
+}
+
+static void TestFreeEntryIsReused()
+{
+    ChunkBlockStorage storage(TEST_BLOCK_COUNT);
+    storage.Set(0, BlockType::STONE);
+    storage.Set(1, BlockType::DIRT);
+    storage.Set(2, BlockType::GRASS);
+    TEST_CHECK(storage.GetBitsPerBlock() == 2 && storage.GetPaletteSize() == 4);
+
+    // three types are left, they do not fit into half of a smaller palette, the free entry takes the new type
+    storage.Set(2, BlockType::AIR);
+    TEST_CHECK(storage.GetBitsPerBlock() == 2);
+    storage.Set(3, BlockType::WOOD);
+    TEST_CHECK(storage.GetBitsPerBlock() == 2 && storage.GetPaletteSize() == 4);
+    TEST_CHECK(storage.Get(0) == BlockType::STONE && storage.Get(1) == BlockType::DIRT && storage.Get(2) == BlockType::AIR &&
+               storage.Get(3) == BlockType::WOOD);
+}
+
+static void TestRepackToFewerBits()
+{
+    ChunkBlockStorage storage(TEST_BLOCK_COUNT);
+    std::vector<BlockType> expected(TEST_BLOCK_COUNT, BlockType::AIR);
+    for (uint32_t i = 0; i < 20; ++i)
+    {
+        expected[i * 7] = BlockType(i + 1);
+        storage.Set(i * 7, expected[i * 7]);
+    }
+    TEST_CHECK(storage.GetBitsPerBlock() == 8);
+
+    // air and one more type fit into half of a 2 bit palette
+    for (uint32_t i = 1; i < 20; ++i)
+    {
+        expected[i * 7] = BlockType::AIR;
+        storage.Set(i * 7, BlockType::AIR);
+    }
+    TEST_CHECK(storage.GetBitsPerBlock() == 2 && storage.GetPaletteSize() == 2);
+    TEST_CHECK(IsEqual(storage, expected));
+}
+
+static void TestEveryBlockType()
+{
+    ChunkBlockStorage storage(TEST_BLOCK_COUNT);
+    std::vector<BlockType> expected(TEST_BLOCK_COUNT, BlockType::AIR);
+    for (uint32_t i = 0; i < TEST_BLOCK_COUNT; ++i)
+    {
+        expected[i] = BlockType(i & 0xFF);
+        storage.Set(i, expected[i]);
+    }
+
+    TEST_CHECK(storage.GetBitsPerBlock() == CHUNK_STORAGE_MAX_BITS && storage.GetPaletteSize() == 256);
+    TEST_CHECK(IsEqual(storage, expected));
+}
+
+static void TestRandomSets()
+{
+    ChunkBlockStorage storage(TEST_BLOCK_COUNT);
+    std::vector<BlockType> expected(TEST_BLOCK_COUNT, BlockType::AIR);
+    std::mt19937 random(1234);
+
+    // the amount of types grows and drops again, so the storage grows and shrinks several times
+    for (uint32_t i = 0; i < TEST_RANDOM_SETS; ++i)
+    {
+        const uint32_t phase = i / (TEST_RANDOM_SETS / 8);
+        const uint32_t types = phase % 2 == 0 ? 1 + phase * 4 : 1;
+        const uint32_t index = random() % TEST_BLOCK_COUNT;
+        expected[index] = BlockType(random() % types);
+        storage.Set(index, expected[index]);
+    }
+
+    TEST_CHECK(IsEqual(storage, expected));
+
+    std::vector<BlockType> column(16);
+    storage.Decode(32, column.size(), column.data());
+    for (uint32_t i = 0; i < column.size(); ++i)
+        TEST_CHECK(column[i] == expected[32 + i]);
+}
+
+int main()
+{
+    printf("ChunkBlockStorageTest\n");
+    TEST_RUN(TestGrowAndShrink);
+    TEST_RUN(TestFreeEntryIsReused);
+    TEST_RUN(TestRepackToFewerBits);
+    TEST_RUN(TestEveryBlockType);
+    TEST_RUN(TestRandomSets);
+    return TEST_RESULT();
+}
@@ -0,0 +1,272 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#include <memory>
+#include <vector>
+#include "Test.h"
+#include "../src/utils/JobSystem.h"
+#include "../src/world/chunk/ChunkGenerator.h"
+#include "../src/world/chunk/ChunkMesher.h"
+#include "../src/world/chunk/ChunkSnapshot.h"
+
+#define TEST_FRAME_COUNT 48
+#define TEST_EDITS_PER_FRAME 256
+
+static PerlinNoise s_noise(.10, .1, .5, 6, 1234);
+
+// a chunk and its neighbors in EBlockFaces order (left, right, front, back)
+struct TestChunks
+{
+    ChunkSections Blocks;
+    ChunkSections Neighbors[CHUNK_NEIGHBOR_COUNT];
+};
+
+// the blocks of one frame, the render lists the mesh job built from its snapshot
+struct TestFrame
+{
+    TestChunks Blocks;
+    EMeshingMode Mode;
+    SectionRenderList Sections[CHUNK_SECTION_COUNT];
+};
+
+static void GenerateChunks(TestChunks& chunks)
+{
+    const ChunkCoord offsets[CHUNK_NEIGHBOR_COUNT] = { { -1, 0 }, { 1, 0 }, { 0, 1 }, { 0, -1 } };
+    ChunkGenerator::Generate(s_noise, ChunkCoord { 0, 0 }, chunks.Blocks);
+    for (uint32_t i = 0; i < CHUNK_NEIGHBOR_COUNT; ++i)
+        ChunkGenerator::Generate(s_noise, offsets[i], chunks.Neighbors[i]);
+}
+
+// like Chunk::CreateMeshSnapshot, on the thread which writes the blocks
+static std::shared_ptr<const ChunkSnapshot> CreateSnapshot(const TestChunks& chunks)
+{
+    const ChunkSections* neighbors[CHUNK_NEIGHBOR_COUNT];
+    for (uint32_t i = 0; i < CHUNK_NEIGHBOR_COUNT; ++i)
+        neighbors[i] = &chunks.Neighbors[i];
+
+    return std::make_shared<const ChunkSnapshot>(chunks.Blocks, neighbors, (1u << CHUNK_SECTION_COUNT) - 1);
+}
+
+// like the mesh job of Chunk::BuildMesh
+static void MeshChunk(const ChunkSnapshot& snapshot, EMeshingMode mode, SectionRenderList* sections)
+{
+    std::vector<uint8_t> faceMasks;
+    for (uint32_t section = 0; section < CHUNK_SECTION_COUNT; ++section)
+    {
+        const ESectionState state = snapshot.GetState(section);
+        if (state == ESectionState::Air || (state == ESectionState::Opaque && ChunkMesher::IsSectionBuried(snapshot, section)))
+        {
+            sections[section] = SectionRenderList();
+            continue;
+        }
+
+        ChunkMesher::MeshSection(snapshot, section, mode, sections[section], faceMasks);
+    }
+}
+
+static bool IsSameRenderList(const SectionRenderList& a, const SectionRenderList& b)
+{
+    if (a.Blocks != b.Blocks || a.Faces != b.Faces || a.VisibleFaces != b.VisibleFaces)
+        return false;
+    if (a.BlockRenderList.size() != b.BlockRenderList.size() || a.BlockQuadList.size() != b.BlockQuadList.size())
+        return false;
+
+    for (const auto& entry : a.BlockRenderList)
+    {
+        auto it = b.BlockRenderList.find(entry.first);
+        if (it == b.BlockRenderList.end() || it->second.size() != entry.second.size())
+            return false;
+
+        for (size_t i = 0; i < entry.second.size(); ++i)
+        {
+            const BlockRenderVO& blockA = entry.second[i];
+            const BlockRenderVO& blockB = it->second[i];
+            if (blockA.FaceMask != blockB.FaceMask || blockA.Faces != blockB.Faces
+                || blockA.X != blockB.X || blockA.Y != blockB.Y || blockA.Z != blockB.Z)
+                return false;
+        }
+    }
+
+    for (const auto& entry : a.BlockQuadList)
+    {
+        auto it = b.BlockQuadList.find(entry.first);
+        if (it == b.BlockQuadList.end() || it->second.size() != entry.second.size())
+            return false;
+
+        for (size_t i = 0; i < entry.second.size(); ++i)
+        {
+            const BlockQuadVO& quadA = entry.second[i];
+            const BlockQuadVO& quadB = it->second[i];
+            if (quadA.Face != quadB.Face || quadA.Width != quadB.Width || quadA.Height != quadB.Height
+                || quadA.X != quadB.X || quadA.Y != quadB.Y || quadA.Z != quadB.Z)
+                return false;
+        }
+    }
+    return true;
+}
+
+// digs and places blocks in the chunk and the border columns of its neighbors
+static void EditChunks(TestChunks& chunks, uint32_t& seed)
+{
+    static const BlockType TYPES[] = { BlockType::AIR, BlockType::DIRT, BlockType::STONE, BlockType::LEAF };
+
+    for (uint32_t i = 0; i < TEST_EDITS_PER_FRAME; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        const uint32_t x = (seed >> 8) % CHUNK_SIZE_X;
+        const uint32_t y = (seed >> 12) % CHUNK_SIZE_Y;
+        const uint32_t z = (seed >> 20) % CHUNK_SIZE_Z;
+        const BlockType type = TYPES[(seed >> 28) % 4];
+
+        const uint32_t target = (seed >> 4) % (CHUNK_NEIGHBOR_COUNT + 1);
+        if (target == CHUNK_NEIGHBOR_COUNT)
+            chunks.Blocks.Set(x, y, z, type);
+        else
+            chunks.Neighbors[target].Set(x, y, z, type);
+    }
+}
+
+static void TestSnapshotMatchesBlocks()
+{
+    std::unique_ptr<TestChunks> chunks(new TestChunks());
+    GenerateChunks(*chunks);
+    uint32_t seed = 42;
+    EditChunks(*chunks, seed);
+
+    std::shared_ptr<const ChunkSnapshot> snapshot = CreateSnapshot(*chunks);
+    uint32_t mismatches = 0;
+    for (uint32_t y = 0; y < CHUNK_SIZE_Y; ++y)
+    {
+        for (uint32_t x = 0; x < CHUNK_SIZE_X; ++x)
+        {
+            for (uint32_t z = 0; z < CHUNK_SIZE_Z; ++z)
+            {
+                if (snapshot->Get(x, y, z) != chunks->Blocks.Get(GetChunkBlockIndex(x, y, z)))
+                    mismatches++;
+            }
+        }
+
+        for (uint32_t i = 0; i < CHUNK_SIZE_X; ++i)
+        {
+            if (snapshot->Get(-1, y, i) != chunks->Neighbors[EBlockFaces::Left].Get(GetChunkBlockIndex(CHUNK_SIZE_X - 1, y, i)))
+                mismatches++;
+            if (snapshot->Get(CHUNK_SIZE_X, y, i) != chunks->Neighbors[EBlockFaces::Right].Get(GetChunkBlockIndex(0, y, i)))
+                mismatches++;
+            if (snapshot->Get(i, y, CHUNK_SIZE_Z) != chunks->Neighbors[EBlockFaces::Front].Get(GetChunkBlockIndex(i, y, 0)))
+                mismatches++;
+            if (snapshot->Get(i, y, -1) != chunks->Neighbors[EBlockFaces::Back].Get(GetChunkBlockIndex(i, y, CHUNK_SIZE_Z - 1)))
+                mismatches++;
+        }
+    }
+    TEST_CHECK(mismatches == 0);
+
+    for (uint32_t section = 0; section < CHUNK_SECTION_COUNT; ++section)
+        TEST_CHECK(snapshot->GetState(section) == chunks->Blocks.GetState(section));
+    for (uint32_t x = 0; x < CHUNK_SIZE_X; ++x)
+    {
+        for (uint32_t z = 0; z < CHUNK_SIZE_Z; ++z)
+            TEST_CHECK(snapshot->GetHeight(x, z) == chunks->Blocks.GetHeight(x, z));
+    }
+
+    // the blocks written after the capture do not reach the snapshot
+    const BlockType before = snapshot->Get(3, 5, 7);
+    chunks->Blocks.Set(3, 5, 7, before == BlockType::AIR ? BlockType::STONE : BlockType::AIR);
+    TEST_CHECK(snapshot->Get(3, 5, 7) == before);
+}
+
+static void TestMissingNeighborIsSolid()
+{
+    std::unique_ptr<TestChunks> chunks(new TestChunks());
+    chunks->Blocks.Fill(BlockType::AIR);
+    chunks->Blocks.Set(0, 40, 0, BlockType::DIRT);
+
+    const ChunkSections* neighbors[CHUNK_NEIGHBOR_COUNT] = { nullptr, nullptr, nullptr, nullptr };
+    ChunkSnapshot snapshot(chunks->Blocks, neighbors, (1u << CHUNK_SECTION_COUNT) - 1);
+    TEST_CHECK(snapshot.Get(-1, 40, 0) == CHUNK_SNAPSHOT_MISSING_BLOCK);
+    TEST_CHECK(snapshot.Get(0, 40, -1) == CHUNK_SNAPSHOT_MISSING_BLOCK);
+    TEST_CHECK(snapshot.GetNeighborState(EBlockFaces::Left, 2) == ESectionState::Opaque);
+
+    // no faces are built towards the missing neighbors, the block in the corner shows four
+    SectionRenderList renderList;
+    std::vector<uint8_t> faceMasks;
+    ChunkMesher::MeshSection(snapshot, 40 / CHUNK_SECTION_SIZE, EMeshingMode::PerFace, renderList, faceMasks);
+    TEST_CHECK(renderList.Blocks == 1);
+    TEST_CHECK(renderList.Faces == 4);
+}
+
+static void TestMeshWhileWriting()
+{
+    // the live blocks are written on this thread while the workers mesh the snapshots of the earlier frames
+    std::unique_ptr<TestChunks> live(new TestChunks());
+    GenerateChunks(*live);
+    std::vector<std::unique_ptr<TestFrame> > frames;
+    std::vector<JobHandle> handles;
+    uint32_t seed = 1;
+
+    for (uint32_t i = 0; i < TEST_FRAME_COUNT; ++i)
+    {
+        TestFrame* frame = new TestFrame();
+        frame->Blocks = *live;
+        frame->Mode = i % 2 ? EMeshingMode::Greedy : EMeshingMode::PerFace;
+        frames.emplace_back(frame);
+
+        std::shared_ptr<const ChunkSnapshot> snapshot = CreateSnapshot(*live);
+        handles.push_back(JobSystem::Schedule([frame, snapshot]()
+        {
+            MeshChunk(*snapshot, frame->Mode, frame->Sections);
+        }));
+
+        EditChunks(*live, seed);
+    }
+
+    for (auto& handle : handles)
+        JobSystem::Wait(handle);
+
+    // every mesh shows the blocks at the time of its snapshot, none of the later edits
+    uint32_t mismatches = 0;
+    uint32_t faces = 0;
+    for (auto& frame : frames)
+    {
+        SectionRenderList sections[CHUNK_SECTION_COUNT];
+        MeshChunk(*CreateSnapshot(frame->Blocks), frame->Mode, sections);
+        for (uint32_t section = 0; section < CHUNK_SECTION_COUNT; ++section)
+        {
+            if (!IsSameRenderList(sections[section], frame->Sections[section]))
+                mismatches++;
+            faces += frame->Sections[section].Faces;
+        }
+    }
+    TEST_CHECK(mismatches == 0);
+    TEST_CHECK(faces > 0);
+}
+
+int main()
+{
+    printf("ChunkSnapshotTest\n");
+    ThreadPool::Init();
+    TEST_CHECK(JobSystem::Init(JOB_SYSTEM_WORKERS));
+
+    TEST_RUN(TestSnapshotMatchesBlocks);
+    TEST_RUN(TestMissingNeighborIsSolid);
+    TEST_RUN(TestMeshWhileWriting);
+
+    JobSystem::Destroy();
+    ThreadPool::Destroy();
+    return TEST_RESULT();
+}
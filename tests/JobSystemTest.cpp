@@ -0,0 +1,166 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#include <atomic>
+#include <vector>
+#include "Test.h"
+#include "../src/utils/JobSystem.h"
+
+#define TEST_JOB_COUNT 100000
+
+static void TestIndependentJobs()
+{
+    std::atomic<uint32_t> counter(0);
+    std::vector<JobHandle> handles;
+    for (uint32_t i = 0; i < TEST_JOB_COUNT; ++i)
+    {
+        handles.push_back(JobSystem::Schedule([&counter]() { counter++; }));
+    }
+
+    for (auto& handle : handles)
+    {
+        JobSystem::Wait(handle);
+        TEST_CHECK(JobSystem::IsDone(handle));
+    }
+    TEST_CHECK(counter == TEST_JOB_COUNT);
+}
+
+static void TestDependencyChain()
+{
+    // every job runs after the previous one, so the plain counter needs no atomic
+    uint32_t counter = 0;
+    uint32_t outOfOrder = 0;
+    JobHandle last;
+    for (uint32_t i = 0; i < TEST_JOB_COUNT; ++i)
+    {
+        last = JobSystem::Schedule([&counter, &outOfOrder, i]()
+        {
+            if (counter != i)
+                outOfOrder++;
+            counter++;
+        }, last);
+    }
+
+    JobSystem::Wait(last);
+    TEST_CHECK(counter == TEST_JOB_COUNT);
+    TEST_CHECK(outOfOrder == 0);
+}
+
+static void TestManyChains()
+{
+    // several chains run next to each other, like the jobs of the cashed chunks
+    const uint32_t chainCount = 64;
+    std::vector<uint32_t> counters(chainCount, 0);
+    std::vector<uint32_t> outOfOrder(chainCount, 0);
+    std::vector<JobHandle> chains(chainCount);
+
+    for (uint32_t i = 0; i < TEST_JOB_COUNT; ++i)
+    {
+        const uint32_t chain = i % chainCount;
+        const uint32_t step = i / chainCount;
+        uint32_t* counter = &counters[chain];
+        uint32_t* errors = &outOfOrder[chain];
+        chains[chain] = JobSystem::Schedule([counter, errors, step]()
+        {
+            if (*counter != step)
+                (*errors)++;
+            (*counter)++;
+        }, chains[chain]);
+    }
+
+    uint32_t total = 0;
+    for (uint32_t chain = 0; chain < chainCount; ++chain)
+    {
+        JobSystem::Wait(chains[chain]);
+        TEST_CHECK(outOfOrder[chain] == 0);
+        total += counters[chain];
+    }
+    TEST_CHECK(total == TEST_JOB_COUNT);
+}
+
+static void TestFanOut()
+{
+    // all continuations of one job start once it is done
+    std::atomic<bool> bRootDone(false);
+    std::atomic<uint32_t> early(0);
+    std::atomic<uint32_t> counter(0);
+
+    JobHandle root = JobSystem::Schedule([&bRootDone]() { bRootDone = true; });
+    std::vector<JobHandle> handles;
+    for (uint32_t i = 0; i < 1000; ++i)
+    {
+        handles.push_back(JobSystem::Schedule([&bRootDone, &early, &counter]()
+        {
+            if (!bRootDone)
+                early++;
+            counter++;
+        }, root));
+    }
+
+    for (auto& handle : handles)
+        JobSystem::Wait(handle);
+
+    TEST_CHECK(early == 0);
+    TEST_CHECK(counter == 1000);
+}
+
+static void TestEmptyHandle()
+{
+    JobHandle handle;
+    TEST_CHECK(JobSystem::IsDone(handle));
+    JobSystem::Wait(handle);
+
+    // a job without workers runs right away
+    bool bRan = false;
+    JobSystem::Destroy();
+    JobHandle handleWithoutWorkers = JobSystem::Schedule([&bRan]() { bRan = true; });
+    TEST_CHECK(bRan && JobSystem::IsDone(handleWithoutWorkers));
+    JobSystem::Init(JOB_SYSTEM_WORKERS);
+}
+
+static void TestDestroyRunsQueuedJobs()
+{
+    std::atomic<uint32_t> counter(0);
+    for (uint32_t i = 0; i < 10000; ++i)
+    {
+        JobSystem::Schedule([&counter]() { counter++; });
+    }
+
+    JobSystem::Destroy();
+    TEST_CHECK(counter == 10000);
+    JobSystem::Init(JOB_SYSTEM_WORKERS);
+}
+
+int main()
+{
+    printf("JobSystemTest\n");
+    ThreadPool::Init();
+    TEST_CHECK(JobSystem::Init(JOB_SYSTEM_WORKERS));
+
+    TEST_RUN(TestIndependentJobs);
+    TEST_RUN(TestDependencyChain);
+    TEST_RUN(TestManyChains);
+    TEST_RUN(TestFanOut);
+    TEST_RUN(TestEmptyHandle);
+    TEST_RUN(TestDestroyRunsQueuedJobs);
+
+    JobSystem::Destroy();
+    ThreadPool::Destroy();
+    return TEST_RESULT();
+}
@@ -0,0 +1,132 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#include "Test.h"
+#include "../src/world/OcclusionBuffer.h"
+
+// 90 degree field of view and an aspect of 2, one world unit at distance one covers 32 texels in x and y
+#define TEST_NEAR 0.1f
+#define TEST_FAR 200.0f
+
+// the camera looks down -z from the position, the projection of the game
+static void SetCamera(OcclusionBuffer& buffer, float x, float y, float z)
+{
+    const float a = (TEST_FAR + TEST_NEAR) / (TEST_NEAR - TEST_FAR);
+    const float b = 2.0f * TEST_FAR * TEST_NEAR / (TEST_NEAR - TEST_FAR);
+    const float clip[16] =
+    {
+        0.5f, 0.0f, 0.0f, -0.5f * x,
+        0.0f, 1.0f, 0.0f, -y,
+        0.0f, 0.0f, a,    -a * z + b,
+        0.0f, 0.0f, -1.0f, z
+    };
+    buffer.Begin(clip, x, y, z);
+}
+
+static CullBox MakeBox(float minX, float minY, float minZ, float maxX, float maxY, float maxZ)
+{
+    return CullBox { { minX, minY, minZ, maxX, maxY, maxZ } };
+}
+
+static void TestEmptyBuffer()
+{
+    static OcclusionBuffer buffer;
+    SetCamera(buffer, 0.0f, 0.0f, 0.0f);
+    buffer.End();
+    TEST_CHECK(buffer.GetOccluderCount() == 0);
+    TEST_CHECK(!buffer.IsOccluded(MakeBox(-1.0f, -1.0f, -10.0f, 1.0f, 1.0f, -9.0f)));
+}
+
+static void TestBoxBehindBox()
+{
+    static OcclusionBuffer buffer;
+    SetCamera(buffer, 0.0f, 0.0f, 0.0f);
+    buffer.AddOccluder(MakeBox(-2.0f, -2.0f, -6.0f, 2.0f, 2.0f, -5.0f));
+    buffer.End();
+    TEST_CHECK(buffer.GetOccluderCount() == 1);
+
+    // behind the occluder and inside of its outline
+    TEST_CHECK(buffer.IsOccluded(MakeBox(-1.0f, -1.0f, -12.0f, 1.0f, 1.0f, -11.0f)));
+    TEST_CHECK(buffer.IsOccluded(MakeBox(2.0f, -0.5f, -12.0f, 3.0f, 0.5f, -11.0f)));
+    // in front of the occluder
+    TEST_CHECK(!buffer.IsOccluded(MakeBox(-1.0f, -1.0f, -3.0f, 1.0f, 1.0f, -2.0f)));
+    // behind it but reaching past its edge
+    TEST_CHECK(!buffer.IsOccluded(MakeBox(3.0f, -0.5f, -12.0f, 8.0f, 0.5f, -11.0f)));
+    // next to it
+    TEST_CHECK(!buffer.IsOccluded(MakeBox(10.0f, -1.0f, -12.0f, 12.0f, 1.0f, -11.0f)));
+    // starting in the plane of the face of the occluder, the depth bias keeps it visible
+    TEST_CHECK(!buffer.IsOccluded(MakeBox(-1.0f, -1.0f, -8.0f, 1.0f, 1.0f, -5.0f)));
+    // behind the camera or crossing the near plane
+    TEST_CHECK(!buffer.IsOccluded(MakeBox(-1.0f, -1.0f, 5.0f, 1.0f, 1.0f, 6.0f)));
+    TEST_CHECK(!buffer.IsOccluded(MakeBox(-1.0f, -1.0f, -12.0f, 1.0f, 1.0f, 1.0f)));
+}
+
+static void TestOccluderFacesTowardsCamera()
+{
+    // the camera is beside the occluder, so its side face hides what is behind that side
+    static OcclusionBuffer buffer;
+    SetCamera(buffer, 6.0f, 0.0f, 0.0f);
+    buffer.AddOccluder(MakeBox(-2.0f, -2.0f, -6.0f, 2.0f, 2.0f, -2.0f));
+    buffer.End();
+
+    TEST_CHECK(buffer.IsOccluded(MakeBox(-4.0f, -0.5f, -10.0f, -3.0f, 0.5f, -9.0f)));
+    TEST_CHECK(!buffer.IsOccluded(MakeBox(8.0f, -0.5f, -10.0f, 9.0f, 0.5f, -9.0f)));
+}
+
+static void TestHierarchicalFallback()
+{
+    // the right edge of the occluder face lies at texel 77, which is inside of a texel of every coarse level
+    static OcclusionBuffer buffer;
+    SetCamera(buffer, 0.0f, 0.0f, 0.0f);
+    buffer.AddOccluder(MakeBox(-10.0f, -10.0f, -2.0f, 13.0f / 32.0f * 1.9f, 10.0f, -1.9f));
+    buffer.End();
+
+    // covers texels 70 to 76, so the test starts at a coarse level whose texels reach past the edge
+    // and only the full resolution finds that the box is hidden
+    TEST_CHECK(buffer.IsOccluded(MakeBox(1.9f, -0.5f, -10.0f, 3.5f, 0.5f, -9.0f)));
+    // reaches texel 77, which is not covered
+    TEST_CHECK(!buffer.IsOccluded(MakeBox(1.9f, -0.5f, -10.0f, 3.7f, 0.5f, -9.0f)));
+    // a large box is decided by the coarse level alone
+    TEST_CHECK(buffer.IsOccluded(MakeBox(-30.0f, -5.0f, -20.0f, -5.0f, 5.0f, -15.0f)));
+}
+
+static void TestBeginClears()
+{
+    static OcclusionBuffer buffer;
+    SetCamera(buffer, 0.0f, 0.0f, 0.0f);
+    buffer.AddOccluder(MakeBox(-2.0f, -2.0f, -6.0f, 2.0f, 2.0f, -5.0f));
+    buffer.End();
+    TEST_CHECK(buffer.IsOccluded(MakeBox(-1.0f, -1.0f, -12.0f, 1.0f, 1.0f, -11.0f)));
+
+    SetCamera(buffer, 0.0f, 0.0f, 0.0f);
+    buffer.End();
+    TEST_CHECK(buffer.GetOccluderCount() == 0);
+    TEST_CHECK(!buffer.IsOccluded(MakeBox(-1.0f, -1.0f, -12.0f, 1.0f, 1.0f, -11.0f)));
+}
+
+int main()
+{
+    printf("OcclusionBufferTest\n");
+    TEST_RUN(TestEmptyBuffer);
+    TEST_RUN(TestBoxBehindBox);
+    TEST_RUN(TestOccluderFacesTowardsCamera);
+    TEST_RUN(TestHierarchicalFallback);
+    TEST_RUN(TestBeginClears);
+    return TEST_RESULT();
+}
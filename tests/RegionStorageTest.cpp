@@ -0,0 +1,230 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Test.h"
+#include "../src/world/chunk/RegionStorage.h"
+
+#define TEST_WRITERS 4
+#define TEST_READERS 2
+// the chunks of one writer lie in more regions than REGION_STORAGE_MAX_OPEN_FILES, so the regions are closed and opened again
+#define TEST_CHUNKS_PER_WRITER 12
+#define TEST_VERSIONS 16
+#define TEST_APPENDS 100
+#define TEST_EDITS_PER_APPEND 2
+
+static std::string s_directory;
+
+// a chunk of version v is solid up to 10 + v blocks, the block type depends on the chunk
+static ChunkFileData MakeChunk(const ChunkCoord& coord, uint32_t version)
+{
+    ChunkFileData data;
+    data.X = coord.X;
+    data.Z = coord.Z;
+    data.Blocks.assign(CHUNK_FILE_BLOCK_COUNT, 0);
+    const uint8_t type = 1 + ((coord.X + coord.Z) & 3);
+    for (uint32_t x = 0; x < CHUNK_FILE_SIZE_X; ++x)
+    {
+        for (uint32_t z = 0; z < CHUNK_FILE_SIZE_Z; ++z)
+        {
+            for (uint32_t y = 0; y < 10 + version; ++y)
+                data.Blocks[ChunkFile::GetIndex(x, y, z)] = type;
+        }
+    }
+    return data;
+}
+
+// the version of a loaded chunk, or -1 if it is not a chunk MakeChunk wrote
+static int32_t GetChunkVersion(const ChunkCoord& coord, const ChunkFileData& data)
+{
+    if (data.X != coord.X || data.Z != coord.Z || data.Blocks.size() != CHUNK_FILE_BLOCK_COUNT)
+        return -1;
+
+    uint32_t height = 0;
+    while (height < CHUNK_FILE_SIZE_Y && data.Blocks[ChunkFile::GetIndex(0, height, 0)] != 0)
+        height++;
+
+    if (height < 10 || data.Blocks != MakeChunk(coord, height - 10).Blocks)
+        return -1;
+    return height - 10;
+}
+
+static ChunkCoord GetWriterChunk(uint32_t writer, uint32_t chunk)
+{
+    return ChunkCoord { (int32_t) (chunk % 6) * REGION_SIZE - 2 * REGION_SIZE + (int32_t) writer, (int32_t) (chunk / 6) * REGION_SIZE - (int32_t) writer };
+}
+
+static void RemoveDirectory(const std::string& path)
+{
+    DIR* directory = opendir(path.c_str());
+    if (directory)
+    {
+        while (dirent* entry = readdir(directory))
+        {
+            if (entry->d_name[0] != '.')
+                remove((path + "/" + entry->d_name).c_str());
+        }
+        closedir(directory);
+    }
+    remove(path.c_str());
+}
+
+static void TestRewriteKeepsOldRecord()
+{
+    const std::string path = s_directory + "/rewrite" + REGION_FILE_EXTENSION;
+    std::vector<uint8_t> small(100, 1);
+    std::vector<uint8_t> large(3 * REGION_SECTOR_SIZE, 2);
+    std::vector<uint8_t> record;
+
+    {
+        RegionFile region;
+        TEST_CHECK(region.Open(path, true));
+        TEST_CHECK(region.Write(7, large.data(), large.size()));
+        for (uint32_t i = 0; i < 50; ++i)
+        {
+            TEST_CHECK(region.Write(7, small.data(), small.size()));
+            TEST_CHECK(region.Write(7, large.data(), large.size()));
+        }
+        TEST_CHECK(region.Read(7, record) && record == large);
+    }
+
+    // the freed sectors are reused, so the file holds at most two copies of the record behind the table
+    FILE* file = fopen(path.c_str(), "rb");
+    TEST_CHECK(file != nullptr);
+    fseek(file, 0, SEEK_END);
+    TEST_CHECK(ftell(file) <= (REGION_HEADER_SECTORS + 8) * REGION_SECTOR_SIZE);
+    fclose(file);
+
+    RegionFile region;
+    TEST_CHECK(region.Open(path, false));
+    TEST_CHECK(region.Read(7, record) && record == large);
+    TEST_CHECK(!region.HasRecord(8));
+}
+
+static void TestConcurrentWriters()
+{
+    static RegionStorage storage;
+    storage.Init(s_directory);
+    std::atomic<uint32_t> runningWriters(TEST_WRITERS + 1);
+    std::atomic<uint32_t> errors(0);
+    std::vector<std::thread> threads;
+
+    // every writer owns its chunks and saves them version after version
+    for (uint32_t writer = 0; writer < TEST_WRITERS; ++writer)
+    {
+        threads.emplace_back([writer, &runningWriters, &errors]()
+        {
+            for (uint32_t version = 0; version < TEST_VERSIONS; ++version)
+            {
+                for (uint32_t chunk = 0; chunk < TEST_CHUNKS_PER_WRITER; ++chunk)
+                {
+                    const ChunkCoord coord = GetWriterChunk(writer, chunk);
+                    if (!storage.SaveChunk(coord, MakeChunk(coord, version)))
+                        errors++;
+                }
+            }
+            runningWriters--;
+        });
+    }
+
+    // edits are appended to chunks without a record, like the serialization job does for chunks which were never saved
+    threads.emplace_back([&runningWriters, &errors]()
+    {
+        for (uint32_t append = 0; append < TEST_APPENDS; ++append)
+        {
+            std::vector<ChunkFileEdit> edits;
+            for (uint32_t i = 0; i < TEST_EDITS_PER_APPEND; ++i)
+            {
+                const uint32_t edit = append * TEST_EDITS_PER_APPEND + i;
+                edits.push_back(ChunkFileEdit { (uint8_t) (edit % CHUNK_FILE_SIZE_X), (uint8_t) (edit / CHUNK_FILE_SIZE_X), 3, 1 });
+            }
+
+            uint32_t editCount = 0;
+            if (!storage.AppendEdits(ChunkCoord { -1, -1 }, edits, editCount) || editCount != (append + 1) * TEST_EDITS_PER_APPEND)
+                errors++;
+        }
+        runningWriters--;
+    });
+
+    // a loaded chunk is always one complete version, never a mix of two writes
+    std::atomic<uint32_t> loadedChunks(0);
+    for (uint32_t reader = 0; reader < TEST_READERS; ++reader)
+    {
+        threads.emplace_back([reader, &runningWriters, &errors, &loadedChunks]()
+        {
+            for (uint32_t i = reader; runningWriters > 0; ++i)
+            {
+                const ChunkCoord coord = GetWriterChunk(i % TEST_WRITERS, (i / TEST_WRITERS) % TEST_CHUNKS_PER_WRITER);
+                ChunkFileData data;
+                if (!storage.LoadChunk(coord, data))
+                    continue;
+
+                if (GetChunkVersion(coord, data) < 0)
+                    errors++;
+                loadedChunks++;
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+    storage.Close();
+    TEST_CHECK(errors == 0);
+    printf("    %u chunks loaded while writing\n", loadedChunks.load());
+
+    // a new storage reads the last version of every chunk and all edits from the files
+    RegionStorage reopened;
+    reopened.Init(s_directory);
+    for (uint32_t writer = 0; writer < TEST_WRITERS; ++writer)
+    {
+        for (uint32_t chunk = 0; chunk < TEST_CHUNKS_PER_WRITER; ++chunk)
+        {
+            const ChunkCoord coord = GetWriterChunk(writer, chunk);
+            ChunkFileData data;
+            TEST_CHECK(reopened.LoadChunk(coord, data) && GetChunkVersion(coord, data) == TEST_VERSIONS - 1);
+        }
+    }
+
+    ChunkFileData data;
+    TEST_CHECK(reopened.LoadChunk(ChunkCoord { -1, -1 }, data));
+    TEST_CHECK(data.EditCount == TEST_APPENDS * TEST_EDITS_PER_APPEND);
+    for (uint32_t edit = 0; edit < TEST_APPENDS * TEST_EDITS_PER_APPEND; ++edit)
+        TEST_CHECK(data.Blocks[ChunkFile::GetIndex(edit % CHUNK_FILE_SIZE_X, edit / CHUNK_FILE_SIZE_X, 3)] == 1);
+}
+
+int main()
+{
+    printf("RegionStorageTest\n");
+    char directory[] = "/tmp/RegionStorageTestXXXXXX";
+    if (!mkdtemp(directory))
+        return 1;
+    s_directory = directory;
+
+    TEST_RUN(TestRewriteKeepsOldRecord);
+    TEST_RUN(TestConcurrentWriters);
+
+    RemoveDirectory(s_directory);
+    return TEST_RESULT();
+}
@@ -0,0 +1,143 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "Test.h"
+#include "../src/utils/RingBuffer.h"
+
+#define TEST_PRODUCERS 4
+#define TEST_ITEMS_PER_PRODUCER 100000
+
+// an item carries its producer in the upper bits and its position in the lower bits
+#define TEST_PRODUCER_SHIFT 24
+
+static void TestEmptyAndFull()
+{
+    MpscRingBuffer<uint32_t, 4> buffer;
+    TEST_CHECK(!buffer.TryPop());
+
+    for (uint32_t i = 0; i < 4; ++i)
+        TEST_CHECK(buffer.TryPush(uint32_t(i)));
+    TEST_CHECK(!buffer.TryPush(4));
+
+    // the slots are reused after the consumer freed them
+    for (uint32_t round = 0; round < 10; ++round)
+    {
+        Optional<uint32_t> value = buffer.TryPop();
+        TEST_CHECK(value && *value == round);
+        TEST_CHECK(buffer.TryPush(uint32_t(round + 4)));
+    }
+
+    std::vector<uint32_t> drained;
+    TEST_CHECK(buffer.Drain(drained, 3) == 3);
+    TEST_CHECK(buffer.Drain(drained) == 1);
+    TEST_CHECK(drained.size() == 4 && drained[0] == 10 && drained[3] == 13);
+    TEST_CHECK(!buffer.TryPop());
+}
+
+static void TestMoveOnly()
+{
+    MpscRingBuffer<std::unique_ptr<uint32_t>, 8> buffer;
+    std::unique_ptr<uint32_t> value(new uint32_t(42));
+    TEST_CHECK(buffer.TryPush(std::move(value)));
+    TEST_CHECK(!value);
+
+    Optional<std::unique_ptr<uint32_t>> popped = buffer.TryPop();
+    TEST_CHECK(popped && **popped == 42);
+}
+
+static void TestManyProducers()
+{
+    // a small buffer, so the producers run into a full buffer and race for the same slots
+    MpscRingBuffer<uint32_t, 64> buffer;
+    std::atomic<bool> bStart(false);
+    std::vector<std::thread> producers;
+
+    for (uint32_t producer = 0; producer < TEST_PRODUCERS; ++producer)
+    {
+        producers.emplace_back([&buffer, &bStart, producer]()
+        {
+            while (!bStart)
+                std::this_thread::yield();
+
+            for (uint32_t i = 0; i < TEST_ITEMS_PER_PRODUCER; ++i)
+            {
+                const uint32_t item = (producer << TEST_PRODUCER_SHIFT) | i;
+                while (!buffer.TryPush(uint32_t(item)))
+                    std::this_thread::yield();
+            }
+        });
+    }
+
+    // the items of one producer arrive in the order it pushed them, the consumer switches between pop and drain
+    std::vector<uint32_t> next(TEST_PRODUCERS, 0);
+    std::vector<uint32_t> drained;
+    uint32_t received = 0;
+    uint32_t outOfOrder = 0;
+    bStart = true;
+
+    while (received < TEST_PRODUCERS * TEST_ITEMS_PER_PRODUCER)
+    {
+        drained.clear();
+        if (received & 1)
+        {
+            Optional<uint32_t> item = buffer.TryPop();
+            if (item)
+                drained.push_back(*item);
+        }
+        else
+        {
+            buffer.Drain(drained, 16);
+        }
+
+        if (drained.empty())
+            std::this_thread::yield();
+
+        for (uint32_t item : drained)
+        {
+            const uint32_t producer = item >> TEST_PRODUCER_SHIFT;
+            const uint32_t position = item & ((1 << TEST_PRODUCER_SHIFT) - 1);
+            if (producer >= TEST_PRODUCERS || position != next[producer])
+                outOfOrder++;
+            else
+                next[producer]++;
+            received++;
+        }
+    }
+
+    for (auto& thread : producers)
+        thread.join();
+
+    TEST_CHECK(outOfOrder == 0);
+    TEST_CHECK(!buffer.TryPop());
+    for (uint32_t producer = 0; producer < TEST_PRODUCERS; ++producer)
+        TEST_CHECK(next[producer] == TEST_ITEMS_PER_PRODUCER);
+}
+
+int main()
+{
+    printf("RingBufferTest\n");
+    TEST_RUN(TestEmptyAndFull);
+    TEST_RUN(TestMoveOnly);
+    TEST_RUN(TestManyProducers);
+    return TEST_RESULT();
+}
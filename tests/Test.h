@@ -0,0 +1,47 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdio.h>
+
+// a host test is one program, it prints every failed check and main returns TEST_RESULT()
+static int s_testFailures = 0;
+
+#define TEST_CHECK(condition) \
+    do \
+    { \
+        if (!(condition)) \
+        { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            s_testFailures++; \
+        } \
+    } while (0)
+
+#define TEST_RUN(test) \
+    do \
+    { \
+        printf("  %s\n", #test); \
+        test(); \
+    } while (0)
+
+#define TEST_RESULT() (s_testFailures > 0 ? 1 : 0)
+
+#endif // TEST_H
@@ -0,0 +1,52 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#include <algorithm>
+#include "Image.h"
+
+Image::Image(uint32_t width, uint32_t height) : m_width(width), m_height(height), m_pixels(width * height * 4, 0)
+{
+}
+
+const uint8_t* Image::GetWrappedPixel(int32_t x, int32_t y) const
+{
+    const int32_t width = m_width;
+    const int32_t height = m_height;
+    return GetPixel(((x % width) + width) % width, ((y % height) + height) % height);
+}
+
+Image Image::Downsample() const
+{
+    Image result(std::max<uint32_t>(m_width / 2, 1), std::max<uint32_t>(m_height / 2, 1));
+    for (uint32_t y = 0; y < result.m_height; ++y)
+    {
+        for (uint32_t x = 0; x < result.m_width; ++x)
+        {
+            const uint32_t x1 = std::min(x * 2 + 1, m_width - 1);
+            const uint32_t y1 = std::min(y * 2 + 1, m_height - 1);
+            const uint8_t* samples[4] = { GetPixel(x * 2, y * 2), GetPixel(x1, y * 2), GetPixel(x * 2, y1), GetPixel(x1, y1) };
+
+            uint8_t* pixel = result.GetPixel(x, y);
+            for (uint32_t channel = 0; channel < 4; ++channel)
+                pixel[channel] = (samples[0][channel] + samples[1][channel] + samples[2][channel] + samples[3][channel] + 2) / 4;
+        }
+    }
+
+    return result;
+}
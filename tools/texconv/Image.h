@@ -0,0 +1,61 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#ifndef _IMAGE_H_
+#define _IMAGE_H_
+
+#include <stdint.h>
+#include <vector>
+
+/**
+ * @brief Image
+ * RGBA8 pixels of a texture on the host, rows from top to bottom.
+ */
+class Image
+{
+public:
+    Image() = default;
+    Image(uint32_t width, uint32_t height);
+
+    uint32_t GetWidth() const { return m_width; }
+    uint32_t GetHeight() const { return m_height; }
+
+    inline uint8_t* GetPixel(uint32_t x, uint32_t y)
+    {
+        return &m_pixels[(y * m_width + x) * 4];
+    }
+
+    inline const uint8_t* GetPixel(uint32_t x, uint32_t y) const
+    {
+        return &m_pixels[(y * m_width + x) * 4];
+    }
+
+    // the texture repeats outside of the image, like GX_REPEAT
+    const uint8_t* GetWrappedPixel(int32_t x, int32_t y) const;
+
+    // half the size in both directions, every pixel is the average of a 2x2 block, odd sizes are rounded down
+    Image Downsample() const;
+
+private:
+    uint32_t m_width    = 0;
+    uint32_t m_height   = 0;
+    std::vector<uint8_t> m_pixels;
+};
+
+#endif /* _IMAGE_H_ */
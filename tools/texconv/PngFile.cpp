@@ -0,0 +1,47 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#include <stdio.h>
+#include <string.h>
+#include <png.h>
+#include "PngFile.h"
+
+bool PngFile::Read(const std::string& path, Image& image)
+{
+    png_image png;
+    memset(&png, 0, sizeof(png));
+    png.version = PNG_IMAGE_VERSION;
+
+    if (!png_image_begin_read_from_file(&png, path.c_str()))
+    {
+        fprintf(stderr, "%s: %s\n", path.c_str(), png.message);
+        return false;
+    }
+
+    png.format = PNG_FORMAT_RGBA;
+    image = Image(png.width, png.height);
+    if (!png_image_finish_read(&png, nullptr, image.GetPixel(0, 0), 0, nullptr))
+    {
+        fprintf(stderr, "%s: %s\n", path.c_str(), png.message);
+        png_image_free(&png);
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,36 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#ifndef _PNGFILE_H_
+#define _PNGFILE_H_
+
+#include <string>
+#include "Image.h"
+
+/**
+ * @brief PngFile
+ * Reads PNG files with libpng, every colour type is expanded to RGBA8.
+ */
+class PngFile
+{
+public:
+    static bool Read(const std::string& path, Image& image);
+};
+
+#endif /* _PNGFILE_H_ */
@@ -0,0 +1,185 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "Image.h"
+#include "PngFile.h"
+#include "TplFile.h"
+#include "../../src/textures/BlockAtlasLayout.h"
+
+/**
+ * texconv converts textures into the TPL files linked into the game.
+ *
+ *   texconv convert <format> <input.png> <output.tpl> [--mipmaps]
+ *       encodes a png as i4, i8, ia8, rgb565, rgb5a3 or cmpr, --mipmaps adds every level down to 1x1
+ *
+ *   texconv atlas <output.tpl> <tile.tpl>...
+ *       packs square textures into the block atlas, see BlockAtlasLayout.h
+ */
+
+static void PrintUsage()
+{
+    fprintf(stderr, "usage: texconv convert <i4|i8|ia8|rgb565|rgb5a3|cmpr> <input.png> <output.tpl> [--mipmaps]\n");
+    fprintf(stderr, "       texconv atlas <output.tpl> <tile.tpl>...\n");
+}
+
+static bool ParseFormat(const char* name, ETextureFormat& format)
+{
+    static const struct
+    {
+        const char* Name;
+        ETextureFormat Format;
+    } s_formats[] =
+    {
+        { "i4",     ETextureFormat::I4 },
+        { "i8",     ETextureFormat::I8 },
+        { "ia8",    ETextureFormat::IA8 },
+        { "rgb565", ETextureFormat::RGB565 },
+        { "rgb5a3", ETextureFormat::RGB5A3 },
+        { "cmpr",   ETextureFormat::CMPR }
+    };
+
+    for (const auto& entry : s_formats)
+    {
+        if (strcmp(name, entry.Name) == 0)
+        {
+            format = entry.Format;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool Convert(ETextureFormat format, const std::string& input, const std::string& output, bool bMipmaps)
+{
+    Image image;
+    if (!PngFile::Read(input, image))
+        return false;
+
+    // sprites are drawn with their own size, only power of two textures can be sampled by mip level
+    const bool bPowerOfTwo = !(image.GetWidth() & (image.GetWidth() - 1)) && !(image.GetHeight() & (image.GetHeight() - 1));
+    if (bMipmaps && !bPowerOfTwo)
+    {
+        fprintf(stderr, "%s: mipmaps need a power of two size, the image is %ux%u\n", input.c_str(), image.GetWidth(), image.GetHeight());
+        return false;
+    }
+
+    TplTexture texture;
+    texture.Format = format;
+    texture.WrapS = ETextureWrap::Clamp;
+    texture.WrapT = ETextureWrap::Clamp;
+    texture.MinFilter = bMipmaps ? ETextureFilter::LinearMipLinear : ETextureFilter::Linear;
+    texture.MagFilter = ETextureFilter::Linear;
+    texture.Levels.push_back(image);
+
+    while (bMipmaps && (image.GetWidth() > 1 || image.GetHeight() > 1))
+    {
+        image = image.Downsample();
+        texture.Levels.push_back(image);
+    }
+
+    return TplFile::Write(output, texture);
+}
+
+static bool PackAtlas(const std::string& output, const std::vector<std::string>& inputs)
+{
+    if (inputs.size() > BLOCK_ATLAS_MAX_TILES)
+    {
+        fprintf(stderr, "%s: %u textures do not fit into the %u tiles of the atlas\n", output.c_str(), (uint32_t) inputs.size(), BLOCK_ATLAS_MAX_TILES);
+        return false;
+    }
+
+    std::vector<Image> tiles;
+    for (const std::string& input : inputs)
+    {
+        TplTexture texture;
+        if (!TplFile::Read(input, texture))
+            return false;
+
+        Image tile = texture.Levels.front();
+        if (tile.GetWidth() != tile.GetHeight() || tile.GetWidth() < BLOCK_ATLAS_TILE_SIZE || (tile.GetWidth() & (tile.GetWidth() - 1)))
+        {
+            fprintf(stderr, "%s: a tile needs a square power of two size of at least %u\n", input.c_str(), BLOCK_ATLAS_TILE_SIZE);
+            return false;
+        }
+
+        while (tile.GetWidth() > BLOCK_ATLAS_TILE_SIZE)
+            tile = tile.Downsample();
+        tiles.push_back(std::move(tile));
+    }
+
+    // the tev stage wraps the coordinates inside a tile, clamping keeps the filter from reading across the atlas border
+    TplTexture atlas;
+    atlas.Format = ETextureFormat::CMPR;
+    atlas.WrapS = ETextureWrap::Clamp;
+    atlas.WrapT = ETextureWrap::Clamp;
+    atlas.MinFilter = ETextureFilter::LinearMipLinear;
+    atlas.MagFilter = ETextureFilter::Linear;
+
+    for (uint32_t level = 0; level < BLOCK_ATLAS_LEVELS; ++level)
+    {
+        const int32_t tileSize = BLOCK_ATLAS_TILE_SIZE >> level;
+        const int32_t gutter = BLOCK_ATLAS_TILE_GUTTER >> level;
+        const int32_t spacing = BLOCK_ATLAS_TILE_SPACING >> level;
+
+        // every level of a tile is scaled down from the tile itself, so the gutters never mix neighboring tiles
+        Image image(BLOCK_ATLAS_SIZE >> level, BLOCK_ATLAS_SIZE >> level);
+        for (uint32_t tile = 0; tile < tiles.size(); ++tile)
+        {
+            const int32_t originX = gutter + (tile % BLOCK_ATLAS_COLUMNS) * spacing;
+            const int32_t originY = gutter + (tile / BLOCK_ATLAS_COLUMNS) * spacing;
+            for (int32_t y = -gutter; y < tileSize + gutter; ++y)
+            {
+                for (int32_t x = -gutter; x < tileSize + gutter; ++x)
+                    memcpy(image.GetPixel(originX + x, originY + y), tiles[tile].GetWrappedPixel(x, y), 4);
+            }
+
+            tiles[tile] = tiles[tile].Downsample();
+        }
+
+        atlas.Levels.push_back(std::move(image));
+    }
+
+    return TplFile::Write(output, atlas);
+}
+
+int main(int argc, char** argv)
+{
+    if ((argc == 5 || (argc == 6 && strcmp(argv[5], "--mipmaps") == 0)) && strcmp(argv[1], "convert") == 0)
+    {
+        ETextureFormat format;
+        if (!ParseFormat(argv[2], format))
+        {
+            fprintf(stderr, "unknown texture format %s\n", argv[2]);
+            return 1;
+        }
+
+        return Convert(format, argv[3], argv[4], argc == 6) ? 0 : 1;
+    }
+
+    if (argc >= 4 && strcmp(argv[1], "atlas") == 0)
+        return PackAtlas(argv[2], std::vector<std::string>(argv + 3, argv + argc)) ? 0 : 1;
+
+    PrintUsage();
+    return 1;
+}
@@ -0,0 +1,485 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#include <algorithm>
+#include <cmath>
+#include "TextureCodec.h"
+
+// pixels below this alpha are stored as the transparent colour of CMPR
+#define CMPR_ALPHA_THRESHOLD 128
+
+namespace
+{
+    uint32_t Quantize(float value, uint32_t maxValue)
+    {
+        const uint32_t clamped = (uint32_t) (std::min(std::max(value, 0.0f), 255.0f) + 0.5f);
+        return (clamped * maxValue + 127) / 255;
+    }
+
+    uint16_t PackRGB565(const float color[3])
+    {
+        return (uint16_t) ((Quantize(color[0], 31) << 11) | (Quantize(color[1], 63) << 5) | Quantize(color[2], 31));
+    }
+
+    void UnpackRGB565(uint16_t packed, uint8_t color[4])
+    {
+        const uint32_t r = (packed >> 11) & 0x1F;
+        const uint32_t g = (packed >> 5) & 0x3F;
+        const uint32_t b = packed & 0x1F;
+        color[0] = (uint8_t) ((r << 3) | (r >> 2));
+        color[1] = (uint8_t) ((g << 2) | (g >> 4));
+        color[2] = (uint8_t) ((b << 3) | (b >> 2));
+        color[3] = 0xFF;
+    }
+
+    // the four colours of a CMPR block, the last one is transparent if the first colour is not the bigger one
+    void GetCMPRPalette(uint16_t color0, uint16_t color1, uint8_t palette[4][4])
+    {
+        UnpackRGB565(color0, palette[0]);
+        UnpackRGB565(color1, palette[1]);
+        for (uint32_t channel = 0; channel < 3; ++channel)
+        {
+            if (color0 > color1)
+            {
+                palette[2][channel] = (uint8_t) ((2 * palette[0][channel] + palette[1][channel]) / 3);
+                palette[3][channel] = (uint8_t) ((palette[0][channel] + 2 * palette[1][channel]) / 3);
+            }
+            else
+            {
+                palette[2][channel] = (uint8_t) ((palette[0][channel] + palette[1][channel]) / 2);
+                palette[3][channel] = 0;
+            }
+        }
+        palette[2][3] = 0xFF;
+        palette[3][3] = color0 > color1 ? 0xFF : 0;
+    }
+
+    void WriteBigEndian16(uint8_t* data, uint16_t value)
+    {
+        data[0] = (uint8_t) (value >> 8);
+        data[1] = (uint8_t) value;
+    }
+
+    uint16_t ReadBigEndian16(const uint8_t* data)
+    {
+        return (uint16_t) ((data[0] << 8) | data[1]);
+    }
+
+    uint8_t GetIntensity(const uint8_t* pixel)
+    {
+        return (uint8_t) ((pixel[0] * 77 + pixel[1] * 150 + pixel[2] * 29) >> 8);
+    }
+
+    // widens a channel of the given bits back to 8 bits
+    uint8_t Expand(uint32_t value, uint32_t bits)
+    {
+        return (uint8_t) ((value << (8 - bits)) | (value >> (2 * bits - 8)));
+    }
+
+    uint8_t Expand4(uint32_t value)
+    {
+        return (uint8_t) (value * 0x11);
+    }
+
+    uint8_t Expand3(uint32_t value)
+    {
+        return (uint8_t) ((value << 5) | (value << 2) | (value >> 1));
+    }
+
+    uint16_t PackRGB5A3(const uint8_t* pixel)
+    {
+        // opaque pixels keep five bits per colour, the others trade one colour bit for three bits of alpha
+        if (pixel[3] == 255)
+            return (uint16_t) (0x8000 | ((pixel[0] >> 3) << 10) | ((pixel[1] >> 3) << 5) | (pixel[2] >> 3));
+
+        return (uint16_t) (((pixel[3] >> 5) << 12) | ((pixel[0] >> 4) << 8) | ((pixel[1] >> 4) << 4) | (pixel[2] >> 4));
+    }
+
+    void UnpackRGB5A3(uint16_t packed, uint8_t* pixel)
+    {
+        if (packed & 0x8000)
+        {
+            pixel[0] = Expand((packed >> 10) & 31, 5);
+            pixel[1] = Expand((packed >> 5) & 31, 5);
+            pixel[2] = Expand(packed & 31, 5);
+            pixel[3] = 255;
+        }
+        else
+        {
+            pixel[0] = Expand4((packed >> 8) & 15);
+            pixel[1] = Expand4((packed >> 4) & 15);
+            pixel[2] = Expand4(packed & 15);
+            pixel[3] = Expand3((packed >> 12) & 7);
+        }
+    }
+}
+
+bool TextureCodec::IsSupported(ETextureFormat format)
+{
+    switch (format)
+    {
+    case ETextureFormat::I4:
+    case ETextureFormat::I8:
+    case ETextureFormat::IA8:
+    case ETextureFormat::RGB565:
+    case ETextureFormat::RGB5A3:
+    case ETextureFormat::CMPR:
+        return true;
+    default:
+        return false;
+    }
+}
+
+uint32_t TextureCodec::GetLevelSize(ETextureFormat format, uint32_t width, uint32_t height)
+{
+    switch (format)
+    {
+    case ETextureFormat::I4:
+    case ETextureFormat::CMPR:
+        return ((width + 7) / 8) * ((height + 7) / 8) * 32;
+    case ETextureFormat::I8:
+    case ETextureFormat::IA4:
+        return ((width + 7) / 8) * ((height + 3) / 4) * 32;
+    case ETextureFormat::IA8:
+    case ETextureFormat::RGB565:
+    case ETextureFormat::RGB5A3:
+        return ((width + 3) / 4) * ((height + 3) / 4) * 32;
+    case ETextureFormat::RGBA8:
+        return ((width + 3) / 4) * ((height + 3) / 4) * 64;
+    }
+
+    return 0;
+}
+
+bool TextureCodec::Encode(ETextureFormat format, const Image& image, std::vector<uint8_t>& data)
+{
+    if (!IsSupported(format))
+        return false;
+
+    const size_t offset = data.size();
+    data.resize(offset + GetLevelSize(format, image.GetWidth(), image.GetHeight()), 0);
+    uint8_t* out = &data[offset];
+
+    if (format != ETextureFormat::CMPR)
+    {
+        uint32_t tileWidth, tileHeight;
+        GetTileSize(format, tileWidth, tileHeight);
+        for (uint32_t tileY = 0; tileY < image.GetHeight(); tileY += tileHeight)
+        {
+            for (uint32_t tileX = 0; tileX < image.GetWidth(); tileX += tileWidth)
+            {
+                EncodeTile(format, image, tileX, tileY, out);
+                out += 32;
+            }
+        }
+
+        return true;
+    }
+
+    // 8x8 tiles from left to right, each tile holds four 4x4 blocks in reading order
+    for (uint32_t tileY = 0; tileY < image.GetHeight(); tileY += 8)
+    {
+        for (uint32_t tileX = 0; tileX < image.GetWidth(); tileX += 8)
+        {
+            for (uint32_t block = 0; block < 4; ++block)
+            {
+                EncodeCMPRBlock(image, tileX + (block % 2) * 4, tileY + (block / 2) * 4, out);
+                out += 8;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool TextureCodec::Decode(ETextureFormat format, const uint8_t* data, uint32_t width, uint32_t height, Image& image)
+{
+    if (!IsSupported(format))
+        return false;
+
+    image = Image(width, height);
+    if (format != ETextureFormat::CMPR)
+    {
+        uint32_t tileWidth, tileHeight;
+        GetTileSize(format, tileWidth, tileHeight);
+        for (uint32_t tileY = 0; tileY < height; tileY += tileHeight)
+        {
+            for (uint32_t tileX = 0; tileX < width; tileX += tileWidth)
+            {
+                DecodeTile(format, data, tileX, tileY, image);
+                data += 32;
+            }
+        }
+
+        return true;
+    }
+
+    for (uint32_t tileY = 0; tileY < height; tileY += 8)
+    {
+        for (uint32_t tileX = 0; tileX < width; tileX += 8)
+        {
+            for (uint32_t block = 0; block < 4; ++block)
+            {
+                DecodeCMPRBlock(data, tileX + (block % 2) * 4, tileY + (block / 2) * 4, image);
+                data += 8;
+            }
+        }
+    }
+
+    return true;
+}
+
+void TextureCodec::GetTileSize(ETextureFormat format, uint32_t& width, uint32_t& height)
+{
+    switch (format)
+    {
+    case ETextureFormat::I4:
+        width = 8;
+        height = 8;
+        break;
+    case ETextureFormat::I8:
+    case ETextureFormat::IA4:
+        width = 8;
+        height = 4;
+        break;
+    default:
+        width = 4;
+        height = 4;
+        break;
+    }
+}
+
+void TextureCodec::EncodeTile(ETextureFormat format, const Image& image, uint32_t tileX, uint32_t tileY, uint8_t* tile)
+{
+    uint32_t tileWidth, tileHeight;
+    GetTileSize(format, tileWidth, tileHeight);
+
+    for (uint32_t y = 0; y < tileHeight; ++y)
+    {
+        for (uint32_t x = 0; x < tileWidth; ++x)
+        {
+            // texels outside of a small mip level repeat the last row and column
+            const uint8_t* pixel = image.GetPixel(std::min(tileX + x, image.GetWidth() - 1), std::min(tileY + y, image.GetHeight() - 1));
+            const uint32_t texel = y * tileWidth + x;
+
+            switch (format)
+            {
+            case ETextureFormat::I4:
+                tile[texel / 2] |= ((GetIntensity(pixel) * 15 + 127) / 255) << ((texel % 2) ? 0 : 4);
+                break;
+            case ETextureFormat::I8:
+                tile[texel] = GetIntensity(pixel);
+                break;
+            case ETextureFormat::IA8:
+                tile[texel * 2] = pixel[3];
+                tile[texel * 2 + 1] = GetIntensity(pixel);
+                break;
+            case ETextureFormat::RGB565:
+            {
+                const float color[3] = { (float) pixel[0], (float) pixel[1], (float) pixel[2] };
+                WriteBigEndian16(tile + texel * 2, PackRGB565(color));
+                break;
+            }
+            case ETextureFormat::RGB5A3:
+                WriteBigEndian16(tile + texel * 2, PackRGB5A3(pixel));
+                break;
+            default:
+                break;
+            }
+        }
+    }
+}
+
+void TextureCodec::DecodeTile(ETextureFormat format, const uint8_t* tile, uint32_t tileX, uint32_t tileY, Image& image)
+{
+    uint32_t tileWidth, tileHeight;
+    GetTileSize(format, tileWidth, tileHeight);
+
+    for (uint32_t y = 0; y < tileHeight && tileY + y < image.GetHeight(); ++y)
+    {
+        for (uint32_t x = 0; x < tileWidth && tileX + x < image.GetWidth(); ++x)
+        {
+            uint8_t* pixel = image.GetPixel(tileX + x, tileY + y);
+            const uint32_t texel = y * tileWidth + x;
+
+            switch (format)
+            {
+            case ETextureFormat::I4:
+                pixel[0] = pixel[1] = pixel[2] = pixel[3] = Expand4((tile[texel / 2] >> ((texel % 2) ? 0 : 4)) & 15);
+                break;
+            case ETextureFormat::I8:
+                pixel[0] = pixel[1] = pixel[2] = pixel[3] = tile[texel];
+                break;
+            case ETextureFormat::IA8:
+                pixel[0] = pixel[1] = pixel[2] = tile[texel * 2 + 1];
+                pixel[3] = tile[texel * 2];
+                break;
+            case ETextureFormat::RGB565:
+                UnpackRGB565(ReadBigEndian16(tile + texel * 2), pixel);
+                break;
+            case ETextureFormat::RGB5A3:
+                UnpackRGB5A3(ReadBigEndian16(tile + texel * 2), pixel);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+}
+
+void TextureCodec::EncodeCMPRBlock(const Image& image, uint32_t blockX, uint32_t blockY, uint8_t* block)
+{
+    // pixels outside of a small mip level repeat the last row and column
+    float pixels[16][3];
+    bool opaque[16];
+    uint32_t opaqueCount = 0;
+    float mean[3] = { 0, 0, 0 };
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        const uint32_t x = std::min(blockX + i % 4, image.GetWidth() - 1);
+        const uint32_t y = std::min(blockY + i / 4, image.GetHeight() - 1);
+        const uint8_t* pixel = image.GetPixel(x, y);
+        opaque[i] = pixel[3] >= CMPR_ALPHA_THRESHOLD;
+        for (uint32_t channel = 0; channel < 3; ++channel)
+        {
+            pixels[i][channel] = pixel[channel];
+            if (opaque[i])
+                mean[channel] += pixel[channel];
+        }
+        opaqueCount += opaque[i];
+    }
+
+    const bool bTransparent = opaqueCount < 16;
+    if (opaqueCount == 0)
+    {
+        // equal colours select the three colour mode, index 3 is transparent
+        WriteBigEndian16(block, 0);
+        WriteBigEndian16(block + 2, 0);
+        block[4] = block[5] = block[6] = block[7] = 0xFF;
+        return;
+    }
+
+    for (uint32_t channel = 0; channel < 3; ++channel)
+        mean[channel] /= opaqueCount;
+
+    // the end points are the extremes along the principal axis of the opaque colours
+    float covariance[6] = { 0, 0, 0, 0, 0, 0 };
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        if (!opaque[i])
+            continue;
+
+        const float r = pixels[i][0] - mean[0], g = pixels[i][1] - mean[1], b = pixels[i][2] - mean[2];
+        covariance[0] += r * r; covariance[1] += r * g; covariance[2] += r * b;
+        covariance[3] += g * g; covariance[4] += g * b; covariance[5] += b * b;
+    }
+
+    float axis[3] = { 1, 1, 1 };
+    for (uint32_t iteration = 0; iteration < 8; ++iteration)
+    {
+        const float next[3] =
+        {
+            covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2],
+            covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2],
+            covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2]
+        };
+        const float length = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2]);
+        if (length < 1e-6f)
+            break;
+
+        for (uint32_t channel = 0; channel < 3; ++channel)
+            axis[channel] = next[channel] / length;
+    }
+
+    float minProjection = 0, maxProjection = 0;
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        if (!opaque[i])
+            continue;
+
+        const float projection = (pixels[i][0] - mean[0]) * axis[0] + (pixels[i][1] - mean[1]) * axis[1] + (pixels[i][2] - mean[2]) * axis[2];
+        minProjection = std::min(minProjection, projection);
+        maxProjection = std::max(maxProjection, projection);
+    }
+
+    float endPoints[2][3];
+    for (uint32_t channel = 0; channel < 3; ++channel)
+    {
+        endPoints[0][channel] = mean[channel] + axis[channel] * maxProjection;
+        endPoints[1][channel] = mean[channel] + axis[channel] * minProjection;
+    }
+
+    uint16_t color0 = PackRGB565(endPoints[0]);
+    uint16_t color1 = PackRGB565(endPoints[1]);
+
+    // the order of the end points selects the mode, four colours need the bigger one first
+    if (bTransparent ? color0 > color1 : color0 < color1)
+        std::swap(color0, color1);
+
+    uint8_t palette[4][4];
+    GetCMPRPalette(color0, color1, palette);
+    const uint32_t colorCount = color0 > color1 ? 4 : 3;
+
+    uint8_t indices[4] = { 0, 0, 0, 0 };
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        uint32_t index = 3;
+        if (opaque[i])
+        {
+            float bestDistance = 1e30f;
+            for (uint32_t candidate = 0; candidate < colorCount; ++candidate)
+            {
+                float distance = 0;
+                for (uint32_t channel = 0; channel < 3; ++channel)
+                {
+                    const float difference = pixels[i][channel] - palette[candidate][channel];
+                    distance += difference * difference;
+                }
+
+                if (distance < bestDistance)
+                {
+                    bestDistance = distance;
+                    index = candidate;
+                }
+            }
+        }
+
+        // two bits per pixel, the leftmost pixel of a row in the highest bits
+        indices[i / 4] |= index << (6 - (i % 4) * 2);
+    }
+
+    WriteBigEndian16(block, color0);
+    WriteBigEndian16(block + 2, color1);
+    std::copy(indices, indices + 4, block + 4);
+}
+
+void TextureCodec::DecodeCMPRBlock(const uint8_t* block, uint32_t blockX, uint32_t blockY, Image& image)
+{
+    uint8_t palette[4][4];
+    GetCMPRPalette(ReadBigEndian16(block), ReadBigEndian16(block + 2), palette);
+
+    for (uint32_t y = 0; y < 4 && blockY + y < image.GetHeight(); ++y)
+    {
+        for (uint32_t x = 0; x < 4 && blockX + x < image.GetWidth(); ++x)
+        {
+            const uint32_t index = (block[4 + y] >> (6 - x * 2)) & 3;
+            std::copy(palette[index], palette[index] + 4, image.GetPixel(blockX + x, blockY + y));
+        }
+    }
+}
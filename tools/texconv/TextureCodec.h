@@ -0,0 +1,66 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#ifndef _TEXTURECODEC_H_
+#define _TEXTURECODEC_H_
+
+#include <stdint.h>
+#include <vector>
+#include "Image.h"
+
+// GX texture formats as stored in a TPL header
+enum class ETextureFormat : uint32_t
+{
+    I4      = 0,
+    I8      = 1,
+    IA4     = 2,
+    IA8     = 3,
+    RGB565  = 4,
+    RGB5A3  = 5,
+    RGBA8   = 6,
+    CMPR    = 14
+};
+
+/**
+ * @brief TextureCodec
+ * Converts between RGBA8 images and the tiled GX texture formats.
+ */
+class TextureCodec
+{
+public:
+    static bool IsSupported(ETextureFormat format);
+
+    // bytes of one mip level, GX formats are stored in whole tiles
+    static uint32_t GetLevelSize(ETextureFormat format, uint32_t width, uint32_t height);
+
+    // appends the encoded image to data
+    static bool Encode(ETextureFormat format, const Image& image, std::vector<uint8_t>& data);
+    static bool Decode(ETextureFormat format, const uint8_t* data, uint32_t width, uint32_t height, Image& image);
+
+private:
+    // texels of one 32 byte tile of the formats which store every texel on its own
+    static void GetTileSize(ETextureFormat format, uint32_t& width, uint32_t& height);
+    static void EncodeTile(ETextureFormat format, const Image& image, uint32_t tileX, uint32_t tileY, uint8_t* tile);
+    static void DecodeTile(ETextureFormat format, const uint8_t* tile, uint32_t tileX, uint32_t tileY, Image& image);
+
+    static void EncodeCMPRBlock(const Image& image, uint32_t blockX, uint32_t blockY, uint8_t* block);
+    static void DecodeCMPRBlock(const uint8_t* block, uint32_t blockX, uint32_t blockY, Image& image);
+};
+
+#endif /* _TEXTURECODEC_H_ */
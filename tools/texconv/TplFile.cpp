@@ -0,0 +1,164 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include "TplFile.h"
+
+#define TPL_MAGIC 0x0020AF30
+// file header, one image table entry and the texture header, the data starts 32 byte aligned behind them
+#define TPL_IMAGE_TABLE_OFFSET 12
+#define TPL_TEXTURE_HEADER_OFFSET 20
+#define TPL_TEXTURE_HEADER_SIZE 36
+#define TPL_DATA_OFFSET 64
+
+static inline void WriteU32(std::vector<uint8_t>& data, uint32_t offset, uint32_t value)
+{
+    data[offset]     = (uint8_t) (value >> 24);
+    data[offset + 1] = (uint8_t) (value >> 16);
+    data[offset + 2] = (uint8_t) (value >> 8);
+    data[offset + 3] = (uint8_t) value;
+}
+
+static inline uint32_t ReadU32(const std::vector<uint8_t>& data, uint32_t offset)
+{
+    return ((uint32_t) data[offset] << 24) | ((uint32_t) data[offset + 1] << 16) | ((uint32_t) data[offset + 2] << 8) | data[offset + 3];
+}
+
+static inline uint16_t ReadU16(const std::vector<uint8_t>& data, uint32_t offset)
+{
+    return (uint16_t) ((data[offset] << 8) | data[offset + 1]);
+}
+
+bool TplFile::Read(const std::string& path, TplTexture& texture)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        fprintf(stderr, "%s: can not open the file\n", path.c_str());
+        return false;
+    }
+
+    const std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (data.size() < TPL_DATA_OFFSET || ReadU32(data, 0) != TPL_MAGIC || ReadU32(data, 4) == 0)
+    {
+        fprintf(stderr, "%s: not a TPL file\n", path.c_str());
+        return false;
+    }
+
+    const uint32_t header = ReadU32(data, ReadU32(data, 8));
+    if (header + TPL_TEXTURE_HEADER_SIZE > data.size())
+    {
+        fprintf(stderr, "%s: broken texture header\n", path.c_str());
+        return false;
+    }
+
+    const uint32_t height = ReadU16(data, header);
+    const uint32_t width = ReadU16(data, header + 2);
+    texture.Format = static_cast<ETextureFormat>(ReadU32(data, header + 4));
+    uint32_t offset = ReadU32(data, header + 8);
+    texture.WrapS = static_cast<ETextureWrap>(ReadU32(data, header + 12));
+    texture.WrapT = static_cast<ETextureWrap>(ReadU32(data, header + 16));
+    texture.MinFilter = static_cast<ETextureFilter>(ReadU32(data, header + 20));
+    texture.MagFilter = static_cast<ETextureFilter>(ReadU32(data, header + 24));
+    const uint32_t lodBias = ReadU32(data, header + 28);
+    memcpy(&texture.LodBias, &lodBias, sizeof(float));
+    const uint32_t maxLod = data[header + 34];
+
+    texture.Levels.clear();
+    for (uint32_t level = 0; level <= maxLod; ++level)
+    {
+        const uint32_t levelWidth = std::max<uint32_t>(width >> level, 1);
+        const uint32_t levelHeight = std::max<uint32_t>(height >> level, 1);
+        const uint32_t size = TextureCodec::GetLevelSize(texture.Format, levelWidth, levelHeight);
+        if (offset + size > data.size())
+        {
+            fprintf(stderr, "%s: mip level %u is cut off\n", path.c_str(), level);
+            return false;
+        }
+
+        Image image;
+        if (!TextureCodec::Decode(texture.Format, &data[offset], levelWidth, levelHeight, image))
+        {
+            fprintf(stderr, "%s: texture format %u is not supported\n", path.c_str(), static_cast<uint32_t>(texture.Format));
+            return false;
+        }
+
+        texture.Levels.push_back(std::move(image));
+        offset += size;
+    }
+
+    return true;
+}
+
+bool TplFile::Write(const std::string& path, const TplTexture& texture)
+{
+    if (texture.Levels.empty() || texture.Levels.size() > 11)
+    {
+        fprintf(stderr, "%s: a texture needs between 1 and 11 levels\n", path.c_str());
+        return false;
+    }
+
+    std::vector<uint8_t> data(TPL_DATA_OFFSET, 0);
+    WriteU32(data, 0, TPL_MAGIC);
+    WriteU32(data, 4, 1);
+    WriteU32(data, 8, TPL_IMAGE_TABLE_OFFSET);
+    WriteU32(data, TPL_IMAGE_TABLE_OFFSET, TPL_TEXTURE_HEADER_OFFSET);
+    WriteU32(data, TPL_IMAGE_TABLE_OFFSET + 4, 0);
+
+    const uint32_t header = TPL_TEXTURE_HEADER_OFFSET;
+    const Image& base = texture.Levels.front();
+    WriteU32(data, header, (base.GetHeight() << 16) | base.GetWidth());
+    WriteU32(data, header + 4, static_cast<uint32_t>(texture.Format));
+    WriteU32(data, header + 8, TPL_DATA_OFFSET);
+    WriteU32(data, header + 12, static_cast<uint32_t>(texture.WrapS));
+    WriteU32(data, header + 16, static_cast<uint32_t>(texture.WrapT));
+    WriteU32(data, header + 20, static_cast<uint32_t>(texture.MinFilter));
+    WriteU32(data, header + 24, static_cast<uint32_t>(texture.MagFilter));
+    uint32_t lodBias;
+    memcpy(&lodBias, &texture.LodBias, sizeof(float));
+    WriteU32(data, header + 28, lodBias);
+    // edge LOD, min LOD, max LOD and the unpacked flag
+    data[header + 32] = 0;
+    data[header + 33] = 0;
+    data[header + 34] = (uint8_t) (texture.Levels.size() - 1);
+    data[header + 35] = 0;
+
+    for (const Image& level : texture.Levels)
+    {
+        if (!TextureCodec::Encode(texture.Format, level, data))
+        {
+            fprintf(stderr, "%s: texture format %u is not supported\n", path.c_str(), static_cast<uint32_t>(texture.Format));
+            return false;
+        }
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    if (!file)
+    {
+        fprintf(stderr, "%s: can not write the file\n", path.c_str());
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,73 @@
+/***
+ *
+ * Copyright (C) 2018 DaeFennek
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+***/
+
+#ifndef _TPLFILE_H_
+#define _TPLFILE_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "Image.h"
+#include "TextureCodec.h"
+
+// GX wrap and filter modes as stored in a TPL header
+enum class ETextureWrap : uint32_t
+{
+    Clamp   = 0,
+    Repeat  = 1,
+    Mirror  = 2
+};
+
+enum class ETextureFilter : uint32_t
+{
+    Near            = 0,
+    Linear          = 1,
+    NearMipNear     = 2,
+    LinearMipNear   = 3,
+    NearMipLinear   = 4,
+    LinearMipLinear = 5
+};
+
+/**
+ * @brief TplTexture
+ * One texture of a TPL file, the first level is the full size image and every further level is a mip map of it.
+ */
+struct TplTexture
+{
+    ETextureFormat Format       = ETextureFormat::CMPR;
+    ETextureWrap WrapS          = ETextureWrap::Repeat;
+    ETextureWrap WrapT          = ETextureWrap::Repeat;
+    ETextureFilter MinFilter    = ETextureFilter::Linear;
+    ETextureFilter MagFilter    = ETextureFilter::Linear;
+    float LodBias               = 0.0f;
+    std::vector<Image> Levels;
+};
+
+/**
+ * @brief TplFile
+ * Reads and writes TPL files with a single texture, the layout Texture::LoadTPLTexture expects.
+ */
+class TplFile
+{
+public:
+    static bool Read(const std::string& path, TplTexture& texture);
+    static bool Write(const std::string& path, const TplTexture& texture);
+};
+
+#endif /* _TPLFILE_H_ */